@@ -0,0 +1,109 @@
+#ifndef ADVISOR_H
+#define ADVISOR_H
+
+#include <stdio.h>
+#include "flight.h"
+#include "query.h"
+
+/**
+ * Seleção de índices pela carga de consultas.
+ *
+ * Em vez de construir sempre as seis árvores e a rede de rotas, o plano
+ * escolhe, para cada campo, entre nenhum índice, a árvore com as listas
+ * comprimidas (blocos de deltas) ou com as listas simples, e se a rede de
+ * rotas (índice composto por origem e partida das buscas de itinerários) é
+ * construída, cabendo num orçamento de memória.
+ *
+ * A memória de cada estrutura é calculada antes de construí-la: os nós são
+ * um por chave distinta e o tamanho comprimido de cada lista sai das
+ * mesmas larguras de bloco que comprimir_postings usaria. O custo de uma
+ * consulta segue o do planejador (estimar_custo_folhas): a soma das contagens
+ * das folhas indexadas, com o peso CUSTO_ID_COMPRIMIDO nas comprimidas, mais
+ * a releitura dos candidatos quando sobram folhas sem índice; sem nenhuma
+ * folha indexada, todos os voos são lidos. Agregações de um único predicado
+ * indexado custam 0 e buscas de itinerários sem a rede custam uma leitura
+ * da tabela (a rede temporária de rede_rotas_consulta).
+ *
+ * A escolha é gulosa: a cada passo entra a estrutura (ou a troca de listas
+ * comprimidas por simples) de maior redução de custo da amostra por byte que
+ * ainda caiba no orçamento, até nenhuma reduzir o custo. Assim a memória vai
+ * para o que as consultas da amostra usam: o índice de preço, de chaves
+ * quase únicas, só entra se compensar os seus nós, e o de paradas, de quatro
+ * chaves, raramente reduz o custo.
+ *
+ * Sem amostra, cada campo recebe uma consulta de igualdade sobre a chave
+ * mediana e a rede, uma busca de itinerários.
+ */
+
+/**
+ * Representações de um índice, da menor para a maior.
+ */
+typedef enum {
+    REPRESENTACAO_NENHUMA,    // Sem árvore: as folhas do campo são avaliadas nos voos
+    REPRESENTACAO_COMPRIMIDA, // Árvore com listas em blocos comprimidos
+    REPRESENTACAO_LISTAS,     // Árvore com listas simples de ids
+    NUM_REPRESENTACOES
+} RepresentacaoIndice;
+
+/**
+ * Plano de índices de uma tabela.
+ */
+typedef struct {
+    RepresentacaoIndice representacao[NUM_CAMPOS_INDICE];  // Escolha de cada campo
+    int rede_rotas;                                        // 1 se a rede de rotas é construída
+
+    size_t memoria[NUM_CAMPOS_INDICE][NUM_REPRESENTACOES]; // Bytes de cada representação
+    size_t memoria_rede;                                   // Bytes da rede de rotas
+    size_t orcamento;                                      // Bytes disponíveis (SIZE_MAX = sem limite)
+
+    int num_consultas;                                     // Consultas da amostra (0 = amostra sintética)
+    double custo_sem_indices;                              // Custo da amostra sem nenhuma estrutura
+    double custo_completo;                                 // Com as seis árvores simples e a rede
+    double custo_plano;                                    // Com as estruturas escolhidas
+    double beneficio[NUM_CAMPOS_INDICE];                   // Aumento do custo sem a árvore do campo
+    double beneficio_rede;                                 // Aumento do custo sem a rede
+} PlanoIndices;
+
+/**
+ * Lê a amostra de consultas: um log de captura (--capture) ou um arquivo de
+ * texto com uma consulta por linha. Linhas que não são consultas (como os
+ * voos e as contagens de um arquivo de entrada) são ignoradas, então o
+ * próprio arquivo de entrada serve de amostra.
+ * @param caminho Arquivo da amostra.
+ * @param consultas Saída: vetor de consultas (liberar com free).
+ * @return Quantidade de consultas lidas, ou -1 se o arquivo não puder ser aberto.
+ */
+int carregar_amostra_consultas(const char *caminho, Query **consultas);
+
+/**
+ * Calcula a memória de cada estrutura e escolhe as que cabem no orçamento.
+ * @param voos Vetor de voos (na ordem de carga definitiva).
+ * @param n Quantidade de voos.
+ * @param amostra Consultas da amostra (NULL para a amostra sintética).
+ * @param num_amostra Quantidade de consultas da amostra.
+ * @param orcamento Memória disponível em bytes (SIZE_MAX = sem limite).
+ * @param plano Saída.
+ */
+void planejar_indices(const Flight *voos, int n, const Query *amostra, int num_amostra, size_t orcamento,
+                      PlanoIndices *plano);
+
+/**
+ * Constrói as estruturas do plano num conjunto de índices vazio. Os campos
+ * sem índice ficam com a árvore marcada como ausente.
+ * @param indices Índices criados por criar_indices.
+ * @param voos Vetor de voos.
+ * @param n Quantidade de voos.
+ * @param plano Plano calculado por planejar_indices.
+ */
+void construir_indices_plano(IndicesVoos *indices, Flight *voos, int n, const PlanoIndices *plano);
+
+/**
+ * Relata o plano: representação, memória estimada e construída e benefício
+ * de cada estrutura, e o custo estimado da amostra.
+ * @param arquivo Destino do relatório.
+ * @param plano Plano calculado.
+ * @param indices Índices construídos pelo plano (ou NULL para omitir a memória construída).
+ */
+void relatar_plano_indices(FILE *arquivo, const PlanoIndices *plano, const IndicesVoos *indices);
+
+#endif // ADVISOR_H
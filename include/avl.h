@@ -3,7 +3,12 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
+#include <stdatomic.h>
+#include <float.h>
+#include "posting.h"
+#include "flight.h"
 
 /**
  * Enumeração dos operadores suportados na árvore de expressão.
@@ -14,37 +19,98 @@ typedef enum {
     OP_GREATER_EQUAL,// Maior ou igual (>=)
     OP_LESS,         // Menor (<)
     OP_GREATER,      // Maior (>)
-    OP_AND           // Operador lógico AND (&&)
+    OP_AND,          // Operador lógico AND (&&)
+    OP_INVALID       // Operador não reconhecido
 } OperatorType;
 
+/**
+ * Campos indexados, na ordem dos índices globais.
+ */
+typedef enum {
+    CAMPO_ORIGEM,
+    CAMPO_DESTINO,
+    CAMPO_PRECO,
+    CAMPO_ASSENTOS,
+    CAMPO_DURACAO,
+    CAMPO_PARADAS,
+    NUM_CAMPOS_INDICE
+} CampoIndice;
+
+/**
+ * Campo sem índice próprio, consultável como "dep": a partida. Os motores
+ * o avaliam diretamente nos voos.
+ */
+#define CAMPO_PARTIDA NUM_CAMPOS_INDICE
+
+/**
+ * Predicado de uma folha convertido no intervalo fechado [min, max] de chaves
+ * numéricas do campo: aeroportos empacotados na ordem de strcmp, preço em
+ * centavos, partida em segundos e os demais campos como inteiros. Um
+ * intervalo vazio tem min > max.
+ */
+typedef struct {
+    int campo;    // CampoIndice ou CAMPO_PARTIDA
+    int64_t min;
+    int64_t max;
+} FaixaPredicado;
+
 /**
  * Estrutura de um nó da árvore AVL.
  */
 typedef struct AVLNode {
     char chave[100];  // Valor da chave associada ao nó (exemplo: código do aeroporto)
-    int *indices;     // Lista de índices dos voos associados a essa chave
+    int64_t chave_num; // Chave numérica (escala de FaixaPredicado), calculada na criação
+    int *indices;     // Lista de índices dos voos associados a essa chave (NULL se comprimida)
+    ListaPostings *postings; // Lista comprimida dos índices (NULL se em `indices`)
     int num_indices;  // Número de índices armazenados no nó
     int altura;       // Altura do nó na árvore AVL
     struct AVLNode *esq;  // Ponteiro para o filho à esquerda
     struct AVLNode *dir;  // Ponteiro para o filho à direita
+
+    // Agregados dos voos do próprio nó
+    double soma_preco_no;
+    float min_preco_no, max_preco_no;
+
+    // Agregados da subárvore (nó + filhos), mantidos nas rotações e cópias
+    long total_sub;          // Quantidade de índices na subárvore
+    int64_t chave_min_sub;   // Menor chave numérica da subárvore
+    int64_t chave_max_sub;   // Maior chave numérica da subárvore
+    double soma_preco_sub;
+    float min_preco_sub, max_preco_sub;
 } AVLNode;
 
+/**
+ * Resultado de uma agregação de preços (COUNT/MIN/MAX/AVG/SUM).
+ */
+typedef struct {
+    long quantidade;   // Voos agregados
+    double soma;       // Soma dos preços
+    float minimo;      // Menor preço (válido se quantidade > 0)
+    float maximo;      // Maior preço (válido se quantidade > 0)
+} AgregadoPreco;
+
+#define AGREGADO_PRECO_VAZIO { 0, 0.0, FLT_MAX, -FLT_MAX }
+
 /**
  * Estrutura de uma árvore AVL.
  */
 typedef struct AVLTree {
-    AVLNode *raiz;  // Ponteiro para o nó raiz da árvore AVL
+    // Raiz publicada atomicamente: atualizações copiam o caminho alterado e
+    // trocam a raiz, então leitores sempre percorrem uma versão consistente
+    _Atomic(AVLNode *) raiz;
+    int ausente;  // Índice não construído (plano de índices): as folhas do campo são avaliadas nos voos
 } AVLTree;
 
 /**
- * Variáveis globais para armazenar os índices AVL de diferentes atributos dos voos.
+ * Conjunto de nós de um índice que satisfazem um predicado. Os nós pertencem
+ * à árvore: a faixa apenas os referencia, sem copiar as listas de índices.
  */
-extern struct AVLTree *indice_origem;    // Índice AVL para o campo "origem"
-extern struct AVLTree *indice_destino;   // Índice AVL para o campo "destino"
-extern struct AVLTree *indice_preco;     // Índice AVL para o campo "preço"
-extern struct AVLTree *indice_assentos;  // Índice AVL para o campo "assentos"
-extern struct AVLTree *indice_duracao;   // Índice AVL para o campo "duração"
-extern struct AVLTree *indice_paradas;   // Índice AVL para o campo "paradas"
+typedef struct {
+    AVLNode **nos;  // Nós que satisfazem o predicado
+    int num;        // Quantidade de nós
+    int capacidade; // Capacidade alocada
+    long total;     // Soma de num_indices dos nós
+} FaixaAVL;
 
 /**
  * Funções para manipulação da árvore AVL.
@@ -60,6 +126,87 @@ AVLTree *criar_avl();  // Inicializa e retorna uma nova árvore AVL
  */
 AVLNode *inserir_avl(AVLNode *raiz, const char *chave, int indice);
 
+/**
+ * Versão copy-on-write de inserir_avl: copia os nós do caminho até a chave
+ * (aposentando os originais no coletor de épocas) e insere o índice
+ * mantendo a lista em ordem crescente. A árvore original não é alterada.
+ * @param raiz Raiz da versão atual.
+ * @param chave Chave a ser inserida.
+ * @param indice Índice do voo associado à chave.
+ * @param voos Vetor de voos (para os agregados de preço).
+ * @return Raiz da nova versão (a publicar pelo chamador).
+ */
+AVLNode *inserir_avl_cow(AVLNode *raiz, const char *chave, int indice, const Flight *voos);
+
+/**
+ * Remove um índice da lista de uma chave copiando o caminho (copy-on-write).
+ * O nó permanece na árvore mesmo se a lista ficar vazia.
+ * @param raiz Raiz da versão atual.
+ * @param chave Chave do nó.
+ * @param indice Índice do voo a remover.
+ * @param preco Preço do voo enquanto estava no nó.
+ * @param voos Vetor de voos (para recalcular mínimo e máximo).
+ * @return Raiz da nova versão, ou a própria raiz se o índice não estava na chave.
+ */
+AVLNode *remover_indice_avl_cow(AVLNode *raiz, const char *chave, int indice, float preco, const Flight *voos);
+
+/**
+ * Atualiza os agregados de preço do nó da chave que contém o índice,
+ * copiando o caminho (copy-on-write).
+ * @param raiz Raiz da versão atual.
+ * @param chave Chave do nó que contém o voo.
+ * @param preco_antigo Preço anterior do voo.
+ * @param preco_novo Novo preço do voo.
+ * @param voos Vetor de voos (para recalcular mínimo e máximo).
+ * @return Raiz da nova versão.
+ */
+AVLNode *atualizar_preco_avl_cow(AVLNode *raiz, const char *chave, float preco_antigo, float preco_novo,
+                                 const Flight *voos);
+
+/**
+ * Calcula os agregados de todos os nós da árvore (após a construção).
+ * @param raiz Raiz da árvore.
+ * @param voos Vetor de voos indexado pelos índices das listas.
+ */
+void calcular_agregados_avl(AVLNode *raiz, const Flight *voos);
+
+/**
+ * Agrega os preços dos voos que satisfazem um predicado sobre um índice
+ * usando os agregados das subárvores: subárvores inteiramente dentro do
+ * predicado entram em O(1) e as inteiramente fora são puladas.
+ * @param indice Árvore do campo.
+ * @param predicado Intervalo de chaves do campo.
+ * @param agregado Saída.
+ */
+void agregar_indice_avl(AVLTree *indice, const FaixaPredicado *predicado, AgregadoPreco *agregado);
+
+/**
+ * Acrescenta um preço a um agregado.
+ */
+void acumular_preco(AgregadoPreco *agregado, float preco);
+
+/**
+ * Combina dois agregados (resultado em `destino`).
+ */
+void combinar_agregados(AgregadoPreco *destino, const AgregadoPreco *origem);
+
+/**
+ * Cria um nó de índice isolado, assumindo a posse do vetor de índices.
+ * @param chave Chave do nó.
+ * @param indices Vetor de índices em ordem crescente.
+ * @param n Quantidade de índices.
+ */
+AVLNode *criar_no_avl(const char *chave, int *indices, int n);
+
+/**
+ * Monta uma AVL perfeitamente balanceada a partir de nós já ordenados por chave.
+ * @param nos Vetor de nós em ordem crescente de chave.
+ * @param inicio Primeira posição (inclusive).
+ * @param fim Última posição (inclusive).
+ * @return Raiz da árvore montada.
+ */
+AVLNode *construir_avl_balanceada(AVLNode **nos, int inicio, int fim);
+
 /**
  * Busca um nó na árvore AVL.
  * @param raiz Ponteiro para o nó raiz da árvore.
@@ -75,38 +222,99 @@ AVLNode *buscar_avl(AVLNode *raiz, const char *chave);
 void liberar_avl(AVLNode *raiz);
 
 /**
- * Intersecciona os resultados de dois nós AVL.
+ * Intersecciona as listas de índices de dois nós AVL (apenas os próprios nós,
+ * sem as subárvores). As listas devem estar em ordem crescente.
  * @param a Ponteiro para a primeira AVLNode.
  * @param b Ponteiro para a segunda AVLNode.
- * @return Retorna uma nova AVLNode contendo apenas os índices presentes em ambas as árvores.
+ * @return Retorna uma nova AVLNode (resultado) com os índices presentes em ambas, ou NULL se vazia.
  */
 AVLNode *intersect_avl_nodes(AVLNode *a, AVLNode *b);
 
 /**
  * Realiza uma busca na árvore AVL baseada em um campo específico.
- * @param campo Nome do campo a ser buscado.
- * @param valor Valor a ser comparado.
- * @param operador Operador lógico para a busca (ex: >=, <=, ==).
- * @return Retorna um nó AVL contendo os resultados da busca.
+ * @param arvores Índices da tabela, na ordem de CampoIndice.
+ * @param predicado Intervalo de chaves (campo indexado).
+ * @return Retorna um nó resultado (liberar com liberar_avl) com os índices em ordem crescente, ou NULL.
  */
-AVLNode *buscar_avl_por_campo(const char *campo, const char *valor, OperatorType operador);
+AVLNode *buscar_avl_por_campo(AVLTree *const arvores[], const FaixaPredicado *predicado);
 
 /**
- * Busca todos os valores menores ou iguais ao valor fornecido na AVL.
- * @param raiz Ponteiro para o nó raiz da árvore.
- * @param valor Valor limite para a busca.
- * @param incluir_igual Define se o valor limite deve ser incluído na busca.
- * @return Retorna um nó AVL contendo os resultados.
+ * Retorna o campo indexado correspondente ao nome ("org", "prc"...), ou -1.
  */
-AVLNode *buscar_menores_avl(AVLNode *raiz, const char *valor, int incluir_igual);
+int campo_indice(const char *campo);
 
 /**
- * Busca todos os valores maiores ou iguais ao valor fornecido na AVL.
- * @param raiz Ponteiro para o nó raiz da árvore.
- * @param valor Valor limite para a busca.
- * @param incluir_igual Define se o valor limite deve ser incluído na busca.
- * @return Retorna um nó AVL contendo os resultados.
+ * Retorna, dentre os índices de uma tabela (na ordem de CampoIndice), o do
+ * campo com o nome dado ("org", "prc"...), ou NULL.
+ */
+AVLTree *indice_por_campo(AVLTree *const arvores[], const char *campo);
+
+/**
+ * Empacota um código de aeroporto (até 3 caracteres) preservando a ordem de strcmp.
+ */
+int64_t chave_aeroporto(const char *codigo);
+
+/**
+ * Preço em centavos, arredondado como o "%.2f" da saída (meios para o par):
+ * a chave de preço de todos os motores, então um voo de 100.125 é impresso
+ * como 100.12 e é encontrado por prc==100.12.
+ */
+int64_t preco_centavos(float preco);
+
+/**
+ * Chave numérica de um voo para o campo (CampoIndice ou CAMPO_PARTIDA), na
+ * escala de FaixaPredicado.
+ */
+int64_t chave_voo(const Flight *voo, int campo);
+
+/**
+ * Coleta os nós de um índice que satisfazem o predicado, sem copiar índices.
+ * Só as subárvores cujo intervalo de chaves cruza o do predicado são visitadas.
+ * @param indice Árvore do campo.
+ * @param predicado Intervalo de chaves do campo.
+ * @param faixa Faixa de saída (liberar com liberar_faixa_avl).
+ */
+void buscar_faixa_avl(AVLTree *indice, const FaixaPredicado *predicado, FaixaAVL *faixa);
+
+/**
+ * Libera o vetor de nós de uma faixa (os nós continuam na árvore).
+ */
+void liberar_faixa_avl(FaixaAVL *faixa);
+
+/**
+ * Une os índices de todos os nós da faixa em um nó resultado ordenado.
+ * @return Nó resultado ou NULL se a faixa estiver vazia.
+ */
+AVLNode *materializar_faixa_avl(const FaixaAVL *faixa);
+
+/**
+ * Intersecciona um nó resultado com a união dos nós da faixa. Quando o
+ * resultado é pequeno, cada nó da faixa é interseccionado diretamente
+ * (pulando blocos comprimidos) sem materializar a faixa.
+ * @return Novo nó resultado ou NULL se a interseção for vazia.
+ */
+AVLNode *intersectar_faixa_avl(AVLNode *resultado, const FaixaAVL *faixa);
+
+/**
+ * Cria um nó resultado (sem filhos) assumindo a posse do vetor de índices.
+ * @return O nó, ou NULL (liberando o vetor) se n == 0.
+ */
+AVLNode *criar_no_resultado(int *indices, int n);
+
+/**
+ * Copia para `destino` os índices de um nó, descomprimindo se necessário.
+ * @return Quantidade de índices copiados.
+ */
+int extrair_indices_no(const AVLNode *no, int *destino);
+
+/**
+ * Comprime as listas de índices de todos os nós da árvore.
+ */
+void comprimir_avl(AVLNode *raiz);
+
+/**
+ * Memória ocupada pela árvore (nós e listas de índices), em bytes.
  */
-AVLNode *buscar_maiores_avl(AVLNode *raiz, const char *valor, int incluir_igual);
+size_t memoria_avl(const AVLNode *raiz);
 
 #endif // AVL_H
@@ -0,0 +1,87 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "query.h"
+#include "cursor.h"
+
+#define CAPTURA_MAGICA "TP3Q"  // Assinatura do arquivo de captura
+#define CAPTURA_VERSAO 2
+
+/**
+ * Captura de consultas.
+ *
+ * Cada consulta executada é anexada a um log binário compacto com o instante
+ * de chegada e a latência medida, para ser reexecutada depois (tp3-replay).
+ * Formato (inteiros na ordem de bytes da máquina):
+ *
+ *   cabeçalho: "TP3Q" + uint32 versão
+ *   registro:  uint64 chegada_ns + uint64 latencia_ns + int32 max_voos +
+ *              uint8 agregacao + char trigrama[3] + uint16 tamanho +
+ *              `tamanho` bytes da expressão (sem '\0') + uint8 paginacao
+ *              (0 = sem página, 1 = primeira página, 2 = com cursor) +
+ *              cursor (CURSOR_TAMANHO bytes, só com paginacao 2)
+ *
+ * A chegada é contada a partir da abertura do log.
+ */
+
+/**
+ * Uma consulta capturada.
+ */
+typedef struct {
+    uint64_t chegada;   // Nanossegundos desde o início da captura
+    uint64_t latencia;  // Nanossegundos entre a chegada e o fim da resposta
+    Query consulta;
+} RegistroConsulta;
+
+/**
+ * Log de captura aberto para escrita. Pode ser usado por várias threads.
+ */
+typedef struct {
+    FILE *arquivo;
+    uint64_t inicio;        // Instante da abertura (relógio monotônico)
+    long num_registros;
+    pthread_mutex_t trava;  // Serializa os registros
+} CapturaConsultas;
+
+/**
+ * Instante atual do relógio monotônico, em nanossegundos.
+ */
+uint64_t relogio_ns();
+
+/**
+ * Cria o arquivo de captura e escreve o cabeçalho.
+ * @param caminho Arquivo de destino (sobrescrito).
+ * @return Captura (fechar com fechar_captura), ou NULL se o arquivo não puder ser criado.
+ */
+CapturaConsultas *abrir_captura(const char *caminho);
+
+/**
+ * Anexa uma consulta executada ao log.
+ * @param captura Log de destino.
+ * @param consulta Consulta executada.
+ * @param chegada Instante (relogio_ns) em que a consulta chegou.
+ * @param termino Instante (relogio_ns) em que a resposta ficou pronta.
+ */
+void registrar_consulta(CapturaConsultas *captura, const Query *consulta, uint64_t chegada, uint64_t termino);
+
+/**
+ * Descarrega e fecha o log.
+ */
+void fechar_captura(CapturaConsultas *captura);
+
+/**
+ * Abre um log de captura para leitura, validando o cabeçalho.
+ * @return Arquivo posicionado no primeiro registro, ou NULL se inválido.
+ */
+FILE *abrir_captura_leitura(const char *caminho);
+
+/**
+ * Lê o próximo registro do log.
+ * @return 1 se um registro foi lido, 0 no fim do log ou se ele estiver truncado.
+ */
+int ler_registro_consulta(FILE *arquivo, RegistroConsulta *registro);
+
+#endif // CAPTURE_H
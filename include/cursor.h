@@ -0,0 +1,62 @@
+#ifndef CURSOR_H
+#define CURSOR_H
+
+#include "flight.h"
+#include "query.h"
+#include "output.h"
+
+#define CURSOR_TAMANHO 41  // '@' seguido de 40 dígitos hexadecimais
+
+/**
+ * Paginação por chave (keyset).
+ *
+ * Uma consulta "page [cursor] max trigrama expressão" devolve a página de
+ * até `max` voos seguinte ao cursor (a primeira, sem cursor) e termina com a
+ * linha "cursor <próximo>", ou "cursor -" quando não há mais voos. O cursor
+ * é opaco: codifica a chave de ordenação do último voo da página (preço,
+ * duração e paradas) e o seu id, além de uma assinatura do trigrama e da
+ * expressão, então só vale para a mesma consulta. A página seguinte seleciona
+ * os `max` melhores entre os voos estritamente posteriores ao cursor na ordem
+ * do trigrama (empates pelo id), com o mesmo custo da primeira página,
+ * independentemente da profundidade.
+ */
+
+/**
+ * Codifica o cursor que retoma depois de `ultimo`.
+ * @param consulta Consulta paginada (trigrama e expressão entram na assinatura).
+ * @param ultimo Último voo da página.
+ * @param texto Destino (pelo menos CURSOR_TAMANHO + 1 bytes).
+ */
+void codificar_cursor(const Query *consulta, const Flight *ultimo, char *texto);
+
+/**
+ * Decodifica um cursor para a consulta (que já deve ter trigrama e expressão).
+ * @return 1 se o cursor for válido para a consulta, 0 caso contrário.
+ */
+int decodificar_cursor(const char *texto, Query *consulta);
+
+/**
+ * Verifica se um voo vem depois do cursor da consulta (sempre, sem cursor).
+ */
+int depois_do_cursor(const Query *consulta, const Flight *voo);
+
+/**
+ * Mantém em `ids` só os voos posteriores ao cursor, preservando a ordem.
+ * @return Quantidade de ids mantidos.
+ */
+int aplicar_cursor(const Query *consulta, const Flight *voos, int *ids, int n);
+
+/**
+ * Quantidade de voos a selecionar: `max_voos`, mais um nas consultas
+ * paginadas (o excedente só indica que existe a próxima página).
+ */
+int limite_pagina(const Query *consulta);
+
+/**
+ * Escreve a linha do cursor de uma consulta paginada (nada nas demais).
+ * @param ultimo Último voo da página.
+ * @param ha_mais 1 se existem voos depois de `ultimo`.
+ */
+void imprimir_cursor(Saida *saida, const Query *consulta, const Flight *ultimo, int ha_mais);
+
+#endif // CURSOR_H
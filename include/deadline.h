@@ -0,0 +1,54 @@
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+#include <stdint.h>
+
+#define PRAZO_INTERVALO_RELOGIO 64  // Verificações entre duas leituras do relógio
+
+/**
+ * Prazo cooperativo por consulta.
+ *
+ * A thread que vai responder uma consulta define o instante limite com
+ * iniciar_prazo(); os laços longos da avaliação (coleta das faixas nos
+ * índices, união e interseção das listas, filtro das folhas residuais,
+ * ordenação e busca de itinerários) verificam o prazo e, quando ele acabou,
+ * abandonam o trabalho restante e retornam o que já têm. O
+ * resultado nesse caso é incompleto e deve ser descartado por quem iniciou o
+ * prazo, o que encerrar_prazo() indica. Depois de esgotado, o prazo continua
+ * esgotado até ser encerrado, então cada laço interrompido desfaz a consulta
+ * inteira rapidamente.
+ *
+ * O estado é por thread. Sem prazo definido (o padrão), cada verificação
+ * custa um teste de variável. Laços de passos curtos (um nó da árvore, uma
+ * expansão da busca) usam prazo_esgotado(), que só lê o relógio a cada
+ * PRAZO_INTERVALO_RELOGIO chamadas; passos que custam O(n) (uma partição da
+ * ordenação, um bloco de voos) usam verificar_prazo(), que sempre lê.
+ */
+
+/**
+ * Define o prazo da consulta que a thread atual vai responder.
+ * @param limite Instante limite no relógio de relogio_ns(), ou 0 para nenhum.
+ */
+void iniciar_prazo(uint64_t limite);
+
+/**
+ * Verifica se o prazo da thread atual acabou, lendo o relógio só a cada
+ * PRAZO_INTERVALO_RELOGIO chamadas.
+ * @return 1 se a consulta deve ser interrompida, 0 caso contrário.
+ */
+int prazo_esgotado();
+
+/**
+ * Verifica se o prazo da thread atual acabou, sempre lendo o relógio.
+ * @return 1 se a consulta deve ser interrompida, 0 caso contrário.
+ */
+int verificar_prazo();
+
+/**
+ * Remove o prazo da thread atual.
+ * @return 1 se alguma verificação encontrou o prazo esgotado (o resultado
+ *         está incompleto), 0 caso contrário.
+ */
+int encerrar_prazo();
+
+#endif // DEADLINE_H
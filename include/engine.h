@@ -0,0 +1,66 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+/**
+ * Interface de biblioteca (libtp3): motor de consultas reentrante.
+ *
+ * Cada Engine é dono dos seus voos, dos seus índices e da trava que serializa
+ * as suas atualizações; não há estado global de tabela, então vários motores
+ * convivem no mesmo processo (ex: os dados de hoje e os de amanhã).
+ *
+ * Todas as funções podem ser chamadas por várias threads ao mesmo tempo sobre
+ * o mesmo motor, exceto engine_destroy. Consultas não adquirem travas: os
+ * dados são publicados por ponteiro atômico e a memória substituída por
+ * engine_load ou engine_update só é liberada quando nenhuma consulta em
+ * andamento puder mais alcançá-la.
+ */
+typedef struct Engine Engine;
+
+/**
+ * Cria um motor vazio (consultas sobre ele não retornam voos).
+ * @return Motor (liberar com engine_destroy).
+ */
+Engine *engine_create(void);
+
+/**
+ * Carrega os voos de um arquivo no formato de entrada ("<n>" seguido de n
+ * linhas de voo), constrói os índices e publica o novo conjunto no lugar do
+ * anterior. Consultas em andamento terminam sobre os dados antigos.
+ * @param engine Motor de destino.
+ * @param arquivo Arquivo posicionado no número de voos.
+ * @return Quantidade de voos carregados, ou -1 em erro de leitura.
+ */
+int engine_load(Engine *engine, FILE *arquivo);
+
+/**
+ * Responde uma linha de consulta ("max trigrama expressão" ou agregação) com
+ * a mesma saída do programa em lote.
+ * @param engine Motor consultado.
+ * @param linha Consulta.
+ * @param resposta Saída: texto da resposta terminado em '\0' (liberar com free).
+ * @param tamanho Saída: bytes da resposta, sem o '\0' (pode ser NULL).
+ * @return Número de linhas da resposta, ou -1 se a consulta for inválida.
+ */
+int engine_query(Engine *engine, const char *linha, char **resposta, size_t *tamanho);
+
+/**
+ * Atualiza o preço ("prc") ou os assentos ("sea") de um voo sem bloquear as
+ * consultas.
+ * @return 1 se o voo foi atualizado, 0 se o id ou o campo forem inválidos.
+ */
+int engine_update(Engine *engine, int id, const char *campo, const char *valor);
+
+/**
+ * Quantidade de voos do conjunto publicado.
+ */
+int engine_size(Engine *engine);
+
+/**
+ * Libera o motor, os seus voos e índices. Não pode haver chamadas em andamento.
+ */
+void engine_destroy(Engine *engine);
+
+#endif // ENGINE_H
@@ -0,0 +1,65 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <stdint.h>
+
+#define EPOCA_MAX_LEITORES 256  // Threads leitoras registradas simultaneamente
+
+/**
+ * Recuperação de memória por épocas.
+ *
+ * Leitores marcam o início e o fim de cada acesso aos índices com
+ * entrar_epoca()/sair_epoca(), sem travas. O escritor publica uma nova versão
+ * (ponteiro de raiz atômico) e entrega a memória da versão antiga a
+ * aposentar(); recolher_aposentados() só a libera depois que todos os
+ * leitores ativos entraram numa época posterior à da aposentadoria.
+ *
+ * O coletor é único no processo e atende os escritores de todas as tabelas;
+ * a lista de aposentados tem trava própria, então escritores de tabelas
+ * diferentes não precisam se coordenar.
+ */
+
+/**
+ * Marca o início de uma leitura: a memória visível a partir daqui não é
+ * liberada até sair_epoca(). Chamadas aninhadas na mesma thread são
+ * permitidas; a época é a da leitura mais externa. A primeira leitura de
+ * uma thread reserva um dos EPOCA_MAX_LEITORES slots, devolvido quando ela
+ * termina; com todos ocupados, espera uma thread leitora terminar.
+ */
+void entrar_epoca();
+
+/**
+ * Marca o fim da leitura iniciada com entrar_epoca() (a mais interna, se aninhadas).
+ */
+void sair_epoca();
+
+/**
+ * Espera o fim das leituras iniciadas antes da chamada (exceto a da própria
+ * thread, se houver). Depois dela nenhuma leitura em andamento alcança uma
+ * raiz substituída antes da chamada. Não bloqueia novas leituras.
+ */
+void esperar_leituras();
+
+/**
+ * Entrega ao coletor um bloco que deixou de ser alcançável a partir das
+ * raízes publicadas. Pode ser chamada por escritores de tabelas diferentes
+ * ao mesmo tempo.
+ * @param ptr Bloco a liberar.
+ * @param liberar Função que libera o bloco (ex: free).
+ */
+void aposentar(void *ptr, void (*liberar)(void *));
+
+/**
+ * Avança a época global e libera os blocos aposentados que nenhum leitor
+ * ativo pode mais alcançar. Os liberadores são executados com a trava do
+ * coletor e não podem aposentar blocos.
+ * @return Quantidade de blocos liberados.
+ */
+int recolher_aposentados();
+
+/**
+ * Quantidade de blocos aposentados ainda aguardando liberação.
+ */
+int aposentados_pendentes();
+
+#endif // EPOCH_H
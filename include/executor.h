@@ -0,0 +1,82 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include "flight.h"
+#include "avl.h"
+#include "query.h"
+#include "scan.h"
+#include "advisor.h"
+
+/**
+ * Motores de execução das consultas sequenciais.
+ *
+ * Todos respondem com a mesma semântica (comparações numéricas exatas, preço
+ * em centavos) e devolvem os voos selecionados pelas posições no vetor:
+ *
+ *   index   interseção das faixas dos índices AVL;
+ *   scan    varredura dos voos com os predicados avaliados em cada um,
+ *           pulando os blocos cujo mapa de zonas exclui a conjunção;
+ *   auto    escolhe, por consulta, o de menor custo estimado: a soma das
+ *           contagens das folhas nos índices (agregados das subárvores)
+ *           contra os voos dos blocos que a varredura leria;
+ *   verify  executa index e scan e aborta na primeira divergência.
+ */
+typedef enum {
+    EXECUTOR_INDICE,
+    EXECUTOR_VARREDURA,
+    EXECUTOR_AUTO,
+    EXECUTOR_VERIFICAR
+} TipoExecutor;
+
+/**
+ * Motor de execução sobre um vetor de voos. As estruturas de acesso são
+ * construídas conforme o tipo (índices, mapa de zonas ou ambos).
+ */
+typedef struct Executor {
+    TipoExecutor tipo;
+    Flight *voos;           // Vetor consultado (continua pertencendo ao chamador)
+    int n;
+    IndicesVoos *indices;   // NULL na varredura
+    MapaZonas *zonas;       // NULL no motor de índices
+
+    /** Filtra os voos: posições em ordem crescente (liberar com free), retorna a quantidade. */
+    int (*filtrar)(struct Executor *executor, const Query *consulta, int **resultados);
+    /** Agrega os preços dos voos que atendem à consulta. */
+    void (*agregar)(struct Executor *executor, const Query *consulta, AgregadoPreco *agregado);
+} Executor;
+
+/**
+ * Interpreta o nome de um motor ("index", "scan", "auto" ou "verify").
+ * @return O tipo, ou -1 se o nome for desconhecido.
+ */
+int tipo_executor(const char *nome);
+
+/**
+ * Cria o motor e constrói as estruturas de acesso de que ele precisa.
+ * @param tipo Motor.
+ * @param voos Vetor de voos (já na ordem de carga definitiva).
+ * @param n Quantidade de voos.
+ * @param comprimir 1 para comprimir as listas dos índices.
+ * @param plano Estruturas a construir nos índices (NULL para todas).
+ * @return Motor (liberar com liberar_executor).
+ */
+Executor *criar_executor(TipoExecutor tipo, Flight *voos, int n, int comprimir, const PlanoIndices *plano);
+
+/**
+ * Filtra os voos que atendem à consulta.
+ * @param resultados Saída: posições dos voos, em ordem crescente (liberar com free).
+ * @return Quantidade de voos selecionados.
+ */
+int filtrar_executor(Executor *executor, const Query *consulta, int **resultados);
+
+/**
+ * Agrega os preços dos voos que atendem à consulta.
+ */
+void agregar_executor(Executor *executor, const Query *consulta, AgregadoPreco *agregado);
+
+/**
+ * Libera o motor e as suas estruturas de acesso (o vetor de voos não é liberado).
+ */
+void liberar_executor(Executor *executor);
+
+#endif // EXECUTOR_H
@@ -6,6 +6,8 @@
 #include <string.h>
 #include "avl.h"
 
+#define MAX_FOLHAS_EXPRESSAO 32  // Uma expressão de até 255 caracteres tem no máximo 32 predicados
+
 /**
  * Nó da árvore de expressões.
  */
@@ -23,9 +25,37 @@ typedef struct ExprNode {
 ExprNode *parse_expressao(const char *expr);
 
 /**
- * Avalia a árvore de expressão e retorna os voos que satisfazem a consulta.
+ * Converte um predicado folha no intervalo fechado de chaves numéricas do
+ * campo. Comparações são exatas: valores fracionários em campos inteiros
+ * arredondam o limite para dentro e aeroportos com mais de 3 letras geram um
+ * intervalo vazio.
+ * @param no Folha da expressão.
+ * @param predicado Saída.
+ * @return 1 se o campo é conhecido, 0 caso contrário.
+ */
+int converter_faixa_predicado(const ExprNode *no, FaixaPredicado *predicado);
+
+/**
+ * Converte as folhas de uma conjunção, da esquerda para a direita.
+ * @param root Expressão.
+ * @param folhas Saída.
+ * @param max Capacidade de `folhas` (folhas excedentes são ignoradas).
+ * @return Quantidade de folhas, ou -1 se algum campo for desconhecido.
+ */
+int converter_folhas_expressao(const ExprNode *root, FaixaPredicado *folhas, int max);
+
+/**
+ * Avalia a árvore de expressão sobre os índices de uma tabela (na ordem de
+ * CampoIndice) e retorna os voos que satisfazem a consulta. Predicados sobre
+ * a partida, que não tem índice, e sobre campos cuja árvore não foi
+ * construída (AVLTree.ausente) são aplicados diretamente aos voos.
+ * @param arvores Índices da tabela.
+ * @param voos Voos da tabela (posições das listas dos índices).
+ * @param n Quantidade de voos.
+ * @param root Expressão.
+ * @return Nó resultado com as posições em ordem crescente (liberar com liberar_avl), ou NULL se vazio.
  */
-AVLNode *avaliar_expressao(const ExprNode *root);
+AVLNode *avaliar_expressao(AVLTree *const arvores[], const Flight *voos, int n, const ExprNode *root);
 
 /**
  * Libera a memória da árvore de expressão.
@@ -21,6 +21,7 @@ typedef struct {
     time_t chegada;              // Data e hora de chegada (convertido para segundos)
     int paradas;                 // Número de paradas
     int duracao;                 // Duração total do voo em segundos (chegada - partida)
+    int id;                      // Posição do voo na entrada (desempate da ordenação)
 } Flight;
 
 /**
@@ -31,6 +32,14 @@ typedef struct {
  */
 void carregar_voos(FILE *arquivo, Flight **voos, int *n);
 
+/**
+ * Lê um único voo do arquivo de entrada (leitura em fluxo, sem alocar o vetor).
+ * @param arquivo Ponteiro para o arquivo de entrada.
+ * @param voo Estrutura que recebe o voo lido.
+ * @return 1 se a leitura for bem-sucedida, 0 caso contrário.
+ */
+int ler_voo(FILE *arquivo, Flight *voo);
+
 /**
  * Converte uma string de data e hora para time_t.
  * @param datetime String no formato ISO 8601 (ex: "2022-11-01T17:54:00.000-06:00").
@@ -0,0 +1,126 @@
+#ifndef ITINERARY_H
+#define ITINERARY_H
+
+#include <stdint.h>
+#include <time.h>
+#include "flight.h"
+#include "query.h"
+#include "output.h"
+
+#define ITINERARIO_MAX_PERNAS 4               // Máximo de voos de um itinerário
+#define ITINERARIO_CONEXAO_PADRAO 45          // Conexão mínima padrão, em minutos
+#define ITINERARIO_ESPERA_MAXIMA (24 * 3600)  // Maior espera entre duas pernas, em segundos
+
+/**
+ * Busca de itinerários com conexões.
+ *
+ * Uma consulta "itn max trigrama org dst início fim pernas [conexão]" pede os
+ * `max` melhores itinerários de `org` a `dst` cuja primeira perna parte
+ * entre `início` e `fim` (inclusive, no formato 2022-06-10T00:00:00), com no
+ * máximo `pernas` voos e pelo menos `conexão` minutos (padrão 45) e no máximo
+ * 24 horas entre a chegada de uma perna e a partida da seguinte, sem repetir
+ * aeroportos. Os itinerários são ordenados pelo trigrama, como os voos:
+ * preço total, duração total (da primeira partida à última chegada) e paradas
+ * (as dos voos mais uma por conexão); empates pela ordem de entrada das
+ * pernas. Voos com chegada anterior à partida ou com preço ou paradas
+ * negativos não fazem parte da rede.
+ */
+
+/**
+ * Parâmetros de uma busca de itinerários.
+ */
+typedef struct {
+    int64_t origem;     // Aeroporto de origem (chave_aeroporto)
+    int64_t destino;    // Aeroporto de destino (chave_aeroporto)
+    time_t partida_min; // Janela de partida da primeira perna (inclusive)
+    time_t partida_max;
+    int max_pernas;     // 1 a ITINERARIO_MAX_PERNAS
+    int conexao_min;    // Conexão mínima, em segundos
+} ConsultaItinerario;
+
+/**
+ * Itinerário encontrado.
+ */
+typedef struct {
+    int num_pernas;
+    int pernas[ITINERARIO_MAX_PERNAS];  // Posições dos voos em ordem de viagem
+    double preco;                       // Soma dos preços
+    long duracao;                       // Última chegada menos a primeira partida
+    int paradas;                        // Paradas dos voos mais as conexões
+} Itinerario;
+
+/**
+ * Rede de rotas: para cada aeroporto, os voos que partem dele ordenados por
+ * partida (e pela ordem de entrada), em vetores contíguos.
+ */
+typedef struct RedeRotas {
+    int num_aeroportos;
+    int64_t *aeroportos;  // Chaves dos aeroportos de origem, em ordem crescente
+    int *inicio;          // Início dos voos de cada aeroporto (num_aeroportos + 1)
+    int *voos;            // Posições dos voos, agrupadas por origem
+    time_t *partidas;     // Partida de cada posição de `voos` (buscas sem ler os voos)
+} RedeRotas;
+
+/**
+ * Constrói a rede de rotas de um vetor de voos.
+ * @return Rede (liberar com liberar_rede_rotas).
+ */
+RedeRotas *construir_rede_rotas(const Flight *voos, int n);
+
+/**
+ * Libera a rede (o vetor de voos não é liberado).
+ */
+void liberar_rede_rotas(RedeRotas *rede);
+
+/**
+ * Interpreta os parâmetros de uma consulta itn ("org dst início fim pernas [conexão]").
+ * @return 1 se os parâmetros forem válidos, 0 caso contrário.
+ */
+int interpretar_itinerario(const char *texto, ConsultaItinerario *consulta);
+
+/**
+ * Busca os `k` melhores itinerários pelo trigrama, por melhor-primeiro sobre
+ * a rede: itinerários parciais saem de uma fila de prioridade pelo limite
+ * inferior do seu critério, então os completos saem já em ordem, e parciais
+ * que não podem superar o k-ésimo completo já encontrado são descartados.
+ * @param rede Rede de rotas.
+ * @param voos Vetor de voos da rede.
+ * @param consulta Parâmetros da busca.
+ * @param trigrama Critério de ordenação.
+ * @param k Quantidade máxima de itinerários.
+ * @param resultados Saída: itinerários em ordem (liberar com free).
+ * @return Quantidade de itinerários encontrados.
+ */
+int buscar_itinerarios(const RedeRotas *rede, const Flight *voos, const ConsultaItinerario *consulta,
+                       const char *trigrama, int k, Itinerario **resultados);
+
+/**
+ * Interpreta os parâmetros de uma consulta itn e busca os itinerários.
+ * @param resultados Saída: itinerários em ordem (liberar com free).
+ * @return Quantidade de itinerários (0 se os parâmetros forem inválidos).
+ */
+int executar_itinerarios(const RedeRotas *rede, const Flight *voos, const Query *consulta, Itinerario **resultados);
+
+/**
+ * Resume um itinerário no formato de um voo: origem e partida da primeira
+ * perna, destino e chegada da última, preço e paradas totais e a menor
+ * quantidade de assentos entre as pernas (id da primeira perna).
+ */
+void resumir_itinerario(const Flight *voos, const Itinerario *itinerario, Flight *resumo);
+
+/**
+ * Escreve os itinerários, cada um numa linha no formato de um voo (origem,
+ * destino, preço total, menor quantidade de assentos entre as pernas,
+ * primeira partida, última chegada e paradas) seguida das pernas, recuadas
+ * em dois espaços.
+ * @return Quantidade de linhas escritas.
+ */
+int imprimir_itinerarios(Saida *saida, const Flight *voos, const Itinerario *itinerarios, int num);
+
+/**
+ * Responde uma consulta itn: a linha da consulta seguida dos itinerários.
+ * @return Quantidade de linhas escritas.
+ */
+int responder_itinerarios(Saida *saida, const RedeRotas *rede, const Flight *voos, const Query *consulta);
+
+#endif // ITINERARY_H
@@ -0,0 +1,99 @@
+#ifndef LSM_H
+#define LSM_H
+
+#include <pthread.h>
+#include "flight.h"
+#include "avl.h"
+#include "query.h"
+#include "output.h"
+#include "thread_pool.h"
+
+#define LSM_CAPACIDADE_SEGMENTO 4096  // Voos do segmento mutável antes de ser selado
+#define LSM_FATOR_MESCLA 4            // Segmentos selados do mesmo nível mesclados de uma vez
+
+/**
+ * Tabela de voos com ingestão estruturada em log (LSM).
+ *
+ * Voos novos são anexados ao segmento mutável, cujos seis índices crescem por
+ * inserção copy-on-write. Quando ele enche, é selado (vira imutável) e um novo
+ * segmento mutável é aberto. Uma thread de fundo mescla cada LSM_FATOR_MESCLA
+ * segmentos selados consecutivos do mesmo nível num segmento do nível seguinte,
+ * com índices construídos em lote, de modo que cada voo é copiado
+ * O(log(n / LSM_CAPACIDADE_SEGMENTO)) vezes e nunca há reconstrução completa.
+ *
+ * A lista de segmentos é publicada por um ponteiro atômico; consultas leem a
+ * lista vigente dentro de uma época e a tratam como um conjunto de fatias,
+ * sem travas.
+ */
+
+/**
+ * Segmento: intervalo contíguo de ids de voos com os seus próprios índices
+ * (ids locais ao segmento, como nas fatias).
+ */
+typedef struct {
+    Flight *voos;                           // Voos do segmento (capacidade fixa enquanto mutável)
+    _Atomic int n;                          // Voos visíveis no segmento
+    int capacidade;                         // Tamanho alocado de `voos`
+    int primeiro_id;                        // Id do primeiro voo do segmento
+    int nivel;                              // 0 ao ser selado; +1 a cada mescla
+    AVLTree *arvores[NUM_CAMPOS_INDICE];    // Índices, na ordem de CampoIndice
+} Segmento;
+
+/**
+ * Versão imutável da lista de segmentos, em ordem crescente de id. O último é
+ * o segmento mutável.
+ */
+typedef struct {
+    int num_segmentos;
+    Segmento *segmentos[];
+} ListaSegmentos;
+
+/**
+ * Tabela LSM.
+ */
+typedef struct {
+    _Atomic(ListaSegmentos *) lista;  // Versão publicada da lista de segmentos
+    int proximo_id;                   // Id do próximo voo ingerido
+    ThreadPool *pool;                 // Threads que executam as consultas entre segmentos
+    pthread_mutex_t trava;            // Serializa ingestão e publicação de mesclas
+    pthread_cond_t tem_mescla;        // Sinaliza a thread de mescla
+    int mescla_pendente;              // Um segmento foi selado desde a última verificação
+    int encerrar;                     // Sinaliza o fim da thread de mescla
+    pthread_t mesclador;              // Thread de mescla em segundo plano
+} TabelaLSM;
+
+/**
+ * Cria uma tabela vazia e inicia a thread de mescla.
+ * @param num_threads Threads do pool de consulta.
+ * @return Tabela (liberar com liberar_tabela_lsm).
+ */
+TabelaLSM *criar_tabela_lsm(int num_threads);
+
+/**
+ * Encerra a thread de mescla e libera a tabela e os seus segmentos.
+ */
+void liberar_tabela_lsm(TabelaLSM *tabela);
+
+/**
+ * Anexa um voo ao segmento mutável (O(1) amortizado mais a inserção nos
+ * índices de um segmento de tamanho limitado). Pode ser chamada junto com
+ * consultas em outras threads.
+ * @param tabela Tabela de destino.
+ * @param voo Voo a ingerir (o id é atribuído pela tabela).
+ * @return Id atribuído ao voo.
+ */
+int inserir_voo_lsm(TabelaLSM *tabela, const Flight *voo);
+
+/**
+ * Executa uma consulta (listagem ou agregação) sobre todos os segmentos e
+ * escreve o resultado na saída. O resultado é idêntico ao da avaliação sobre
+ * uma tabela única com os mesmos voos.
+ */
+void responder_consulta_lsm(TabelaLSM *tabela, const Query *consulta, Saida *saida);
+
+/**
+ * Número de segmentos da versão publicada (incluindo o mutável).
+ */
+int num_segmentos_lsm(TabelaLSM *tabela);
+
+#endif // LSM_H
@@ -0,0 +1,81 @@
+#ifndef OOC_H
+#define OOC_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "flight.h"
+#include "query.h"
+#include "output.h"
+
+#define OOC_MAGICO 0x58335054u            // "TP3X"
+#define OOC_VERSAO 1
+#define OOC_MEMORIA_PADRAO (256u << 20)   // Memória padrão para a construção (256 MiB)
+#define OOC_NUM_CAMPOS 6                  // org, dst, prc, sea, dur, sto
+
+/**
+ * Armazém externo (out-of-core): os voos ficam em arquivos colunares e cada
+ * campo consultável tem um arquivo de índice ordenado, sem ponteiros, com
+ * entradas (chave, id). Todos os arquivos são mapeados em memória na consulta,
+ * de modo que só as páginas efetivamente tocadas ocupam RAM.
+ *
+ * Chaves: aeroportos são os 3 caracteres empacotados (mesma ordem de strcmp),
+ * preços são centavos e os demais campos são o próprio inteiro.
+ */
+
+/**
+ * Entrada de um arquivo de índice externo.
+ */
+typedef struct {
+    int64_t chave;  // Chave codificada do campo
+    uint32_t id;    // Posição do voo nas colunas
+    uint32_t pad;   // Alinhamento (sempre zero)
+} EntradaExterna;
+
+/**
+ * Armazém externo aberto para consulta.
+ */
+typedef struct ArmazemExterno ArmazemExterno;
+
+/**
+ * Lê `n` voos em fluxo do arquivo e constrói o armazém no diretório indicado.
+ * Os índices são ordenados em blocos que cabem em `memoria` bytes, gravados
+ * como execuções temporárias e depois intercalados.
+ * @param arquivo Arquivo posicionado no primeiro voo.
+ * @param n Número de voos a ler.
+ * @param diretorio Diretório de destino (deve existir).
+ * @param memoria Limite de memória para os blocos de ordenação, em bytes.
+ * @return 1 em caso de sucesso, 0 em erro.
+ */
+int construir_armazem_externo(FILE *arquivo, int n, const char *diretorio, size_t memoria);
+
+/**
+ * Mapeia em memória um armazém construído anteriormente.
+ * @return Ponteiro para o armazém, ou NULL em erro.
+ */
+ArmazemExterno *abrir_armazem_externo(const char *diretorio);
+
+/**
+ * Desfaz os mapeamentos e libera o armazém.
+ */
+void fechar_armazem_externo(ArmazemExterno *armazem);
+
+/**
+ * Número de voos do armazém.
+ */
+int tamanho_armazem_externo(const ArmazemExterno *armazem);
+
+/**
+ * Executa uma consulta sobre o armazém e escreve o resultado na saída.
+ * O predicado mais seletivo (estimado pelos índices) percorre seu intervalo no
+ * índice mapeado; os demais são verificados nas colunas, e só os voos que
+ * passam entram num heap limitado a `max_voos`.
+ */
+void responder_consulta_externa(const ArmazemExterno *armazem, const Query *consulta, Saida *saida);
+
+/**
+ * Agrega os preços dos voos que satisfazem a consulta (COUNT/MIN/MAX/AVG/SUM),
+ * lendo apenas as colunas dos predicados e do preço.
+ */
+void agregar_consulta_externa(const ArmazemExterno *armazem, const Query *consulta, AgregadoPreco *agregado);
+
+#endif // OOC_H
@@ -0,0 +1,90 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "flight.h"
+#include "query.h"
+
+#define SAIDA_CAPACIDADE_PADRAO (1 << 20)  // Buffer padrão de 1 MiB
+#define SAIDA_MAX_LINHA 160                // Tamanho máximo de uma linha de voo formatada
+
+/**
+ * Buffer de saída. Acumula o texto formatado e o envia ao descritor com uma
+ * única chamada a write() quando enche ou quando descarregado explicitamente.
+ * Com fd == -1 o buffer apenas cresce em memória (útil para montar respostas).
+ */
+typedef struct {
+    char *dados;        // Área de escrita
+    size_t tamanho;     // Bytes ocupados
+    size_t capacidade;  // Bytes alocados
+    int fd;             // Descritor de destino (-1 para acumular em memória)
+} Saida;
+
+/**
+ * Cria um buffer de saída.
+ * @param fd Descritor de destino (ex: STDOUT_FILENO) ou -1 para acumular em memória.
+ * @param capacidade Tamanho inicial do buffer em bytes.
+ * @return Ponteiro para o buffer criado.
+ */
+Saida *criar_saida(int fd, size_t capacidade);
+
+/**
+ * Descarrega o conteúdo pendente e libera o buffer.
+ */
+void liberar_saida(Saida *saida);
+
+/**
+ * Envia o conteúdo acumulado ao descritor (não faz nada se fd == -1).
+ */
+void descarregar_saida(Saida *saida);
+
+/**
+ * Garante espaço contíguo para `tamanho` bytes, descarregando ou crescendo o buffer.
+ * @return Ponteiro para a posição livre do buffer.
+ */
+char *reservar_saida(Saida *saida, size_t tamanho);
+
+/**
+ * Copia `tamanho` bytes para o buffer de saída.
+ */
+void escrever_saida(Saida *saida, const char *dados, size_t tamanho);
+
+/**
+ * Formata o preço com as mesmas regras do formato textual de saída:
+ * sem casas decimais quando os centavos truncados são zero; caso contrário,
+ * arredonda para duas casas e remove um zero final.
+ * @param preco Preço do voo.
+ * @param buffer Destino (pelo menos 32 bytes).
+ * @return Número de caracteres escritos (sem '\0').
+ */
+int formatar_preco(float preco, char *buffer);
+
+/**
+ * Formata um timestamp como YYYY-MM-DDTHH:MM:SS (hora local), usando um cache
+ * de datas por dia para evitar localtime() a cada chamada.
+ * @param timestamp Valor de tempo Unix.
+ * @param buffer Destino (pelo menos 20 bytes; recebe 19 caracteres e '\0').
+ */
+void formatar_data_cache(time_t timestamp, char *buffer);
+
+/**
+ * Escreve a linha de cabeçalho de uma consulta ("max trigrama expressão",
+ * "page [cursor] max trigrama expressão", "AGREGACAO [prc] expressão" ou
+ * "itn max trigrama parâmetros").
+ */
+void imprimir_consulta(Saida *saida, const Query *consulta);
+
+/**
+ * Escreve um voo no formato de saída.
+ */
+void imprimir_voo(Saida *saida, const Flight *voo);
+
+/**
+ * Escreve o resultado de uma consulta de agregação (uma linha).
+ */
+void imprimir_agregacao(Saida *saida, const Query *consulta, const AgregadoPreco *agregado);
+
+#endif // OUTPUT_H
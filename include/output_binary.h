@@ -0,0 +1,90 @@
+#ifndef OUTPUT_BINARY_H
+#define OUTPUT_BINARY_H
+
+#include <stdint.h>
+#include "flight.h"
+#include "query.h"
+#include "output.h"
+#include "itinerary.h"
+
+#define BINARIO_MAGICA "TP3B"  // Assinatura do fluxo de resultados binário
+#define BINARIO_VERSAO 2
+#define BINARIO_NUM_COLUNAS 9
+#define BINARIO_TAMANHO_LINHA 44   // Bytes de um voo
+#define BINARIO_TAMANHO_CABECALHO 24  // Bytes do cabeçalho de uma consulta (com o tamanho)
+
+/**
+ * Saída binária dos resultados (--output=binary).
+ *
+ * Fluxo de registros com prefixo de tamanho, escrito direto dos voos, sem
+ * formatação de texto. Inteiros na ordem de bytes da máquina:
+ *
+ *   cabeçalho: "TP3B" + uint32 versão + uint16 bytes por voo + uint16 colunas
+ *              + uma descrição por coluna: char nome[12] + uint8 tipo +
+ *              uint8 largura + uint16 deslocamento na linha
+ *   consulta:  uint32 tamanho (bytes seguintes do registro) + uint8 tipo
+ *              (TipoAgregacao) + uint8 flags (bit 0: paginada) + uint16 0 +
+ *              int32 max_voos + char trigrama[4] + uint32 número da consulta
+ *              (ordem na entrada, a partir de 0) + uint32 resultados, seguido de:
+ *                listagem:   `resultados` voos; se paginada, o cursor da
+ *                            próxima página (CURSOR_TAMANHO bytes, zeros no fim)
+ *                agregação:  int64 quantidade + double soma + int64 mínimo e
+ *                            int64 máximo em centavos + float mínimo e
+ *                            float máximo (resultados = 1)
+ *                itn:        por itinerário, uint32 pernas + o resumo no
+ *                            formato de um voo + as pernas
+ *
+ * Um voo tem id (ordem de entrada), origem e destino (códigos de três letras
+ * empacotados, como chave_aeroporto), preço em centavos, assentos, paradas,
+ * partida e chegada (segundos desde a época) e o preço lido da entrada
+ * (float): os centavos são a chave das consultas, mas a saída de texto
+ * formata o valor lido (7.005 é impresso como 7 e tem a chave 7.01). O
+ * resumo de um itinerário usa o id da primeira perna.
+ */
+
+/**
+ * Tipos das colunas na descrição do cabeçalho.
+ */
+typedef enum {
+    COLUNA_INTEIRO,    // int32 ou int64, conforme a largura
+    COLUNA_AEROPORTO,  // uint32 com o código empacotado
+    COLUNA_CENTAVOS,   // int32 com o preço em centavos
+    COLUNA_EPOCA,      // int64 com segundos desde a época
+    COLUNA_REAL        // float com o preço lido
+} TipoColuna;
+
+/**
+ * Escreve o cabeçalho do fluxo.
+ */
+void escrever_cabecalho_binario(Saida *saida);
+
+/**
+ * Escreve o cabeçalho de uma listagem; os voos seguem com escrever_voo_binario
+ * e, numa consulta paginada, o cursor com escrever_cursor_binario.
+ * @param numero Ordem da consulta na entrada.
+ * @param num_voos Quantidade de voos que serão escritos.
+ */
+void escrever_listagem_binaria(Saida *saida, const Query *consulta, uint32_t numero, int num_voos);
+
+/**
+ * Escreve um voo (BINARIO_TAMANHO_LINHA bytes).
+ */
+void escrever_voo_binario(Saida *saida, const Flight *voo);
+
+/**
+ * Escreve o cursor da próxima página de uma listagem paginada (nada nas demais).
+ */
+void escrever_cursor_binario(Saida *saida, const Query *consulta, const Flight *ultimo, int ha_mais);
+
+/**
+ * Escreve o registro completo de uma agregação.
+ */
+void escrever_agregacao_binaria(Saida *saida, const Query *consulta, uint32_t numero, const AgregadoPreco *agregado);
+
+/**
+ * Escreve o registro completo de uma busca de itinerários.
+ */
+void escrever_itinerarios_binarios(Saida *saida, const Query *consulta, uint32_t numero, const Flight *voos,
+                                   const Itinerario *itinerarios, int num);
+
+#endif // OUTPUT_BINARY_H
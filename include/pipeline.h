@@ -0,0 +1,26 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdio.h>
+#include "flight.h"
+#include "query.h"
+#include "output.h"
+
+#define PIPELINE_CAPACIDADE 256  // Consultas em trânsito entre duas etapas
+
+/**
+ * Processa `num_consultas` consultas do arquivo num pipeline de três threads:
+ * leitura (carregar_consulta + parse_expressao), execução (filtro + ordenação)
+ * e formatação da saída. As etapas se comunicam por filas circulares sem travas
+ * e, como cada fila é FIFO, a saída sai na mesma ordem das consultas.
+ * @param entrada Arquivo posicionado na primeira consulta.
+ * @param num_consultas Número de consultas a processar.
+ * @param indices Índices da tabela.
+ * @param voos Vetor de voos.
+ * @param n Quantidade de voos.
+ * @param saida Buffer de saída.
+ * @return 1 se todas as consultas foram lidas, 0 se houve erro de leitura.
+ */
+int executar_pipeline(FILE *entrada, int num_consultas, const IndicesVoos *indices, Flight *voos, int n, Saida *saida);
+
+#endif // PIPELINE_H
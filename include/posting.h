@@ -0,0 +1,83 @@
+#ifndef POSTING_H
+#define POSTING_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define POSTINGS_BLOCO 128          // Índices por bloco comprimido (4 grupos de 32)
+#define POSTINGS_MIN_COMPRIMIR 16   // Listas menores ficam como vetor simples
+
+/**
+ * Cabeçalho de um bloco comprimido. A tabela de cabeçalhos funciona como
+ * lista de saltos: intersecções comparam [primeiro, ultimo] e pulam o bloco
+ * inteiro sem decodificá-lo.
+ */
+typedef struct {
+    int primeiro;           // Primeiro índice do bloco
+    int ultimo;             // Último índice do bloco
+    uint32_t deslocamento;  // Posição (em palavras de 32 bits) dos dados empacotados
+    uint8_t largura;        // Bits por delta
+    uint8_t quantidade;     // Índices no bloco (1..POSTINGS_BLOCO)
+} BlocoPostings;
+
+/**
+ * Lista de índices ordenada, codificada em deltas (id[i] - id[i-1] - 1)
+ * empacotados em blocos de POSTINGS_BLOCO com largura de bits por bloco.
+ */
+typedef struct {
+    int total;              // Número total de índices
+    int num_blocos;         // Número de blocos
+    BlocoPostings *blocos;  // Tabela de saltos
+    uint32_t *dados;        // Deltas empacotados
+} ListaPostings;
+
+/**
+ * Comprime uma lista de índices em ordem crescente estrita.
+ * @param indices Vetor ordenado de índices.
+ * @param n Quantidade de índices.
+ * @return Lista comprimida (liberar com liberar_postings).
+ */
+ListaPostings *comprimir_postings(const int *indices, int n);
+
+/**
+ * Libera uma lista comprimida.
+ */
+void liberar_postings(ListaPostings *lista);
+
+/**
+ * Decodifica um bloco para `destino` (capacidade mínima POSTINGS_BLOCO).
+ * @return Quantidade de índices decodificados.
+ */
+int decodificar_bloco_postings(const ListaPostings *lista, int bloco, int *destino);
+
+/**
+ * Decodifica a lista inteira para `destino` (capacidade mínima lista->total).
+ * @return Quantidade de índices decodificados.
+ */
+int descomprimir_postings(const ListaPostings *lista, int *destino);
+
+/**
+ * Intersecciona um vetor ordenado com a lista comprimida, pulando os blocos
+ * cujo intervalo [primeiro, ultimo] não contém nenhum candidato.
+ * @param candidatos Vetor ordenado de índices.
+ * @param n Quantidade de candidatos.
+ * @param lista Lista comprimida.
+ * @param destino Saída (capacidade mínima n).
+ * @return Quantidade de índices na interseção.
+ */
+int intersectar_postings(const int *candidatos, int n, const ListaPostings *lista, int *destino);
+
+/**
+ * Memória ocupada pela lista comprimida, em bytes.
+ */
+size_t memoria_postings(const ListaPostings *lista);
+
+/**
+ * Memória que a lista ocuparia comprimida, sem comprimi-la.
+ * @param indices Vetor ordenado de índices.
+ * @param n Quantidade de índices.
+ * @return Bytes (os de memoria_postings após comprimir_postings).
+ */
+size_t estimar_memoria_postings(const int *indices, int n);
+
+#endif // POSTING_H
@@ -0,0 +1,57 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+/**
+ * Perfil por fase com contadores de hardware (perf_event_open).
+ *
+ * Com o perfil ativo, ciclos, instruções, falhas de cache L1 de dados e de
+ * último nível e erros de previsão de desvio são lidos a cada troca de fase e
+ * atribuídos à fase corrente. Fases podem ser aninhadas (ex: a avaliação
+ * dentro de uma consulta): a externa fica suspensa enquanto a interna está
+ * aberta, então cada evento é contado numa única fase. Ao sair do programa é
+ * impressa uma tabela por fase em stderr.
+ *
+ * Só a thread que ativou o perfil é medida (as threads criadas por ela depois
+ * da ativação, como as da construção paralela dos índices, entram na conta
+ * quando terminam). Contadores indisponíveis (sem suporte do processador, em
+ * máquina virtual ou bloqueados por perf_event_paranoid) aparecem como "n/d";
+ * o tempo de relógio é sempre medido. Sem perfil ativo, as marcações custam
+ * um teste de variável.
+ */
+
+/**
+ * Fases medidas.
+ */
+typedef enum {
+    FASE_CARGA,       // Leitura dos voos
+    FASE_INDICES,     // Construção dos índices (ou dos resumos da varredura)
+    FASE_PARSE,       // Leitura e interpretação das consultas
+    FASE_AVALIACAO,   // Avaliação dos predicados
+    FASE_ORDENACAO,   // Ordenação dos resultados
+    FASE_SAIDA,       // Formatação e escrita da saída
+    NUM_FASES
+} FasePerfil;
+
+/**
+ * Abre os contadores e passa a medir a thread atual. Registra a impressão da
+ * tabela na saída do programa.
+ * @return Quantidade de contadores de hardware disponíveis (0 = só o tempo).
+ */
+int ativar_perfil();
+
+/**
+ * Abre uma fase (suspendendo a fase aberta, se houver).
+ */
+void entrar_fase(FasePerfil fase);
+
+/**
+ * Fecha a fase aberta mais interna e retoma a anterior.
+ */
+void sair_fase();
+
+/**
+ * Imprime a tabela de contadores por fase em stderr.
+ */
+void imprimir_perfil();
+
+#endif // PROFILE_H
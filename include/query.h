@@ -4,19 +4,37 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 #include "flight.h"
 #include "avl.h"
 #include "expr_parser.h"
 
+#define TAM_CHAVE_INDICE 48  // Tamanho máximo de uma chave formatada de índice
+
 /**
- * Índices AVL para busca eficiente por diferentes atributos dos voos.
+ * Índices AVL de uma tabela de voos, um por atributo consultável. Cada tabela
+ * tem o seu conjunto; nada é global, então várias tabelas convivem no mesmo
+ * processo.
  */
-extern struct AVLTree *indice_origem;    
-extern struct AVLTree *indice_destino;   
-extern struct AVLTree *indice_preco;     
-extern struct AVLTree *indice_assentos;  
-extern struct AVLTree *indice_duracao;   
-extern struct AVLTree *indice_paradas;   
+typedef struct {
+    AVLTree *arvores[NUM_CAMPOS_INDICE];  // Na ordem de CampoIndice
+    struct RedeRotas *rotas;              // Voos por origem e partida (consultas itn)
+    pthread_mutex_t trava_escrita;        // Serializa as atualizações; leitores nunca a adquirem
+} IndicesVoos;
+
+/**
+ * Tipo de consulta: listagem dos voos (padrão), agregação sobre os preços ou
+ * busca de itinerários com conexões.
+ */
+typedef enum {
+    AGREGACAO_NENHUMA,  // "max trigrama expressão"
+    AGREGACAO_COUNT,    // "COUNT expressão"
+    AGREGACAO_MIN,      // "MIN prc expressão"
+    AGREGACAO_MAX,      // "MAX prc expressão"
+    AGREGACAO_AVG,      // "AVG prc expressão"
+    AGREGACAO_SUM,      // "SUM prc expressão"
+    CONSULTA_ITINERARIO // "itn max trigrama org dst início fim pernas [conexão]"
+} TipoAgregacao;
 
 /**
  * Estrutura de uma consulta de voo.
@@ -24,27 +42,115 @@ extern struct AVLTree *indice_paradas;
 typedef struct {
     int max_voos;        // Número máximo de voos a exibir
     char trigrama[4];    // Código do aeroporto
-    char expressao[256]; // Expressão da consulta
+    char expressao[256]; // Expressão da consulta (parâmetros, na busca de itinerários)
+    TipoAgregacao agregacao; // AGREGACAO_NENHUMA para consultas de listagem
+    int paginada;        // Listagem "page": a saída termina com o cursor da próxima página
+    int tem_cursor;      // Retoma estritamente depois de `cursor`
+    Flight cursor;       // Chave do último voo da página anterior (preço, duração, paradas e id)
 } Query;
 
 /**
- * Inicializa os índices AVL.
+ * Cria um conjunto de índices vazio.
+ * @return Índices (liberar com liberar_indices).
  */
-void inicializar_indices();
+IndicesVoos *criar_indices();
+
+/**
+ * Libera as árvores e o conjunto de índices. Não pode haver leituras em andamento.
+ */
+void liberar_indices(IndicesVoos *indices);
 
 /**
  * Constrói os índices AVL com os voos carregados.
  */
-void construir_indices(Flight *voos, int n);
+void construir_indices(IndicesVoos *indices, Flight *voos, int n);
+
+/**
+ * Rede de rotas para uma busca de itinerários: a dos índices ou uma
+ * temporária, se o plano de índices não a incluiu.
+ * @return Rede (devolver com liberar_rede_consulta).
+ */
+const struct RedeRotas *rede_rotas_consulta(const IndicesVoos *indices, const Flight *voos, int n);
+
+/**
+ * Devolve a rede obtida com rede_rotas_consulta (libera a temporária).
+ */
+void liberar_rede_consulta(const IndicesVoos *indices, const struct RedeRotas *rede);
+
+/**
+ * Popula um conjunto de seis árvores (na ordem de CampoIndice) com os voos.
+ */
+void construir_arvores_indices(AVLTree *arvores[], Flight *voos, int n);
+
+/**
+ * Constrói os índices em lote num pool de threads (uma tarefa por índice e por faixa de chaves).
+ */
+void construir_indices_paralelo(AVLTree *arvores[], Flight *voos, int n, int num_threads);
+
+/**
+ * Define quantas threads a construção dos índices usa (0 = processadores disponíveis).
+ */
+void definir_threads_indices(int num_threads);
+
+/**
+ * Formata a chave de um voo para o índice do campo.
+ */
+void formatar_chave_indice(const Flight *voo, CampoIndice campo, char *chave);
+
+/**
+ * Comprime as listas de índices de todas as árvores (postings em blocos).
+ */
+void comprimir_indices(IndicesVoos *indices);
+
+/**
+ * Atualiza o preço ("prc") ou os assentos ("sea") de um voo sem bloquear leitores.
+ * @return 1 se o voo foi atualizado, 0 se o id ou o campo forem inválidos.
+ */
+int atualizar_voo(IndicesVoos *indices, Flight *voos, int n, int id, const char *campo, const char *valor);
 
 /**
  * Filtra os voos usando a árvore de expressões e AVL.
+ * Devolve os ids (posições em `voos`) dos voos selecionados, sem copiá-los.
+ */
+int filtrar_voos(const IndicesVoos *indices, Flight *voos, int n, const Query *consulta, int **resultados);
+
+/**
+ * Filtra os voos a partir de uma árvore de expressão já construída (ids em `resultados`).
+ */
+int filtrar_voos_expressao(const IndicesVoos *indices, Flight *voos, int n, const ExprNode *expressao, int **resultados);
+
+/**
+ * Agrega os preços dos voos que atendem à consulta sem copiar os voos.
+ * Um único predicado é respondido pelos agregados das subárvores do índice.
  */
-int filtrar_voos(Flight *voos, int n, const Query *consulta, Flight **resultados);
+void agregar_voos(const IndicesVoos *indices, Flight *voos, int n, const Query *consulta, AgregadoPreco *agregado);
+
+/**
+ * Custo estimado de avaliar as folhas de uma conjunção pelos índices: a soma
+ * das contagens das folhas indexadas, lidas dos agregados das subárvores
+ * (0 se alguma for vazia; `n` sem folhas indexadas).
+ */
+long estimar_custo_folhas(const IndicesVoos *indices, int n, const FaixaPredicado *folhas, int num);
+
+/**
+ * Custo estimado de responder a consulta pelos índices, na mesma escala
+ * (agregações de um único predicado indexado custam 0, itinerários `n`).
+ */
+long estimar_custo_consulta(const IndicesVoos *indices, int n, const Query *consulta);
+
+/**
+ * Nome da agregação ("COUNT", "MIN"...), ou NULL para listagem.
+ */
+const char *nome_agregacao(TipoAgregacao agregacao);
 
 /**
  * Lê uma consulta do arquivo de entrada.
  */
 int carregar_consulta(FILE *arquivo, Query *consulta);
 
+/**
+ * Interpreta uma consulta a partir de uma linha já lida (sem consumir arquivo).
+ */
+int interpretar_consulta(const char *linha, Query *consulta);
+
 #endif // QUERY_H
@@ -0,0 +1,51 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+/**
+ * Fila circular limitada, sem travas, para exatamente um produtor e um consumidor.
+ * O produtor só escreve `cauda` e o consumidor só escreve `cabeca`; cada lado lê
+ * o índice do outro com semântica acquire, o que publica o item armazenado.
+ */
+typedef struct {
+    void **itens;               // Vetor de itens (capacidade potência de 2)
+    size_t mascara;             // capacidade - 1
+    _Alignas(64) atomic_size_t cabeca;  // Próxima posição a consumir
+    _Alignas(64) atomic_size_t cauda;   // Próxima posição a produzir
+} RingBuffer;
+
+/**
+ * Cria uma fila com capacidade arredondada para a próxima potência de 2.
+ */
+RingBuffer *criar_ring_buffer(size_t capacidade);
+
+/**
+ * Libera a fila (os itens pendentes não são liberados).
+ */
+void liberar_ring_buffer(RingBuffer *fila);
+
+/**
+ * Tenta inserir um item.
+ * @return 1 se inseriu, 0 se a fila está cheia.
+ */
+int tentar_inserir_ring(RingBuffer *fila, void *item);
+
+/**
+ * Tenta remover um item.
+ * @return 1 se removeu (item em *item), 0 se a fila está vazia.
+ */
+int tentar_remover_ring(RingBuffer *fila, void **item);
+
+/**
+ * Insere um item, aguardando (com sched_yield) enquanto a fila estiver cheia.
+ */
+void inserir_ring(RingBuffer *fila, void *item);
+
+/**
+ * Remove um item, aguardando (com sched_yield) enquanto a fila estiver vazia.
+ */
+void *remover_ring(RingBuffer *fila);
+
+#endif // RING_BUFFER_H
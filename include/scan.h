@@ -0,0 +1,115 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <stdint.h>
+#include "flight.h"
+#include "avl.h"
+#include "query.h"
+#include "output.h"
+
+#define ZONA_TAMANHO 1024  // Voos por bloco do mapa de zonas
+
+/**
+ * Campos resumidos no mapa de zonas: os seis campos indexados (na ordem de
+ * CampoIndice) e a partida (CAMPO_PARTIDA).
+ */
+#define NUM_CAMPOS_ZONA (NUM_CAMPOS_INDICE + 1)
+
+/**
+ * Resumo de um bloco de ZONA_TAMANHO voos consecutivos: mínimo e máximo da
+ * chave de cada campo (aeroportos empacotados na ordem de strcmp, preço em
+ * centavos, partida em segundos) e um filtro de 64 bits dos aeroportos de
+ * origem e de destino presentes no bloco.
+ */
+typedef struct {
+    int64_t min[NUM_CAMPOS_ZONA];
+    int64_t max[NUM_CAMPOS_ZONA];
+    uint64_t origens;   // Bit (hash do código % 64) de cada origem do bloco
+    uint64_t destinos;  // Idem para os destinos
+} Zona;
+
+/**
+ * Mapa de zonas de um vetor de voos.
+ */
+typedef struct {
+    const Flight *voos;  // Vetor resumido (continua pertencendo ao chamador)
+    int n;               // Quantidade de voos
+    int num_zonas;       // Quantidade de blocos (o último pode ser incompleto)
+    Zona *zonas;
+} MapaZonas;
+
+/**
+ * Critério de agrupamento da ordem de carga.
+ */
+typedef enum {
+    AGRUPAR_NENHUM,
+    AGRUPAR_ROTA,   // Por (origem, destino)
+    AGRUPAR_DATA    // Por partida
+} CriterioAgrupamento;
+
+/**
+ * Interpreta o nome de um critério de agrupamento ("route" ou "date").
+ * @return O critério, ou -1 se o nome for desconhecido.
+ */
+int criterio_agrupamento(const char *nome);
+
+/**
+ * Reordena os voos pelo critério, preservando o id (ordem de entrada) de cada
+ * um; empates continuam em ordem de entrada. Deve ser chamada antes da
+ * construção dos índices e do mapa de zonas.
+ */
+void agrupar_voos(Flight *voos, int n, CriterioAgrupamento criterio);
+
+/**
+ * Constrói o mapa de zonas de um vetor de voos.
+ * @return Mapa (liberar com liberar_mapa_zonas).
+ */
+MapaZonas *construir_mapa_zonas(const Flight *voos, int n);
+
+/**
+ * Libera o mapa de zonas (o vetor de voos não é liberado).
+ */
+void liberar_mapa_zonas(MapaZonas *mapa);
+
+/**
+ * Filtra os voos por varredura, pulando os blocos cujos resumos não podem
+ * satisfazer a conjunção. Os predicados são comparações numéricas exatas
+ * (preço em centavos).
+ * @param mapa Mapa de zonas.
+ * @param consulta Consulta a aplicar.
+ * @param resultados Saída: posições dos voos selecionados, em ordem crescente (liberar com free).
+ * @return Quantidade de voos selecionados.
+ */
+int filtrar_voos_varredura(const MapaZonas *mapa, const Query *consulta, int **resultados);
+
+/**
+ * Agrega os preços dos voos que atendem à consulta por varredura.
+ */
+void agregar_voos_varredura(const MapaZonas *mapa, const Query *consulta, AgregadoPreco *agregado);
+
+/**
+ * Estima o custo de uma varredura: quantidade de voos nos blocos cujos
+ * resumos são compatíveis com as folhas da conjunção.
+ * @param mapa Mapa de zonas.
+ * @param folhas Folhas já convertidas (converter_folhas_expressao).
+ * @param num Quantidade de folhas.
+ * @return Voos que a varredura leria.
+ */
+long estimar_linhas_varredura(const MapaZonas *mapa, const FaixaPredicado *folhas, int num);
+
+/**
+ * Responde um lote de consultas numa única passagem pelos voos (varredura
+ * compartilhada). Em cada bloco, só as consultas cujos predicados são
+ * compatíveis com o resumo ficam ativas; as chaves de cada voo são calculadas
+ * uma vez e testadas contra todas elas. Os voos aprovados entram no heap
+ * limitado (`max_voos`) ou no agregado da consulta. A saída é escrita na
+ * ordem das consultas e é idêntica à de responder cada uma com
+ * filtrar_voos_varredura/agregar_voos_varredura.
+ * @param mapa Mapa de zonas.
+ * @param consultas Consultas do lote.
+ * @param num_consultas Quantidade de consultas.
+ * @param saida Saída das respostas.
+ */
+void responder_lote_varredura(const MapaZonas *mapa, const Query *consultas, int num_consultas, Saida *saida);
+
+#endif // SCAN_H
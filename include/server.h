@@ -0,0 +1,105 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "flight.h"
+#include "query.h"
+#include "output.h"
+#include "capture.h"
+#include "standing.h"
+#include "epoch.h"
+
+#define SERVIDOR_MAX_LINHA 512   // Tamanho máximo de uma linha de consulta recebida
+#define SERVIDOR_FILA 64         // Conexões pendentes aceitas pelo listen()
+#define SERVIDOR_MAX_CONEXOES (EPOCA_MAX_LEITORES - 1)  // Clientes simultâneos (um slot de época fica com a thread principal)
+#define SERVIDOR_FRACAO_CARA 4   // Consulta cara: custo estimado de pelo menos n / 4 ids
+#define SERVIDOR_MAX_PENDENTES (4 * 1024 * 1024)  // Bytes de diferenças à espera de uma conexão antes de encerrá-la
+
+/**
+ * Modo servidor: os voos e índices já estão carregados e cada linha recebida
+ * no formato "max trigrama expressão" é respondida com um quadro:
+ *
+ *   OK <linhas> <bytes>\n<bytes de payload>
+ *   ERR <bytes>\n<mensagem>
+ *
+ * O payload de OK é idêntico à saída do modo em lote para a mesma consulta
+ * (linha da consulta seguida dos voos).
+ *
+ * Linhas "upd <id> <prc|sea> <valor>" atualizam um voo sem bloquear as
+ * consultas de outros clientes e são respondidas com "OK 0 0".
+ *
+ * Com limites (LimitesServidor), cada consulta tem um prazo contado da
+ * chegada e as consultas caras pelo custo estimado do planejador
+ * (estimar_custo_consulta) disputam um número limitado de vagas, esperando
+ * por uma dentro do próprio prazo. A avaliação verifica o prazo nos laços
+ * longos e é interrompida quando ele acaba; a resposta é então
+ *
+ *   TIMEOUT <linhas> <bytes>\n<bytes de payload>
+ *
+ * com só a linha da consulta no payload, sem resultados parciais.
+ *
+ * Uma linha "watch <consulta>" registra uma listagem permanente (standing.h):
+ * a resposta é um quadro OK cujo payload começa com "watch <id>", seguido da
+ * linha da consulta e das linhas "+" do resultado inicial. A partir daí, toda atualização (de qualquer
+ * cliente) que mude o resultado envia à conexão um quadro
+ *
+ *   DIFF <id> <linhas> <bytes>\n<linhas "-" e "+">
+ *
+ * antes da resposta à atualização. "unwatch <id>" encerra a consulta e as
+ * consultas de uma conexão são encerradas quando ela fecha. Os quadros DIFF
+ * são escritos pela thread da conexão que os recebe; uma conexão que deixa
+ * de ler e acumula mais de SERVIDOR_MAX_PENDENTES bytes é encerrada.
+ */
+
+/**
+ * Limites de atendimento das consultas.
+ */
+typedef struct {
+    uint64_t prazo_ns;  // Orçamento de cada consulta, da chegada à resposta (0 = sem prazo)
+    int max_caras;      // Consultas caras em andamento ao mesmo tempo (0 = sem limite)
+    long custo_caro;    // Custo estimado a partir do qual a consulta é cara
+} LimitesServidor;
+
+/**
+ * Executa uma consulta (listagem ou agregação) sobre os índices e escreve a
+ * saída do modo em lote (linha da consulta seguida dos voos ou do agregado).
+ * @param resposta Saída da resposta.
+ * @param indices Índices da tabela.
+ * @param voos Vetor de voos.
+ * @param n Quantidade de voos.
+ * @param consulta Consulta já interpretada.
+ * @return Número de linhas escritas.
+ */
+int responder_consulta_indices(Saida *resposta, const IndicesVoos *indices, Flight *voos, int n, const Query *consulta);
+
+/**
+ * Atende consultas de uma conexão até o fim da entrada.
+ * @param fd_entrada Descritor de onde as consultas são lidas.
+ * @param fd_saida Descritor para onde as respostas são escritas.
+ * @param indices Índices da tabela (atualizados pelas linhas "upd").
+ * @param voos Vetor de voos carregados.
+ * @param n Quantidade de voos.
+ * @param captura Log onde cada consulta respondida é registrada (ou NULL).
+ * @param limites Prazo e admissão das consultas (ou NULL para nenhum).
+ * @param permanentes Consultas permanentes compartilhadas pelas conexões.
+ */
+void atender_conexao(int fd_entrada, int fd_saida, IndicesVoos *indices, Flight *voos, int n,
+                     CapturaConsultas *captura, const LimitesServidor *limites, ConsultasPermanentes *permanentes);
+
+/**
+ * Executa o servidor. Com caminho "-" atende a entrada padrão; caso contrário
+ * escuta no socket Unix indicado, com uma thread por cliente e no máximo
+ * SERVIDOR_MAX_CONEXOES clientes ao mesmo tempo (os demais esperam na fila
+ * do listen() até um cliente sair). Ao encerrar (SIGINT/SIGTERM), espera as
+ * threads dos clientes terminarem.
+ * @param caminho Caminho do socket Unix ou "-".
+ * @param indices Índices da tabela.
+ * @param voos Vetor de voos carregados.
+ * @param n Quantidade de voos.
+ * @param captura Log de captura compartilhado pelos clientes (ou NULL).
+ * @param limites Prazo e admissão das consultas, compartilhados pelos clientes (ou NULL).
+ * @return EXIT_SUCCESS ao encerrar normalmente, EXIT_FAILURE em erro.
+ */
+int executar_servidor(const char *caminho, IndicesVoos *indices, Flight *voos, int n, CapturaConsultas *captura,
+                      const LimitesServidor *limites);
+
+#endif // SERVER_H
@@ -0,0 +1,68 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "flight.h"
+#include "avl.h"
+#include "query.h"
+#include "thread_pool.h"
+
+/**
+ * Fatia da tabela de voos: um intervalo contíguo de ids com os seus próprios
+ * seis índices. Os ids nas listas dos índices são locais à fatia.
+ */
+typedef struct {
+    Flight *voos;                           // Primeiro voo da fatia (dentro do vetor global)
+    int n;                                  // Quantidade de voos da fatia
+    AVLTree *arvores[NUM_CAMPOS_INDICE];    // Índices da fatia, na ordem de CampoIndice
+} Fatia;
+
+/**
+ * Tabela de voos particionada em fatias por intervalo de id. Uma consulta é
+ * espalhada entre as fatias no pool e os resultados parciais são intercalados.
+ */
+typedef struct {
+    Fatia *fatias;      // Fatias em ordem crescente de id
+    int num_fatias;     // Quantidade de fatias
+    ThreadPool *pool;   // Threads que executam as fatias
+} ConjuntoFatias;
+
+/**
+ * Particiona os voos em fatias de ids contíguos e constrói os índices de cada uma.
+ * @param voos Vetor de voos (continua pertencendo ao chamador).
+ * @param n Quantidade total de voos.
+ * @param num_fatias Quantidade de fatias desejada (no mínimo 1).
+ * @param num_threads Threads do pool de consulta.
+ * @return Conjunto de fatias (liberar com liberar_fatias).
+ */
+ConjuntoFatias *criar_fatias(Flight *voos, int n, int num_fatias, int num_threads);
+
+/**
+ * Comprime as listas de índices de todas as fatias.
+ */
+void comprimir_fatias(ConjuntoFatias *conjunto);
+
+/**
+ * Libera as fatias, seus índices e o pool.
+ */
+void liberar_fatias(ConjuntoFatias *conjunto);
+
+/**
+ * Responde uma consulta espalhando-a pelas fatias: cada fatia avalia a
+ * expressão nos seus índices e guarda os seus `max_voos` melhores segundo o
+ * trigrama; os parciais são intercalados em ordem (empates pelo id do voo).
+ * @param conjunto Fatias da tabela.
+ * @param consulta Consulta a responder.
+ * @param resultados Saída: ponteiros para os voos selecionados, em ordem (liberar com free).
+ * @return Quantidade de voos em `resultados` (no máximo limite_pagina(consulta)).
+ */
+int responder_consulta_fatias(ConjuntoFatias *conjunto, const Query *consulta, const Flight ***resultados);
+
+/**
+ * Agrega os preços dos voos que atendem à consulta em todas as fatias.
+ * @param conjunto Fatias da tabela.
+ * @param consulta Consulta de agregação.
+ * @param agregado Saída (combinação dos agregados das fatias).
+ */
+void agregar_consulta_fatias(ConjuntoFatias *conjunto, const Query *consulta, AgregadoPreco *agregado);
+
+#endif // SHARD_H
@@ -17,12 +17,25 @@
 int comparar_voos(const Flight *a, const Flight *b, const char *trigrama);
 
 /**
- * Ordena os voos com base no critério do trigrama da consulta.
- * @param voos Vetor de voos a serem ordenados.
- * @param total_voos Número total de voos no vetor.
+ * Compara dois voos pelo trigrama, desempatando pela posição na entrada (id).
+ * @param a Ponteiro para o primeiro voo.
+ * @param b Ponteiro para o segundo voo.
+ * @param trigrama String de três caracteres indicando a ordem dos critérios.
+ * @return Valor negativo se a < b, positivo se a > b (nunca 0 para voos distintos).
+ */
+int comparar_voos_id(const Flight *a, const Flight *b, const char *trigrama);
+
+/**
+ * Ordena ids de voos com base no critério do trigrama da consulta (introsort
+ * com partição em três vias; empates pelo id). Os comparadores leem os campos
+ * de `voos[id]`. Só as primeiras `max_resultados` posições saem garantidamente
+ * ordenadas.
+ * @param voos Vetor base de voos.
+ * @param ids Ids (posições em `voos`) a serem ordenados.
+ * @param total_voos Número de ids.
  * @param trigrama String de três caracteres indicando a ordem dos critérios.
  * @param max_resultados Número máximo de voos a serem retornados após a ordenação.
  */
-void ordenar_voos(Flight *voos, int total_voos, const char *trigrama, int max_resultados);
+void ordenar_voos(const Flight *voos, int *ids, int total_voos, const char *trigrama, int max_resultados);
 
 #endif // SORT_H
@@ -0,0 +1,104 @@
+#ifndef STANDING_H
+#define STANDING_H
+
+#include "flight.h"
+#include "query.h"
+#include "output.h"
+
+#define PERMANENTE_FOLGA 2            // Cada consulta guarda os FOLGA × max_voos melhores voos
+#define PERMANENTES_BALDES_INICIAIS 64  // Baldes iniciais da tabela de rotas (potência de 2)
+
+/**
+ * Consultas permanentes.
+ *
+ * Uma listagem registrada fica ativa e o seu resultado (os `max_voos`
+ * melhores voos na ordem do trigrama, empates pelo id) é mantido a cada voo
+ * alterado (atualizar_voo_permanentes), sem reexecutar a consulta: cada consulta
+ * guarda os seus PERMANENTE_FOLGA × max_voos melhores voos em ordem e o voo
+ * alterado é retirado e, se ainda atender aos predicados, reinserido por
+ * busca binária. Só quando as saídas esvaziam a folga abaixo de `max_voos`
+ * a consulta é reexecutada nos índices para recompor os melhores.
+ *
+ * As consultas com igualdade de origem (ou, na falta dela, de destino) ficam
+ * em baldes por aeroporto, então um voo alterado só é testado contra as
+ * consultas da sua origem, do seu destino e as sem aeroporto fixo, e não
+ * contra todas as registradas.
+ *
+ * Quando os `max_voos` primeiros mudam, a diferença é entregue ao dono da
+ * consulta, uma linha por voo:
+ *
+ *   - <id>                   o voo saiu do resultado
+ *   + <posição> <id> <voo>   o voo entrou (ou foi alterado) e ocupa a posição
+ *
+ * Aplicar as saídas e depois as entradas em ordem de posição reconstrói o
+ * resultado novo a partir do anterior. Um voo alterado que continua no
+ * resultado aparece como saída e entrada. O resultado inicial usa as mesmas
+ * linhas "+" (a diferença a partir do resultado vazio), já que a linha de um
+ * voo não traz o seu id.
+ *
+ * Todas as funções podem ser chamadas por várias threads; as alterações são
+ * processadas uma de cada vez, na ordem em que são aplicadas aos índices.
+ */
+typedef struct ConsultasPermanentes ConsultasPermanentes;
+
+/**
+ * Tipos de entrega ao dono de uma consulta.
+ */
+typedef enum {
+    ENTREGA_INICIAL,    // Resultado completo no registro: "watch <id>", a consulta e as linhas "+"
+    ENTREGA_DIFERENCA   // Linhas "-" e "+" de uma alteração
+} TipoEntrega;
+
+/**
+ * Entrega uma saída ao dono de uma consulta. É chamada com as consultas
+ * travadas, então não pode registrar, remover ou alterar voos, nem bloquear
+ * (ex: escrevendo num socket): deve só guardar a saída para o dono.
+ * @param dono Dono informado no registro.
+ * @param id Identificador da consulta.
+ * @param tipo Resultado inicial ou diferença.
+ * @param linhas Linhas em `saida`.
+ * @param saida Texto a entregar.
+ */
+typedef void (*EntregarPermanente)(void *dono, int id, TipoEntrega tipo, int linhas, const Saida *saida);
+
+/**
+ * Cria o conjunto de consultas permanentes de uma tabela.
+ * @param indices Índices da tabela (usados para recompor os melhores).
+ * @param voos Vetor de voos.
+ * @param n Quantidade de voos.
+ * @param entregar Função que entrega resultados e diferenças aos donos.
+ * @return Conjunto (liberar com liberar_permanentes).
+ */
+ConsultasPermanentes *criar_permanentes(IndicesVoos *indices, Flight *voos, int n, EntregarPermanente entregar);
+
+/**
+ * Libera o conjunto e todas as consultas registradas.
+ */
+void liberar_permanentes(ConsultasPermanentes *permanentes);
+
+/**
+ * Registra uma listagem (sem paginação) e entrega o resultado inicial ao dono
+ * antes de qualquer diferença.
+ * @return Identificador da consulta, ou -1 se ela não puder ser mantida
+ *         (agregação, itinerário, página ou expressão inválida).
+ */
+int registrar_permanente(ConsultasPermanentes *permanentes, const Query *consulta, void *dono);
+
+/**
+ * Remove uma consulta do dono.
+ * @return 1 se removida, 0 se não existe ou pertence a outro dono.
+ */
+int remover_permanente(ConsultasPermanentes *permanentes, int id, void *dono);
+
+/**
+ * Remove todas as consultas de um dono (ex: conexão encerrada).
+ */
+void remover_permanentes_do_dono(ConsultasPermanentes *permanentes, void *dono);
+
+/**
+ * Atualiza um voo (como atualizar_voo) e mantém as consultas afetadas.
+ * @return 1 se o voo foi atualizado, 0 se o id ou o campo forem inválidos.
+ */
+int atualizar_voo_permanentes(ConsultasPermanentes *permanentes, int id, const char *campo, const char *valor);
+
+#endif // STANDING_H
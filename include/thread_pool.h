@@ -0,0 +1,55 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+
+/**
+ * Tarefa enfileirada no pool.
+ */
+typedef struct TarefaPool {
+    void (*funcao)(void *);   // Função a executar
+    void *arg;                // Argumento repassado à função
+    struct TarefaPool *prox;  // Próxima tarefa da fila
+} TarefaPool;
+
+/**
+ * Pool de threads com fila FIFO de tarefas.
+ */
+typedef struct {
+    pthread_t *threads;       // Threads trabalhadoras
+    int num_threads;          // Quantidade de threads
+    TarefaPool *inicio;       // Primeira tarefa pendente
+    TarefaPool *fim;          // Última tarefa pendente
+    int pendentes;            // Tarefas enfileiradas ou em execução
+    int encerrar;             // Sinaliza o fim das threads
+    pthread_mutex_t trava;
+    pthread_cond_t tem_tarefa;
+    pthread_cond_t concluido;
+} ThreadPool;
+
+/**
+ * Número de processadores disponíveis (pelo menos 1).
+ */
+int processadores_disponiveis();
+
+/**
+ * Cria um pool com `num_threads` threads (mínimo 1).
+ */
+ThreadPool *criar_pool(int num_threads);
+
+/**
+ * Enfileira uma tarefa para execução.
+ */
+void submeter_tarefa(ThreadPool *pool, void (*funcao)(void *), void *arg);
+
+/**
+ * Bloqueia até que todas as tarefas submetidas tenham terminado.
+ */
+void aguardar_pool(ThreadPool *pool);
+
+/**
+ * Aguarda as tarefas pendentes, encerra as threads e libera o pool.
+ */
+void destruir_pool(ThreadPool *pool);
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,395 @@
+#include <stdint.h>
+#include "advisor.h"
+#include "capture.h"
+#include "itinerary.h"
+
+// Custo de um id lido de uma lista comprimida frente a uma lista simples.
+// Medido com as 2000 consultas de referência sobre 200 mil voos (avaliação
+// de 9,4 a 9,9 s com as listas comprimidas contra 7,9 a 8,4 s com as simples)
+#define CUSTO_ID_COMPRIMIDO 1.2
+
+#define AMOSTRA_MAX_LINHA 512  // Linhas maiores da amostra de texto são truncadas
+
+static const char *nomes_campos[NUM_CAMPOS_INDICE] = { "org", "dst", "prc", "sea", "dur", "sto" };
+static const char *nomes_representacoes[NUM_REPRESENTACOES] = { "nenhuma", "comprimida", "listas" };
+
+/**
+ * Uma consulta da amostra reduzida ao que o custo usa.
+ */
+typedef struct {
+    int itinerario;                         // Busca de itinerários (usa a rede de rotas)
+    int agregacao_simples;                  // Agregação de um único predicado
+    int num_folhas;
+    FaixaPredicado folhas[MAX_FOLHAS_EXPRESSAO];
+    long contagens[MAX_FOLHAS_EXPRESSAO];   // Voos que atendem a cada folha
+} ConsultaAmostra;
+
+/**
+ * Chave de um voo no campo, com a posição (ordenação das listas).
+ */
+typedef struct {
+    int64_t chave;
+    int id;
+} ParCampo;
+
+static void *alocar(size_t tamanho) {
+    void *p = malloc(tamanho ? tamanho : 1);
+    if (!p) {
+        fprintf(stderr, "Erro ao alocar memória para o plano de índices.\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+/**
+ * Acrescenta uma consulta ao vetor da amostra.
+ */
+static void anexar_consulta(Query **consultas, int *num, int *capacidade, const Query *consulta) {
+    if (*num == *capacidade) {
+        *capacidade = *capacidade ? *capacidade * 2 : 64;
+        *consultas = realloc(*consultas, *capacidade * sizeof(Query));
+        if (!*consultas) {
+            fprintf(stderr, "Erro ao alocar memória para a amostra de consultas.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    (*consultas)[(*num)++] = *consulta;
+}
+
+/**
+ * Lê a amostra de consultas (log de captura ou texto).
+ */
+int carregar_amostra_consultas(const char *caminho, Query **consultas) {
+    FILE *arquivo = fopen(caminho, "rb");
+    if (!arquivo) return -1;
+    char magica[4];
+    int captura = fread(magica, 1, sizeof(magica), arquivo) == sizeof(magica) &&
+                  memcmp(magica, CAPTURA_MAGICA, sizeof(magica)) == 0;
+    int num = 0, capacidade = 0;
+    *consultas = NULL;
+
+    if (captura) {
+        fclose(arquivo);
+        arquivo = abrir_captura_leitura(caminho);
+        if (!arquivo) return -1;
+        RegistroConsulta registro;
+        while (ler_registro_consulta(arquivo, &registro)) {
+            anexar_consulta(consultas, &num, &capacidade, &registro.consulta);
+        }
+    } else {
+        rewind(arquivo);
+        char linha[AMOSTRA_MAX_LINHA];
+        Query consulta;
+        while (fgets(linha, sizeof(linha), arquivo)) {
+            if (interpretar_consulta(linha, &consulta)) anexar_consulta(consultas, &num, &capacidade, &consulta);
+        }
+    }
+    fclose(arquivo);
+    return num;
+}
+
+static int comparar_pares_campo(const void *a, const void *b) {
+    const ParCampo *x = a, *y = b;
+    if (x->chave != y->chave) return (x->chave > y->chave) - (x->chave < y->chave);
+    return (x->id > y->id) - (x->id < y->id);
+}
+
+/**
+ * Primeira posição com chave maior ou igual a `chave` (maior que, com `estrita`).
+ */
+static int limite_chave(const ParCampo *pares, int n, int64_t chave, int estrita) {
+    int ini = 0, fim = n;
+    while (ini < fim) {
+        int meio = ini + (fim - ini) / 2;
+        if (pares[meio].chave < chave || (estrita && pares[meio].chave == chave)) ini = meio + 1;
+        else fim = meio;
+    }
+    return ini;
+}
+
+/**
+ * Reduz as consultas da amostra às suas folhas (consultas inválidas ficam de fora).
+ * @return Quantidade de consultas reduzidas.
+ */
+static int reduzir_amostra(const Query *amostra, int num_amostra, ConsultaAmostra *reduzidas) {
+    int num = 0;
+    for (int i = 0; i < num_amostra; i++) {
+        ConsultaAmostra *q = &reduzidas[num];
+        memset(q, 0, sizeof(*q));
+        if (amostra[i].agregacao == CONSULTA_ITINERARIO) {
+            q->itinerario = 1;
+            num++;
+            continue;
+        }
+        ExprNode *expressao = parse_expressao(amostra[i].expressao);
+        if (!expressao) continue;
+        q->num_folhas = converter_folhas_expressao(expressao, q->folhas, MAX_FOLHAS_EXPRESSAO);
+        q->agregacao_simples = amostra[i].agregacao != AGREGACAO_NENHUMA && expressao->operator != OP_AND;
+        liberar_expressao(expressao);
+        if (q->num_folhas > 0) num++;
+    }
+    return num;
+}
+
+/**
+ * Amostra sintética: uma igualdade sobre a chave mediana de cada campo
+ * (preenchida em medir_campo) e uma busca de itinerários.
+ * @return Quantidade de consultas.
+ */
+static int amostra_sintetica(ConsultaAmostra *reduzidas) {
+    memset(reduzidas, 0, (NUM_CAMPOS_INDICE + 1) * sizeof(ConsultaAmostra));
+    for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+        reduzidas[f].num_folhas = 1;
+        reduzidas[f].folhas[0].campo = f;
+        reduzidas[f].folhas[0].min = 1;
+        reduzidas[f].folhas[0].max = 0;  // Vazio até medir_campo escolher a mediana
+    }
+    reduzidas[NUM_CAMPOS_INDICE].itinerario = 1;
+    return NUM_CAMPOS_INDICE + 1;
+}
+
+/**
+ * Mede um campo: memória das representações e contagem das folhas da
+ * amostra sobre ele, a partir dos pares (chave, posição) ordenados.
+ */
+static void medir_campo(const Flight *voos, int n, CampoIndice campo, ConsultaAmostra *reduzidas, int num,
+                        int sintetica, PlanoIndices *plano, ParCampo *pares, int *ids) {
+    for (int i = 0; i < n; i++) {
+        pares[i].chave = chave_voo(&voos[i], campo);
+        pares[i].id = i;
+    }
+    qsort(pares, n, sizeof(ParCampo), comparar_pares_campo);
+
+    // Um nó por chave distinta; as listas comprimidas seguem a regra de comprimir_avl
+    size_t nos = 0, simples = 0, comprimidas = 0;
+    for (int i = 0; i < n;) {
+        int j = i;
+        while (j < n && pares[j].chave == pares[i].chave) {
+            ids[j - i] = pares[j].id;
+            j++;
+        }
+        size_t bytes = (size_t)(j - i) * sizeof(int);
+        nos++;
+        simples += bytes;
+        if (j - i >= POSTINGS_MIN_COMPRIMIR) {
+            size_t estimados = estimar_memoria_postings(ids, j - i);
+            if (estimados < bytes) bytes = estimados;
+        }
+        comprimidas += bytes;
+        i = j;
+    }
+    plano->memoria[campo][REPRESENTACAO_NENHUMA] = 0;
+    plano->memoria[campo][REPRESENTACAO_COMPRIMIDA] = nos * sizeof(AVLNode) + comprimidas;
+    plano->memoria[campo][REPRESENTACAO_LISTAS] = nos * sizeof(AVLNode) + simples;
+
+    if (sintetica && n > 0) {
+        reduzidas[campo].folhas[0].min = reduzidas[campo].folhas[0].max = pares[n / 2].chave;
+    }
+    for (int q = 0; q < num; q++) {
+        for (int f = 0; f < reduzidas[q].num_folhas; f++) {
+            const FaixaPredicado *folha = &reduzidas[q].folhas[f];
+            if (folha->campo != (int)campo) continue;
+            reduzidas[q].contagens[f] = folha->min > folha->max ? 0
+                : limite_chave(pares, n, folha->max, 1) - limite_chave(pares, n, folha->min, 0);
+        }
+    }
+}
+
+/**
+ * Memória da rede de rotas (a mesma alocação de construir_rede_rotas).
+ */
+static size_t medir_rede(const Flight *voos, int n, ParCampo *pares) {
+    int m = 0;
+    for (int i = 0; i < n; i++) {
+        if (voos[i].chegada < voos[i].partida || voos[i].preco < 0 || voos[i].paradas < 0) continue;
+        pares[m].chave = chave_aeroporto(voos[i].origem);
+        pares[m].id = i;
+        m++;
+    }
+    qsort(pares, m, sizeof(ParCampo), comparar_pares_campo);
+    int aeroportos = 0;
+    for (int i = 0; i < m; i++) {
+        if (i == 0 || pares[i].chave != pares[i - 1].chave) aeroportos++;
+    }
+    return sizeof(RedeRotas) + aeroportos * sizeof(int64_t) + (aeroportos + 1) * sizeof(int) +
+           (size_t)m * (sizeof(int) + sizeof(time_t));
+}
+
+/**
+ * Custo estimado de uma consulta com as estruturas dadas, em ids lidos.
+ */
+static double custo_consulta(const ConsultaAmostra *q, const RepresentacaoIndice representacao[], int rede, int n) {
+    if (q->itinerario) return rede ? 0 : n;
+
+    int campo_unico = q->folhas[0].campo;
+    if (q->agregacao_simples && campo_unico != CAMPO_PARTIDA && representacao[campo_unico] != REPRESENTACAO_NENHUMA) {
+        return 0;
+    }
+
+    double custo = 0;
+    long menor = -1;
+    int residuais = 0;
+    for (int f = 0; f < q->num_folhas; f++) {
+        int campo = q->folhas[f].campo;
+        if (campo == CAMPO_PARTIDA || representacao[campo] == REPRESENTACAO_NENHUMA) {
+            residuais++;
+            continue;
+        }
+        if (q->contagens[f] == 0) return 0;
+        custo += q->contagens[f] * (representacao[campo] == REPRESENTACAO_COMPRIMIDA ? CUSTO_ID_COMPRIMIDO : 1.0);
+        if (menor < 0 || q->contagens[f] < menor) menor = q->contagens[f];
+    }
+    // Sem folhas indexadas todos os voos são lidos; com folhas residuais, os candidatos são relidos
+    if (menor < 0) return n;
+    return custo + (residuais ? menor : 0);
+}
+
+static double custo_amostra(const ConsultaAmostra *reduzidas, int num, const RepresentacaoIndice representacao[],
+                            int rede, int n) {
+    double total = 0;
+    for (int q = 0; q < num; q++) total += custo_consulta(&reduzidas[q], representacao, rede, n);
+    return total;
+}
+
+static size_t memoria_plano(const PlanoIndices *plano) {
+    size_t total = plano->rede_rotas ? plano->memoria_rede : 0;
+    for (int f = 0; f < NUM_CAMPOS_INDICE; f++) total += plano->memoria[f][plano->representacao[f]];
+    return total;
+}
+
+/**
+ * Calcula a memória das estruturas e escolhe, gulosamente pela redução de
+ * custo por byte, as que cabem no orçamento.
+ */
+void planejar_indices(const Flight *voos, int n, const Query *amostra, int num_amostra, size_t orcamento,
+                      PlanoIndices *plano) {
+    memset(plano, 0, sizeof(*plano));
+    plano->orcamento = orcamento;
+
+    int sintetica = !amostra || num_amostra <= 0;
+    ConsultaAmostra *reduzidas = alocar((sintetica ? NUM_CAMPOS_INDICE + 1 : num_amostra) * sizeof(ConsultaAmostra));
+    int num = sintetica ? amostra_sintetica(reduzidas) : reduzir_amostra(amostra, num_amostra, reduzidas);
+    plano->num_consultas = sintetica ? 0 : num;
+
+    ParCampo *pares = alocar((size_t)n * sizeof(ParCampo));
+    int *ids = alocar((size_t)n * sizeof(int));
+    for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+        medir_campo(voos, n, (CampoIndice)f, reduzidas, num, sintetica, plano, pares, ids);
+    }
+    plano->memoria_rede = medir_rede(voos, n, pares);
+    free(pares);
+    free(ids);
+
+    // Custos de referência: nenhuma estrutura e todas as estruturas (listas simples e rede)
+    RepresentacaoIndice todas[NUM_CAMPOS_INDICE];
+    for (int f = 0; f < NUM_CAMPOS_INDICE; f++) todas[f] = REPRESENTACAO_LISTAS;
+    plano->custo_sem_indices = custo_amostra(reduzidas, num, plano->representacao, 0, n);
+    plano->custo_completo = custo_amostra(reduzidas, num, todas, 1, n);
+
+    // Escolha gulosa: a cada passo, a maior redução de custo por byte que cabe no orçamento
+    double atual = plano->custo_sem_indices;
+    while (1) {
+        size_t usado = memoria_plano(plano);
+        double melhor_razao = 0, melhor_custo = atual;
+        int melhor_campo = -1, melhor_representacao = 0;
+
+        for (int f = 0; f <= NUM_CAMPOS_INDICE; f++) {
+            int rede = f == NUM_CAMPOS_INDICE;
+            if (rede && plano->rede_rotas) continue;
+            int primeira = rede ? 0 : plano->representacao[f] + 1;
+            int ultima = rede ? 0 : REPRESENTACAO_LISTAS;
+            for (int r = primeira; r <= ultima; r++) {
+                size_t extra = rede ? plano->memoria_rede
+                                    : plano->memoria[f][r] - plano->memoria[f][plano->representacao[f]];
+                if (usado + extra > orcamento || usado + extra < usado) continue;
+
+                RepresentacaoIndice tentativa[NUM_CAMPOS_INDICE];
+                memcpy(tentativa, plano->representacao, sizeof(tentativa));
+                if (!rede) tentativa[f] = (RepresentacaoIndice)r;
+                double custo = custo_amostra(reduzidas, num, tentativa, plano->rede_rotas || rede, n);
+                double razao = (atual - custo) / (double)(extra ? extra : 1);
+                if (custo < atual && razao > melhor_razao) {
+                    melhor_razao = razao;
+                    melhor_custo = custo;
+                    melhor_campo = f;
+                    melhor_representacao = r;
+                }
+            }
+        }
+        if (melhor_campo < 0) break;
+        if (melhor_campo == NUM_CAMPOS_INDICE) plano->rede_rotas = 1;
+        else plano->representacao[melhor_campo] = (RepresentacaoIndice)melhor_representacao;
+        atual = melhor_custo;
+    }
+    plano->custo_plano = atual;
+
+    // Benefício de cada estrutura escolhida: quanto o custo sobe sem ela
+    for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+        if (plano->representacao[f] == REPRESENTACAO_NENHUMA) continue;
+        RepresentacaoIndice sem[NUM_CAMPOS_INDICE];
+        memcpy(sem, plano->representacao, sizeof(sem));
+        sem[f] = REPRESENTACAO_NENHUMA;
+        plano->beneficio[f] = custo_amostra(reduzidas, num, sem, plano->rede_rotas, n) - atual;
+    }
+    if (plano->rede_rotas) {
+        plano->beneficio_rede = custo_amostra(reduzidas, num, plano->representacao, 0, n) - atual;
+    }
+    free(reduzidas);
+}
+
+/**
+ * Constrói as estruturas do plano.
+ */
+void construir_indices_plano(IndicesVoos *indices, Flight *voos, int n, const PlanoIndices *plano) {
+    for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+        indices->arvores[f]->ausente = plano->representacao[f] == REPRESENTACAO_NENHUMA;
+    }
+    construir_arvores_indices(indices->arvores, voos, n);
+    for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+        if (plano->representacao[f] == REPRESENTACAO_COMPRIMIDA) comprimir_avl(indices->arvores[f]->raiz);
+    }
+    if (plano->rede_rotas) indices->rotas = construir_rede_rotas(voos, n);
+}
+
+static double mib(size_t bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+/**
+ * Relata o plano de índices.
+ */
+void relatar_plano_indices(FILE *arquivo, const PlanoIndices *plano, const IndicesVoos *indices) {
+    if (plano->orcamento == SIZE_MAX) {
+        fprintf(arquivo, "Plano de índices (sem orçamento de memória; ");
+    } else {
+        fprintf(arquivo, "Plano de índices (orçamento de %.2f MiB; ", mib(plano->orcamento));
+    }
+    if (plano->num_consultas > 0) fprintf(arquivo, "amostra de %d consultas):\n", plano->num_consultas);
+    else fprintf(arquivo, "amostra sintética: uma igualdade por campo e uma busca de itinerários):\n");
+
+    // Larguras em bytes: "í", "ç", "ã" e "ó" ocupam dois
+    fprintf(arquivo, "%-8s %-15s %12s %12s %13s %16s\n", "índice", "representação", "memória MiB", "simples MiB",
+            "construída", "custo evitado");
+    for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+        RepresentacaoIndice r = plano->representacao[f];
+        char construida[32] = "-";
+        if (indices && r != REPRESENTACAO_NENHUMA) {
+            snprintf(construida, sizeof(construida), "%.2f", mib(memoria_avl(indices->arvores[f]->raiz)));
+        }
+        fprintf(arquivo, "%-7s %-13s %12.2f %12.2f %12s %16.0f\n", nomes_campos[f], nomes_representacoes[r],
+                mib(plano->memoria[f][r]), mib(plano->memoria[f][REPRESENTACAO_LISTAS]), construida,
+                plano->beneficio[f]);
+    }
+    char construida[32] = "-";
+    if (indices && indices->rotas) snprintf(construida, sizeof(construida), "%.2f", mib(plano->memoria_rede));
+    fprintf(arquivo, "%-7s %-13s %12.2f %12.2f %12s %16.0f\n", "rotas", plano->rede_rotas ? "rede" : "nenhuma",
+            plano->rede_rotas ? mib(plano->memoria_rede) : 0.0, mib(plano->memoria_rede), construida,
+            plano->beneficio_rede);
+
+    size_t completo = plano->memoria_rede;
+    for (int f = 0; f < NUM_CAMPOS_INDICE; f++) completo += plano->memoria[f][REPRESENTACAO_LISTAS];
+    fprintf(arquivo, "Memória do plano: %.2f MiB (todas as estruturas: %.2f MiB)\n", mib(memoria_plano(plano)),
+            mib(completo));
+    fprintf(arquivo, "Custo estimado da amostra (ids lidos): %.0f sem índices, %.0f com todos, %.0f com o plano\n",
+            plano->custo_sem_indices, plano->custo_completo, plano->custo_plano);
+}
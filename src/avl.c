@@ -1,5 +1,9 @@
 #include <stdbool.h>  // Para o uso de bool
+#include <ctype.h>
+#include <math.h>
 #include "avl.h"
+#include "epoch.h"
+#include "deadline.h"
 
 // Cria uma nova árvore AVL
 AVLTree *criar_avl() {
@@ -9,6 +13,7 @@ AVLTree *criar_avl() {
         exit(EXIT_FAILURE);
     }
     tree->raiz = NULL;
+    tree->ausente = 0;
     return tree;
 }
 
@@ -31,6 +36,56 @@ int get_balanceamento(AVLNode *n) {
     return altura(n->esq) - altura(n->dir);
 }
 
+// Agregados vazios do próprio nó (sem voos)
+static void limpar_agregados_no(AVLNode *n) {
+    n->soma_preco_no = 0.0;
+    n->min_preco_no = FLT_MAX;
+    n->max_preco_no = -FLT_MAX;
+}
+
+// Recalcula os agregados da subárvore a partir do nó e dos filhos
+static void atualizar_agregados(AVLNode *n) {
+    if (n == NULL) return;
+    n->total_sub = n->num_indices;
+    n->chave_min_sub = n->chave_max_sub = n->chave_num;
+    n->soma_preco_sub = n->soma_preco_no;
+    n->min_preco_sub = n->min_preco_no;
+    n->max_preco_sub = n->max_preco_no;
+
+    AVLNode *filhos[2] = { n->esq, n->dir };
+    for (int i = 0; i < 2; i++) {
+        AVLNode *f = filhos[i];
+        if (!f) continue;
+        n->total_sub += f->total_sub;
+        if (f->chave_min_sub < n->chave_min_sub) n->chave_min_sub = f->chave_min_sub;
+        if (f->chave_max_sub > n->chave_max_sub) n->chave_max_sub = f->chave_max_sub;
+        n->soma_preco_sub += f->soma_preco_sub;
+        if (f->min_preco_sub < n->min_preco_sub) n->min_preco_sub = f->min_preco_sub;
+        if (f->max_preco_sub > n->max_preco_sub) n->max_preco_sub = f->max_preco_sub;
+    }
+}
+
+// Recalcula os agregados de preço do próprio nó percorrendo a sua lista
+static void recalcular_precos_no(AVLNode *n, const Flight *voos) {
+    limpar_agregados_no(n);
+    int buffer[POSTINGS_BLOCO];
+    int num_blocos = n->postings ? n->postings->num_blocos : 1;
+    for (int b = 0; b < num_blocos; b++) {
+        const int *ids = n->indices;
+        int qtd = n->num_indices;
+        if (n->postings) {
+            qtd = decodificar_bloco_postings(n->postings, b, buffer);
+            ids = buffer;
+        }
+        for (int i = 0; i < qtd; i++) {
+            float preco = voos[ids[i]].preco;
+            n->soma_preco_no += preco;
+            if (preco < n->min_preco_no) n->min_preco_no = preco;
+            if (preco > n->max_preco_no) n->max_preco_no = preco;
+        }
+    }
+}
+
 // Realiza rotação simples à direita
 AVLNode *rotacao_direita(AVLNode *y) {
     AVLNode *x = y->esq;
@@ -41,6 +96,8 @@ AVLNode *rotacao_direita(AVLNode *y) {
 
     atualizar_altura(y);
     atualizar_altura(x);
+    atualizar_agregados(y);
+    atualizar_agregados(x);
 
     return x;
 }
@@ -55,22 +112,20 @@ AVLNode *rotacao_esquerda(AVLNode *x) {
 
     atualizar_altura(x);
     atualizar_altura(y);
+    atualizar_agregados(x);
+    atualizar_agregados(y);
 
     return y;
 }
 
+
 // Insere um novo nó na AVL e retorna a nova raiz
 // Insere um novo nó na AVL e adiciona os índices sem sobrescrever
 AVLNode *inserir_avl(AVLNode *raiz, const char *chave, int indice) {
     if (!raiz) {
-        AVLNode *novo = malloc(sizeof(AVLNode));
-        strcpy(novo->chave, chave);
-        novo->indices = malloc(sizeof(int));
-        novo->indices[0] = indice;
-        novo->num_indices = 1;
-        novo->altura = 1;
-        novo->esq = novo->dir = NULL;
-        return novo;
+        int *indices = malloc(sizeof(int));
+        indices[0] = indice;
+        return criar_no_avl(chave, indices, 1);
     }
 
     if (strcmp(chave, raiz->chave) < 0) {
@@ -78,6 +133,13 @@ AVLNode *inserir_avl(AVLNode *raiz, const char *chave, int indice) {
     } else if (strcmp(chave, raiz->chave) > 0) {
         raiz->dir = inserir_avl(raiz->dir, chave, indice);
     } else {
+        // Lista comprimida: volta ao vetor simples antes de acrescentar
+        if (raiz->postings) {
+            raiz->indices = malloc(raiz->num_indices * sizeof(int));
+            descomprimir_postings(raiz->postings, raiz->indices);
+            liberar_postings(raiz->postings);
+            raiz->postings = NULL;
+        }
         // ✅ Apenas adicionamos o índice, sem sobrescrever
         int new_size = raiz->num_indices + 1;
         raiz->indices = realloc(raiz->indices, new_size * sizeof(int));
@@ -103,6 +165,362 @@ AVLNode *inserir_avl(AVLNode *raiz, const char *chave, int indice) {
 }
 
 
+static void liberar_postings_aposentados(void *lista) {
+    liberar_postings(lista);
+}
+
+/**
+ * Copia um nó para a nova versão e aposenta o original. A cópia compartilha a
+ * lista de índices e os filhos com o original.
+ */
+static AVLNode *copiar_no_cow(AVLNode *no) {
+    AVLNode *copia = malloc(sizeof(AVLNode));
+    if (!copia) {
+        fprintf(stderr, "Erro ao alocar memória para AVL.\n");
+        exit(EXIT_FAILURE);
+    }
+    *copia = *no;
+    aposentar(no, free);
+    return copia;
+}
+
+/**
+ * Substitui a lista de índices de um nó já copiado, aposentando a anterior.
+ */
+static void trocar_indices_cow(AVLNode *no, int *indices, int n) {
+    if (no->postings) aposentar(no->postings, liberar_postings_aposentados);
+    else aposentar(no->indices, free);
+    no->indices = indices;
+    no->postings = NULL;
+    no->num_indices = n;
+}
+
+/**
+ * Insere um índice na lista de um nó mantendo a ordem crescente (nova lista).
+ */
+static void adicionar_indice_cow(AVLNode *no, int indice, const Flight *voos) {
+    int *indices = malloc((no->num_indices + 1) * sizeof(int));
+    if (!indices) {
+        fprintf(stderr, "Erro ao alocar memória para AVL.\n");
+        exit(EXIT_FAILURE);
+    }
+    int n = extrair_indices_no(no, indices);
+    int pos = n;
+    while (pos > 0 && indices[pos - 1] > indice) pos--;
+    if (pos > 0 && indices[pos - 1] == indice) {
+        free(indices);
+        return;
+    }
+    memmove(indices + pos + 1, indices + pos, (n - pos) * sizeof(int));
+    indices[pos] = indice;
+    trocar_indices_cow(no, indices, n + 1);
+
+    float preco = voos[indice].preco;
+    no->soma_preco_no += preco;
+    if (preco < no->min_preco_no) no->min_preco_no = preco;
+    if (preco > no->max_preco_no) no->max_preco_no = preco;
+}
+
+/**
+ * Insere um índice copiando o caminho até a chave (copy-on-write).
+ */
+AVLNode *inserir_avl_cow(AVLNode *raiz, const char *chave, int indice, const Flight *voos) {
+    if (!raiz) {
+        int *indices = malloc(sizeof(int));
+        if (!indices) {
+            fprintf(stderr, "Erro ao alocar memória para AVL.\n");
+            exit(EXIT_FAILURE);
+        }
+        indices[0] = indice;
+        AVLNode *novo = criar_no_avl(chave, indices, 1);
+        recalcular_precos_no(novo, voos);
+        atualizar_agregados(novo);
+        return novo;
+    }
+
+    // Só nós do caminho são copiados; as rotações abaixo tocam apenas esses nós
+    AVLNode *no = copiar_no_cow(raiz);
+    int cmp = strcmp(chave, no->chave);
+    if (cmp < 0) {
+        no->esq = inserir_avl_cow(no->esq, chave, indice, voos);
+    } else if (cmp > 0) {
+        no->dir = inserir_avl_cow(no->dir, chave, indice, voos);
+    } else {
+        adicionar_indice_cow(no, indice, voos);
+        atualizar_agregados(no);
+        return no;
+    }
+
+    atualizar_altura(no);
+    atualizar_agregados(no);
+    int balance = get_balanceamento(no);
+
+    if (balance > 1 && strcmp(chave, no->esq->chave) < 0) return rotacao_direita(no);
+    if (balance < -1 && strcmp(chave, no->dir->chave) > 0) return rotacao_esquerda(no);
+    if (balance > 1 && strcmp(chave, no->esq->chave) > 0) {
+        no->esq = rotacao_esquerda(no->esq);
+        return rotacao_direita(no);
+    }
+    if (balance < -1 && strcmp(chave, no->dir->chave) < 0) {
+        no->dir = rotacao_direita(no->dir);
+        return rotacao_esquerda(no);
+    }
+
+    return no;
+}
+
+/**
+ * Verifica se um nó contém o índice.
+ */
+static int contem_indice(const AVLNode *no, int indice) {
+    if (no->postings) {
+        int destino;
+        return intersectar_postings(&indice, 1, no->postings, &destino) == 1;
+    }
+    int ini = 0, fim = no->num_indices - 1;
+    while (ini <= fim) {
+        int meio = ini + (fim - ini) / 2;
+        if (no->indices[meio] == indice) return 1;
+        if (no->indices[meio] < indice) ini = meio + 1;
+        else fim = meio - 1;
+    }
+    return 0;
+}
+
+/**
+ * Alteração aplicada ao nó de destino de uma cópia de caminho.
+ */
+typedef struct {
+    int indice;
+    float preco_antigo;
+    float preco_novo;
+    const Flight *voos;
+} AlteracaoNo;
+
+/**
+ * Copia o caminho até a chave (que deve existir), aplica `alterar` no nó da
+ * chave e recalcula os agregados dos nós copiados. Não há rotações.
+ */
+static AVLNode *copiar_caminho_cow(AVLNode *raiz, const char *chave,
+                                   void (*alterar)(AVLNode *, const AlteracaoNo *),
+                                   const AlteracaoNo *alteracao) {
+    AVLNode *no = copiar_no_cow(raiz);
+    int cmp = strcmp(chave, no->chave);
+    if (cmp < 0) {
+        no->esq = copiar_caminho_cow(no->esq, chave, alterar, alteracao);
+    } else if (cmp > 0) {
+        no->dir = copiar_caminho_cow(no->dir, chave, alterar, alteracao);
+    } else {
+        alterar(no, alteracao);
+    }
+    atualizar_agregados(no);
+    return no;
+}
+
+static void retirar_indice(AVLNode *no, const AlteracaoNo *alteracao) {
+    int *indices = malloc((no->num_indices ? no->num_indices : 1) * sizeof(int));
+    if (!indices) {
+        fprintf(stderr, "Erro ao alocar memória para AVL.\n");
+        exit(EXIT_FAILURE);
+    }
+    int n = extrair_indices_no(no, indices), m = 0;
+    for (int i = 0; i < n; i++) {
+        if (indices[i] != alteracao->indice) indices[m++] = indices[i];
+    }
+    trocar_indices_cow(no, indices, m);
+
+    // Retirar o mínimo ou o máximo exige percorrer a lista restante
+    float preco = alteracao->preco_antigo;
+    if (preco <= no->min_preco_no || preco >= no->max_preco_no) {
+        recalcular_precos_no(no, alteracao->voos);
+    } else {
+        no->soma_preco_no -= preco;
+    }
+}
+
+static void trocar_preco(AVLNode *no, const AlteracaoNo *alteracao) {
+    float antigo = alteracao->preco_antigo, novo = alteracao->preco_novo;
+    if ((antigo <= no->min_preco_no && novo > antigo) || (antigo >= no->max_preco_no && novo < antigo)) {
+        recalcular_precos_no(no, alteracao->voos);
+        return;
+    }
+    no->soma_preco_no += (double)novo - antigo;
+    if (novo < no->min_preco_no) no->min_preco_no = novo;
+    if (novo > no->max_preco_no) no->max_preco_no = novo;
+}
+
+/**
+ * Remove um índice da lista de uma chave copiando o caminho (copy-on-write).
+ */
+AVLNode *remover_indice_avl_cow(AVLNode *raiz, const char *chave, int indice, float preco, const Flight *voos) {
+    AVLNode *no = buscar_avl(raiz, chave);
+    if (!no || !contem_indice(no, indice)) return raiz;
+    AlteracaoNo alteracao = { indice, preco, preco, voos };
+    return copiar_caminho_cow(raiz, chave, retirar_indice, &alteracao);
+}
+
+/**
+ * Atualiza os agregados de preço do nó da chave (copy-on-write).
+ */
+AVLNode *atualizar_preco_avl_cow(AVLNode *raiz, const char *chave, float preco_antigo, float preco_novo,
+                                 const Flight *voos) {
+    if (!buscar_avl(raiz, chave)) return raiz;
+    AlteracaoNo alteracao = { -1, preco_antigo, preco_novo, voos };
+    return copiar_caminho_cow(raiz, chave, trocar_preco, &alteracao);
+}
+
+/**
+ * Calcula os agregados de todos os nós da árvore (pós-ordem).
+ */
+void calcular_agregados_avl(AVLNode *raiz, const Flight *voos) {
+    if (!raiz) return;
+    calcular_agregados_avl(raiz->esq, voos);
+    calcular_agregados_avl(raiz->dir, voos);
+    recalcular_precos_no(raiz, voos);
+    atualizar_agregados(raiz);
+}
+
+/**
+ * Acrescenta um preço a um agregado.
+ */
+void acumular_preco(AgregadoPreco *agregado, float preco) {
+    agregado->quantidade++;
+    agregado->soma += preco;
+    if (preco < agregado->minimo) agregado->minimo = preco;
+    if (preco > agregado->maximo) agregado->maximo = preco;
+}
+
+/**
+ * Combina dois agregados.
+ */
+void combinar_agregados(AgregadoPreco *destino, const AgregadoPreco *origem) {
+    if (origem->quantidade == 0) return;
+    destino->quantidade += origem->quantidade;
+    destino->soma += origem->soma;
+    if (origem->minimo < destino->minimo) destino->minimo = origem->minimo;
+    if (origem->maximo > destino->maximo) destino->maximo = origem->maximo;
+}
+
+static void somar_no(AgregadoPreco *agregado, const AVLNode *no) {
+    if (no->num_indices == 0) return;
+    AgregadoPreco parcial = { no->num_indices, no->soma_preco_no, no->min_preco_no, no->max_preco_no };
+    combinar_agregados(agregado, &parcial);
+}
+
+static void somar_subarvore(AgregadoPreco *agregado, const AVLNode *no) {
+    if (no->total_sub == 0) return;
+    AgregadoPreco parcial = { no->total_sub, no->soma_preco_sub, no->min_preco_sub, no->max_preco_sub };
+    combinar_agregados(agregado, &parcial);
+}
+
+/**
+ * Busca o nó de chave numérica `chave` pela chave textual canônica do campo
+ * (mesmo formato de formatar_chave_indice), em O(log n).
+ */
+static AVLNode *buscar_chave_exata(AVLNode *raiz, int campo, int64_t chave) {
+    char texto[32];
+    if (campo == CAMPO_ORIGEM || campo == CAMPO_DESTINO) {
+        int n = 0;
+        for (int desloc = 16; desloc >= 0; desloc -= 8) {
+            char c = (char)((chave >> desloc) & 0xFF);
+            if (c) texto[n++] = c;
+        }
+        texto[n] = '\0';
+    } else if (campo == CAMPO_PRECO) {
+        snprintf(texto, sizeof(texto), "%.2f", chave / 100.0);
+    } else {
+        snprintf(texto, sizeof(texto), "%lld", (long long)chave);
+    }
+    AVLNode *no = buscar_avl(raiz, texto);
+    return no && no->chave_num == chave ? no : NULL;
+}
+
+/**
+ * Agrega uma subárvore: se o intervalo de chaves dela está inteiro dentro do
+ * predicado, ela entra em O(1); se está inteiro fora, é pulada.
+ */
+static void agregar_subarvore(const AVLNode *no, const FaixaPredicado *p, AgregadoPreco *agregado) {
+    if (!no || no->chave_max_sub < p->min || no->chave_min_sub > p->max || prazo_esgotado()) return;
+    if (no->chave_min_sub >= p->min && no->chave_max_sub <= p->max) {
+        somar_subarvore(agregado, no);
+        return;
+    }
+
+    if (no->chave_num >= p->min && no->chave_num <= p->max) somar_no(agregado, no);
+    agregar_subarvore(no->esq, p, agregado);
+    agregar_subarvore(no->dir, p, agregado);
+}
+
+/**
+ * Agrega os preços dos voos que satisfazem um predicado sobre um índice.
+ */
+void agregar_indice_avl(AVLTree *indice, const FaixaPredicado *predicado, AgregadoPreco *agregado) {
+    AgregadoPreco vazio = AGREGADO_PRECO_VAZIO;
+    *agregado = vazio;
+    if (!indice || predicado->min > predicado->max) return;
+
+    AVLNode *raiz = indice->raiz;
+    if (!raiz) return;
+
+    if (predicado->min == predicado->max) {
+        AVLNode *no = buscar_chave_exata(raiz, predicado->campo, predicado->min);
+        if (no) somar_no(agregado, no);
+    } else {
+        agregar_subarvore(raiz, predicado, agregado);
+    }
+}
+
+/**
+ * Chave numérica de uma chave textual do índice: aeroportos empacotados,
+ * preços (centavos escritos como "reais.cc" por formatar_chave_indice) lidos
+ * de volta exatamente, sem passar por ponto flutuante, e os demais campos
+ * como inteiros.
+ */
+static int64_t chave_numerica(const char *chave) {
+    if (isalpha((unsigned char)chave[0])) return chave_aeroporto(chave);
+    char *ponto;
+    int64_t inteiro = strtoll(chave, &ponto, 10);
+    if (*ponto != '.') return inteiro;
+    int64_t centavos = strtoll(ponto + 1, NULL, 10);
+    return chave[0] == '-' ? inteiro * 100 - centavos : inteiro * 100 + centavos;
+}
+
+/**
+ * Cria um nó de índice com a chave e a lista de índices informadas (assume a posse do vetor).
+ */
+AVLNode *criar_no_avl(const char *chave, int *indices, int n) {
+    AVLNode *no = malloc(sizeof(AVLNode));
+    if (!no) {
+        fprintf(stderr, "Erro ao alocar memória para AVL.\n");
+        exit(EXIT_FAILURE);
+    }
+    strncpy(no->chave, chave, sizeof(no->chave) - 1);
+    no->chave[sizeof(no->chave) - 1] = '\0';
+    no->chave_num = chave_numerica(no->chave);
+    no->indices = indices;
+    no->postings = NULL;
+    no->num_indices = n;
+    no->altura = 1;
+    no->esq = no->dir = NULL;
+    limpar_agregados_no(no);
+    atualizar_agregados(no);
+    return no;
+}
+
+/**
+ * Monta uma AVL perfeitamente balanceada a partir de nós em ordem crescente de chave.
+ */
+AVLNode *construir_avl_balanceada(AVLNode **nos, int inicio, int fim) {
+    if (inicio > fim) return NULL;
+
+    int meio = inicio + (fim - inicio) / 2;
+    AVLNode *raiz = nos[meio];
+    raiz->esq = construir_avl_balanceada(nos, inicio, meio - 1);
+    raiz->dir = construir_avl_balanceada(nos, meio + 1, fim);
+    atualizar_altura(raiz);
+    return raiz;
+}
+
 // Busca na AVL pelo valor especificado e retorna o nó correspondente
 AVLNode *buscar_avl(AVLNode *raiz, const char *chave) {
     if (raiz == NULL || strcmp(raiz->chave, chave) == 0)
@@ -120,6 +538,7 @@ void liberar_avl(AVLNode *raiz) {
         liberar_avl(raiz->esq);
         liberar_avl(raiz->dir);
         free(raiz->indices);
+        liberar_postings(raiz->postings);
         free(raiz);
     }
 }
@@ -137,86 +556,240 @@ void imprimir_resultado_busca(const char *campo, const char *valor, OperatorType
     if (!resultado) {
         printf("   ⚠️ Nenhum resultado encontrado\n");
     } else {
+        int *indices = malloc(resultado->num_indices * sizeof(int));
+        extrair_indices_no(resultado, indices);
         printf("   📌 Índices encontrados: ");
         for (int i = 0; i < resultado->num_indices; i++) {
-            printf("%d ", resultado->indices[i]);
+            printf("%d ", indices[i]);
         }
         printf("\n");
+        free(indices);
     }
 
 }
 
-// Busca na AVL por um campo específico
-AVLNode *buscar_avl_por_campo(const char *campo, const char *valor, OperatorType operador) {
-    AVLTree *indice = NULL;
+// Identifica o campo indexado pelo nome usado nas consultas
+int campo_indice(const char *campo) {
+    if (strcmp(campo, "org") == 0) return CAMPO_ORIGEM;
+    if (strcmp(campo, "dst") == 0) return CAMPO_DESTINO;
+    if (strcmp(campo, "prc") == 0) return CAMPO_PRECO;
+    if (strcmp(campo, "sea") == 0) return CAMPO_ASSENTOS;
+    if (strcmp(campo, "dur") == 0) return CAMPO_DURACAO;
+    if (strcmp(campo, "sto") == 0) return CAMPO_PARADAS;
+    return -1;
+}
 
-    // Seleciona a árvore AVL correta com base no campo
-    if (strcmp(campo, "org") == 0) indice = indice_origem;
-    if (strcmp(campo, "dst") == 0) indice = indice_destino;
-    if (strcmp(campo, "prc") == 0) indice = indice_preco;
-    if (strcmp(campo, "sea") == 0) indice = indice_assentos;
-    if (strcmp(campo, "dur") == 0) indice = indice_duracao;
-    if (strcmp(campo, "sto") == 0) indice = indice_paradas;
+// Seleciona a árvore AVL correta com base no campo
+AVLTree *indice_por_campo(AVLTree *const arvores[], const char *campo) {
+    int f = campo_indice(campo);
+    return f >= 0 ? arvores[f] : NULL;
+}
 
-    if (!indice || !indice->raiz) return NULL;
+// Preço em centavos: o produto é exato em double e llrint arredonda meios para o par, como o printf
+int64_t preco_centavos(float preco) {
+    return llrint((double)preco * 100);
+}
+
+// Empacota um código de aeroporto preservando a ordem de strcmp
+int64_t chave_aeroporto(const char *codigo) {
+    int64_t chave = 0;
+    int i = 0;
+    for (; i < 3 && codigo[i]; i++) chave = (chave << 8) | (unsigned char)codigo[i];
+    for (; i < 3; i++) chave <<= 8;
+    return chave;
+}
 
-    // Verifica o operador e chama a busca adequada
-    AVLNode *resultado = NULL;
-    if (operador == OP_EQUAL) {
-        resultado = buscar_avl(indice->raiz, valor);
-    } else if (operador == OP_LESS || operador == OP_LESS_EQUAL) {
-        resultado = buscar_menores_avl(indice->raiz, valor, (operador == OP_LESS_EQUAL));
-    } else if (operador == OP_GREATER || operador == OP_GREATER_EQUAL) {
-        resultado = buscar_maiores_avl(indice->raiz, valor, (operador == OP_GREATER_EQUAL));
+// Chave numérica de um voo para o campo indicado
+int64_t chave_voo(const Flight *voo, int campo) {
+    switch (campo) {
+        case CAMPO_ORIGEM: return chave_aeroporto(voo->origem);
+        case CAMPO_DESTINO: return chave_aeroporto(voo->destino);
+        case CAMPO_PRECO: return preco_centavos(voo->preco);
+        case CAMPO_ASSENTOS: return voo->assentos;
+        case CAMPO_DURACAO: return voo->duracao;
+        case CAMPO_PARADAS: return voo->paradas;
+        default: return (int64_t)voo->partida;
     }
+}
 
-    // 🔍 Depuração: Imprimir o resultado da busca AVL
-    // imprimir_resultado_busca(campo, valor, operador, resultado);
+// Busca na AVL por um campo específico
+AVLNode *buscar_avl_por_campo(AVLTree *const arvores[], const FaixaPredicado *predicado) {
+    if (predicado->campo < 0 || predicado->campo >= NUM_CAMPOS_INDICE) return NULL;
+    AVLTree *indice = arvores[predicado->campo];
+
+    if (!indice || !indice->raiz) return NULL;
+
+    // Coleta os nós que satisfazem o predicado e une suas listas
+    FaixaAVL faixa;
+    buscar_faixa_avl(indice, predicado, &faixa);
+    AVLNode *resultado = materializar_faixa_avl(&faixa);
+    liberar_faixa_avl(&faixa);
 
     return resultado;
 }
 
 
-// 🔍 Função auxiliar para armazenar índices de uma AVL em um array
-void extrair_indices(AVLNode *raiz, int *indices, int *num_indices) {
-    if (!raiz) return;
-    for (int i = 0; i < raiz->num_indices; i++) {
-        indices[(*num_indices)++] = raiz->indices[i];
+/**
+ * Cria um nó resultado (sem filhos) assumindo a posse do vetor de índices.
+ */
+AVLNode *criar_no_resultado(int *indices, int n) {
+    if (n == 0) {
+        free(indices);
+        return NULL;
     }
-    extrair_indices(raiz->esq, indices, num_indices);
-    extrair_indices(raiz->dir, indices, num_indices);
+    AVLNode *no = malloc(sizeof(AVLNode));
+    if (!no) {
+        fprintf(stderr, "Erro ao alocar memória para AVL.\n");
+        exit(EXIT_FAILURE);
+    }
+    strcpy(no->chave, "resultado");
+    no->chave_num = 0;
+    no->indices = indices;
+    no->postings = NULL;
+    no->num_indices = n;
+    no->altura = 1;
+    no->esq = no->dir = NULL;
+    limpar_agregados_no(no);
+    atualizar_agregados(no);
+    return no;
 }
 
-// 🔍 Função auxiliar para verificar se um índice está no conjunto
-bool existe_no_conjunto(int *conjunto, int tamanho, int valor) {
-    for (int i = 0; i < tamanho; i++) {
-        if (conjunto[i] == valor) return true;
+/**
+ * Copia os índices de um nó, descomprimindo se necessário.
+ */
+int extrair_indices_no(const AVLNode *no, int *destino) {
+    if (no->postings) return descomprimir_postings(no->postings, destino);
+    memcpy(destino, no->indices, no->num_indices * sizeof(int));
+    return no->num_indices;
+}
+
+#define ORDENAR_RADIX_MIN 4096  // Abaixo disto o qsort custa menos que as passadas do radix
+#define RADIX_BITS 11            // Dígito do radix: histograma de 2048 contadores, na pilha
+
+static int comparar_indices(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Ordena um vetor de índices não negativos. Vetores pequenos (a maioria das
+ * faixas de uma consulta) usam qsort; os grandes, radix sort LSD com dígitos
+ * de RADIX_BITS bits, só nas passadas que o maior índice exige.
+ */
+static void ordenar_indices(int *v, int n) {
+    if (n < 2) return;
+    if (n < ORDENAR_RADIX_MIN) {
+        qsort(v, n, sizeof(int), comparar_indices);
+        return;
+    }
+
+    int *aux = malloc(n * sizeof(int));
+    if (!aux) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        exit(EXIT_FAILURE);
     }
-    return false;
+    int maior = 0;
+    for (int i = 0; i < n; i++) if (v[i] > maior) maior = v[i];
+
+    int cont[1 << RADIX_BITS];
+    int *origem = v, *destino = aux;
+    for (int desloc = 0; desloc == 0 || (desloc < 32 && (maior >> desloc) > 0); desloc += RADIX_BITS) {
+        memset(cont, 0, sizeof(cont));
+        for (int i = 0; i < n; i++) cont[((unsigned)origem[i] >> desloc) & ((1 << RADIX_BITS) - 1)]++;
+        int soma = 0;
+        for (int d = 0; d < (1 << RADIX_BITS); d++) {
+            int c = cont[d];
+            cont[d] = soma;
+            soma += c;
+        }
+        for (int i = 0; i < n; i++) {
+            destino[cont[((unsigned)origem[i] >> desloc) & ((1 << RADIX_BITS) - 1)]++] = origem[i];
+        }
+        int *t = origem; origem = destino; destino = t;
+    }
+
+    // Número ímpar de passadas: o resultado ficou no auxiliar
+    if (origem != v) memcpy(v, origem, n * sizeof(int));
+    free(aux);
 }
 
-// 🔍 Nova interseção que usa uma estrutura temporária (set)
+/**
+ * Intersecciona dois vetores ordenados. Com tamanhos muito diferentes, usa
+ * busca exponencial no maior para cada elemento do menor.
+ * @return Quantidade de índices escritos em `destino`.
+ */
+static int intersectar_ordenados(const int *a, int na, const int *b, int nb, int *destino) {
+    int total = 0;
+    if (na > nb) {
+        const int *t = a; a = b; b = t;
+        int tn = na; na = nb; nb = tn;
+    }
+
+    if ((long)na * 16 < nb) {
+        int j = 0;
+        for (int i = 0; i < na && j < nb; i++) {
+            int passo = 1, fim = j;
+            while (fim < nb && b[fim] < a[i]) {
+                j = fim + 1;
+                fim += passo;
+                passo <<= 1;
+            }
+            if (fim > nb) fim = nb;
+            while (j < fim) {
+                int meio = j + (fim - j) / 2;
+                if (b[meio] < a[i]) j = meio + 1;
+                else fim = meio;
+            }
+            if (j < nb && b[j] == a[i]) destino[total++] = a[i];
+        }
+        return total;
+    }
+
+    int i = 0, j = 0;
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) i++;
+        else if (a[i] > b[j]) j++;
+        else {
+            destino[total++] = a[i];
+            i++;
+            j++;
+        }
+    }
+    return total;
+}
+
+/**
+ * Intersecciona um vetor ordenado com a lista de um nó (comprimida ou não).
+ */
+static int intersectar_com_no(const int *candidatos, int n, const AVLNode *no, int *destino) {
+    if (no->postings) return intersectar_postings(candidatos, n, no->postings, destino);
+    return intersectar_ordenados(candidatos, n, no->indices, no->num_indices, destino);
+}
+
+// 🔍 Interseção das listas (ordenadas) de dois nós
 AVLNode *intersect_avl_nodes(AVLNode *a, AVLNode *b) {
     if (!a || !b) return NULL; // Se um dos conjuntos for NULL, não há interseção
 
-    int indices_a[1000], indices_b[1000]; // Arrays temporários para armazenar índices
-    int num_indices_a = 0, num_indices_b = 0;
-
-    // 🔍 Extrai os índices das duas árvores em arrays temporários
-    extrair_indices(a, indices_a, &num_indices_a);
-    extrair_indices(b, indices_b, &num_indices_b);
+    // O menor conjunto é o vetor de candidatos
+    if (a->num_indices > b->num_indices) {
+        AVLNode *t = a; a = b; b = t;
+    }
 
-    // 🔍 Criamos uma nova AVL para armazenar a interseção final
-    AVLNode *intersection = NULL;
+    int *candidatos = a->indices;
+    if (a->postings) {
+        candidatos = malloc(a->num_indices * sizeof(int));
+        descomprimir_postings(a->postings, candidatos);
+    }
 
-    // 🔍 Percorremos `indices_b` e adicionamos na interseção apenas se estiverem em `indices_a`
-    for (int i = 0; i < num_indices_b; i++) {
-        if (existe_no_conjunto(indices_a, num_indices_a, indices_b[i])) {
-            intersection = inserir_avl(intersection, "intersec", indices_b[i]);
-        }
+    int *intersecao = malloc((a->num_indices ? a->num_indices : 1) * sizeof(int));
+    if (!intersecao || !candidatos) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        exit(EXIT_FAILURE);
     }
+    int total = intersectar_com_no(candidatos, a->num_indices, b, intersecao);
 
-    return intersection;
+    if (candidatos != a->indices) free(candidatos);
+    return criar_no_resultado(intersecao, total);
 }
 
 
@@ -229,10 +802,14 @@ AVLNode *intersect_avl_nodes(AVLNode *a, AVLNode *b) {
 AVLNode *inserir_todos_nos(AVLNode *destino, AVLNode *origem) {
     if (!origem) return destino;
 
+    int *indices = malloc(origem->num_indices * sizeof(int));
+    extrair_indices_no(origem, indices);
+
     // Mantém os índices sem sobrescrever os anteriores
     for (int i = 0; i < origem->num_indices; i++) {
-        destino = inserir_avl(destino, origem->chave, origem->indices[i]);
+        destino = inserir_avl(destino, origem->chave, indices[i]);
     }
+    free(indices);
 
     // Insere os nós da esquerda e direita
     if (origem->esq) destino = inserir_todos_nos(destino, origem->esq);
@@ -243,130 +820,148 @@ AVLNode *inserir_todos_nos(AVLNode *destino, AVLNode *origem) {
 
 
 /**
- * Função auxiliar para coletar todos os índices de nós com valores <= ao especificado.
+ * Acrescenta um nó à faixa.
  */
-void coletar_menores(AVLNode *raiz, int valor, int incluir_igual, int *indices, int *num_indices) {
-    if (!raiz) return;
-
-    // Criando uma pilha manualmente (simulando recursão)
-    AVLNode *pilha[1000];  // Ajuste o tamanho conforme necessário
-    int topo = -1;
-    
-    // Começamos pelo nó raiz
-    AVLNode *atual = raiz;
-
-    while (atual || topo != -1) {
-        // Percorre a subárvore esquerda primeiro
-        while (atual) {
-            pilha[++topo] = atual;
-            atual = atual->esq;  // Vai para os menores valores primeiro
-        }
-
-        // Pega o último nó da pilha
-        atual = pilha[topo--];
-
-        int chave_num = atoi(atual->chave);
-
-        // Verifica se devemos incluir esse nó no resultado
-        if (chave_num < valor || (incluir_igual && chave_num == valor)) {
-            for (int i = 0; i < atual->num_indices; i++) {
-                indices[(*num_indices)++] = atual->indices[i];
-            }
+static void adicionar_na_faixa(FaixaAVL *faixa, AVLNode *no) {
+    if (faixa->num == faixa->capacidade) {
+        faixa->capacidade = faixa->capacidade ? faixa->capacidade * 2 : 16;
+        faixa->nos = realloc(faixa->nos, faixa->capacidade * sizeof(AVLNode *));
+        if (!faixa->nos) {
+            fprintf(stderr, "Erro de alocação de memória.\n");
+            exit(EXIT_FAILURE);
         }
-
-        // Agora vamos para a subárvore direita
-        atual = atual->dir;
     }
+    faixa->nos[faixa->num++] = no;
+    faixa->total += no->num_indices;
 }
 
+/**
+ * Coleta os nós da subárvore com chave no intervalo, em ordem. Subárvores
+ * cujo intervalo de chaves não cruza o do predicado são puladas.
+ */
+static void coletar_faixa(AVLNode *no, const FaixaPredicado *p, FaixaAVL *faixa) {
+    if (!no || no->chave_max_sub < p->min || no->chave_min_sub > p->max || prazo_esgotado()) return;
+    coletar_faixa(no->esq, p, faixa);
+    if (no->chave_num >= p->min && no->chave_num <= p->max) adicionar_na_faixa(faixa, no);
+    coletar_faixa(no->dir, p, faixa);
+}
 
 /**
- * Busca todos os valores menores ou iguais ao especificado e retorna no formato AVL.
+ * Coleta os nós de um índice que satisfazem o predicado.
  */
-AVLNode *buscar_menores_avl(AVLNode *raiz, const char *valor, int incluir_igual) {
-    if (!raiz) return NULL;
+void buscar_faixa_avl(AVLTree *indice, const FaixaPredicado *predicado, FaixaAVL *faixa) {
+    faixa->nos = NULL;
+    faixa->num = faixa->capacidade = 0;
+    faixa->total = 0;
+    if (!indice || predicado->min > predicado->max) return;
+
+    // Uma única leitura da raiz: toda a busca percorre a mesma versão
+    AVLNode *raiz = indice->raiz;
+    if (!raiz) return;
 
-    int valor_num = atoi(valor);
+    // Igualdade desce pela ordem textual da árvore; intervalos usam os limites das subárvores
+    if (predicado->min == predicado->max) {
+        AVLNode *no = buscar_chave_exata(raiz, predicado->campo, predicado->min);
+        if (no) adicionar_na_faixa(faixa, no);
+    } else {
+        coletar_faixa(raiz, predicado, faixa);
+    }
+}
 
-    // Criamos um array temporário para armazenar os índices encontrados
-    int *indices_temp = malloc(1000 * sizeof(int)); // Ajuste conforme necessário
-    int num_indices = 0;
+/**
+ * Libera o vetor de nós de uma faixa.
+ */
+void liberar_faixa_avl(FaixaAVL *faixa) {
+    free(faixa->nos);
+    faixa->nos = NULL;
+    faixa->num = faixa->capacidade = 0;
+    faixa->total = 0;
+}
 
-    // Coletamos todos os índices válidos antes de inserir na AVL
-    coletar_menores(raiz, valor_num, incluir_igual, indices_temp, &num_indices);
+/**
+ * Une os índices de todos os nós da faixa em um nó resultado ordenado.
+ */
+AVLNode *materializar_faixa_avl(const FaixaAVL *faixa) {
+    if (faixa->total == 0) return NULL;
 
-    // Criamos a AVL final com esses índices
-    AVLNode *resultado = NULL;
-    for (int i = 0; i < num_indices; i++) {
-        resultado = inserir_avl(resultado, valor, indices_temp[i]);
+    int *indices = malloc(faixa->total * sizeof(int));
+    if (!indices) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        exit(EXIT_FAILURE);
+    }
+    int total = 0;
+    for (int i = 0; i < faixa->num && !prazo_esgotado(); i++) {
+        total += extrair_indices_no(faixa->nos[i], indices + total);
     }
 
-    free(indices_temp); // Liberamos a memória do array temporário
-    return resultado;
+    // Cada nó já está ordenado; só a união de vários nós precisa ser reordenada
+    if (faixa->num > 1 && !verificar_prazo()) ordenar_indices(indices, total);
+    return criar_no_resultado(indices, total);
 }
 
-
-
 /**
- * Função auxiliar para coletar todos os índices de nós com valores >= ao especificado.
+ * Intersecciona um nó resultado com a união dos nós da faixa.
  */
-void coletar_maiores(AVLNode *raiz, int valor, int incluir_igual, int *indices, int *num_indices) {
-    if (!raiz) return;
-
-    // Criando uma pilha manualmente (simulando recursão)
-    AVLNode *pilha[1000];  // Ajuste o tamanho conforme necessário
-    int topo = -1;
-    
-    // Começamos pelo nó raiz
-    AVLNode *atual = raiz;
-
-    while (atual || topo != -1) {
-        // Percorre a subárvore direita primeiro
-        while (atual) {
-            pilha[++topo] = atual;
-            atual = atual->dir;  // Vai para os maiores valores primeiro
+AVLNode *intersectar_faixa_avl(AVLNode *resultado, const FaixaAVL *faixa) {
+    if (!resultado || faixa->total == 0) return NULL;
+
+    // Faixa grande frente ao resultado: intersecciona nó a nó, pulando blocos
+    if ((long)resultado->num_indices * faixa->num <= faixa->total) {
+        int *candidatos = resultado->indices;
+        if (resultado->postings) {
+            candidatos = malloc(resultado->num_indices * sizeof(int));
+            descomprimir_postings(resultado->postings, candidatos);
         }
 
-        // Pega o último nó da pilha
-        atual = pilha[topo--];
-
-        int chave_num = atoi(atual->chave);
-
-        // Verifica se devemos incluir esse nó no resultado
-        if (chave_num > valor || (incluir_igual && chave_num == valor)) {
-            for (int i = 0; i < atual->num_indices; i++) {
-                indices[(*num_indices)++] = atual->indices[i];
-            }
+        int *intersecao = malloc(resultado->num_indices * sizeof(int));
+        if (!intersecao || !candidatos) {
+            fprintf(stderr, "Erro de alocação de memória.\n");
+            exit(EXIT_FAILURE);
+        }
+        int total = 0;
+        for (int i = 0; i < faixa->num && total < resultado->num_indices && !prazo_esgotado(); i++) {
+            total += intersectar_com_no(candidatos, resultado->num_indices, faixa->nos[i], intersecao + total);
         }
+        if (candidatos != resultado->indices) free(candidatos);
 
-        // Agora vamos para a subárvore esquerda
-        atual = atual->esq;
+        // Um voo tem uma única chave por campo, então as partes são disjuntas
+        if (faixa->num > 1) ordenar_indices(intersecao, total);
+        return criar_no_resultado(intersecao, total);
     }
-}
-
 
+    AVLNode *uniao = materializar_faixa_avl(faixa);
+    AVLNode *intersecao = intersect_avl_nodes(resultado, uniao);
+    liberar_avl(uniao);
+    return intersecao;
+}
 
 /**
- * Busca todos os valores maiores ou iguais ao especificado e retorna no formato AVL.
+ * Comprime as listas de índices de todos os nós da árvore. Listas curtas, em
+ * que o cabeçalho dos blocos custaria mais que o vetor, continuam simples.
  */
-AVLNode *buscar_maiores_avl(AVLNode *raiz, const char *valor, int incluir_igual) {
-    if (!raiz) return NULL;
-
-    int valor_num = atoi(valor);
-
-    // Criamos um array temporário para armazenar os índices encontrados
-    int *indices_temp = malloc(1000 * sizeof(int)); // Ajuste conforme necessário
-    int num_indices = 0;
-
-    // Coletamos todos os índices válidos antes de inserir na AVL
-    coletar_maiores(raiz, valor_num, incluir_igual, indices_temp, &num_indices);
-
-    // Criamos a AVL final com esses índices
-    AVLNode *resultado = NULL;
-    for (int i = 0; i < num_indices; i++) {
-        resultado = inserir_avl(resultado, valor, indices_temp[i]);
+void comprimir_avl(AVLNode *raiz) {
+    if (!raiz) return;
+    comprimir_avl(raiz->esq);
+    comprimir_avl(raiz->dir);
+    if (!raiz->postings && raiz->num_indices >= POSTINGS_MIN_COMPRIMIR) {
+        ListaPostings *postings = comprimir_postings(raiz->indices, raiz->num_indices);
+        if (memoria_postings(postings) < raiz->num_indices * sizeof(int)) {
+            raiz->postings = postings;
+            free(raiz->indices);
+            raiz->indices = NULL;
+        } else {
+            liberar_postings(postings);
+        }
     }
+}
 
-    free(indices_temp); // Liberamos a memória do array temporário
-    return resultado;
+/**
+ * Memória ocupada pela árvore (nós e listas de índices), em bytes.
+ */
+size_t memoria_avl(const AVLNode *raiz) {
+    if (!raiz) return 0;
+    size_t total = sizeof(AVLNode);
+    if (raiz->postings) total += memoria_postings(raiz->postings);
+    else total += raiz->num_indices * sizeof(int);
+    return total + memoria_avl(raiz->esq) + memoria_avl(raiz->dir);
 }
@@ -0,0 +1,131 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "capture.h"
+
+/**
+ * Instante atual do relógio monotônico, em nanossegundos.
+ */
+uint64_t relogio_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Cria o arquivo de captura e escreve o cabeçalho.
+ */
+CapturaConsultas *abrir_captura(const char *caminho) {
+    FILE *arquivo = fopen(caminho, "wb");
+    if (!arquivo) {
+        fprintf(stderr, "Erro ao criar o arquivo de captura %s.\n", caminho);
+        return NULL;
+    }
+    uint32_t versao = CAPTURA_VERSAO;
+    fwrite(CAPTURA_MAGICA, 1, 4, arquivo);
+    fwrite(&versao, sizeof(versao), 1, arquivo);
+
+    CapturaConsultas *captura = malloc(sizeof(CapturaConsultas));
+    if (!captura) {
+        fprintf(stderr, "Erro ao alocar memória para a captura.\n");
+        exit(EXIT_FAILURE);
+    }
+    captura->arquivo = arquivo;
+    captura->inicio = relogio_ns();
+    captura->num_registros = 0;
+    pthread_mutex_init(&captura->trava, NULL);
+    return captura;
+}
+
+/**
+ * Anexa uma consulta executada ao log.
+ */
+void registrar_consulta(CapturaConsultas *captura, const Query *consulta, uint64_t chegada, uint64_t termino) {
+    uint64_t desde_inicio = chegada > captura->inicio ? chegada - captura->inicio : 0;
+    uint64_t latencia = termino > chegada ? termino - chegada : 0;
+    int32_t max_voos = consulta->max_voos;
+    uint8_t agregacao = (uint8_t)consulta->agregacao;
+    uint16_t tamanho = (uint16_t)strlen(consulta->expressao);
+    char trigrama[3] = {0};  // Completado com zeros (agregações não têm trigrama)
+    memcpy(trigrama, consulta->trigrama, strnlen(consulta->trigrama, sizeof(trigrama)));
+    uint8_t paginacao = consulta->tem_cursor ? 2 : consulta->paginada ? 1 : 0;
+    char cursor[CURSOR_TAMANHO + 1];
+    if (consulta->tem_cursor) codificar_cursor(consulta, &consulta->cursor, cursor);
+
+    pthread_mutex_lock(&captura->trava);
+    FILE *f = captura->arquivo;
+    fwrite(&desde_inicio, sizeof(desde_inicio), 1, f);
+    fwrite(&latencia, sizeof(latencia), 1, f);
+    fwrite(&max_voos, sizeof(max_voos), 1, f);
+    fwrite(&agregacao, sizeof(agregacao), 1, f);
+    fwrite(trigrama, 1, sizeof(trigrama), f);
+    fwrite(&tamanho, sizeof(tamanho), 1, f);
+    fwrite(consulta->expressao, 1, tamanho, f);
+    fwrite(&paginacao, sizeof(paginacao), 1, f);
+    if (consulta->tem_cursor) fwrite(cursor, 1, CURSOR_TAMANHO, f);
+    captura->num_registros++;
+    pthread_mutex_unlock(&captura->trava);
+}
+
+/**
+ * Descarrega e fecha o log.
+ */
+void fechar_captura(CapturaConsultas *captura) {
+    if (!captura) return;
+    fclose(captura->arquivo);
+    pthread_mutex_destroy(&captura->trava);
+    free(captura);
+}
+
+/**
+ * Abre um log de captura para leitura, validando o cabeçalho.
+ */
+FILE *abrir_captura_leitura(const char *caminho) {
+    FILE *arquivo = fopen(caminho, "rb");
+    if (!arquivo) {
+        fprintf(stderr, "Erro ao abrir o arquivo de captura %s.\n", caminho);
+        return NULL;
+    }
+    char magica[4];
+    uint32_t versao;
+    if (fread(magica, 1, 4, arquivo) != 4 || memcmp(magica, CAPTURA_MAGICA, 4) != 0 ||
+        fread(&versao, sizeof(versao), 1, arquivo) != 1 || versao != CAPTURA_VERSAO) {
+        fprintf(stderr, "Arquivo de captura inválido: %s\n", caminho);
+        fclose(arquivo);
+        return NULL;
+    }
+    return arquivo;
+}
+
+/**
+ * Lê o próximo registro do log.
+ */
+int ler_registro_consulta(FILE *arquivo, RegistroConsulta *registro) {
+    int32_t max_voos;
+    uint8_t agregacao;
+    uint16_t tamanho;
+    uint8_t paginacao;
+    char cursor[CURSOR_TAMANHO + 1];
+    Query *consulta = &registro->consulta;
+
+    if (fread(&registro->chegada, sizeof(registro->chegada), 1, arquivo) != 1 ||
+        fread(&registro->latencia, sizeof(registro->latencia), 1, arquivo) != 1 ||
+        fread(&max_voos, sizeof(max_voos), 1, arquivo) != 1 ||
+        fread(&agregacao, sizeof(agregacao), 1, arquivo) != 1 ||
+        fread(consulta->trigrama, 1, 3, arquivo) != 3 ||
+        fread(&tamanho, sizeof(tamanho), 1, arquivo) != 1 ||
+        tamanho >= sizeof(consulta->expressao) ||
+        fread(consulta->expressao, 1, tamanho, arquivo) != tamanho ||
+        fread(&paginacao, sizeof(paginacao), 1, arquivo) != 1 || paginacao > 2 ||
+        (paginacao == 2 && fread(cursor, 1, CURSOR_TAMANHO, arquivo) != CURSOR_TAMANHO)) {
+        return 0;
+    }
+    consulta->max_voos = max_voos;
+    consulta->agregacao = (TipoAgregacao)agregacao;
+    consulta->trigrama[3] = '\0';
+    consulta->expressao[tamanho] = '\0';
+    consulta->paginada = paginacao > 0;
+    consulta->tem_cursor = 0;
+    cursor[CURSOR_TAMANHO] = '\0';
+    return paginacao < 2 || decodificar_cursor(cursor, consulta);
+}
@@ -0,0 +1,105 @@
+#include <stdint.h>
+#include "cursor.h"
+#include "sort.h"
+
+/**
+ * Assinatura de uma consulta: FNV-1a do trigrama e da expressão, sem os
+ * espaços finais (a mesma linha lida do arquivo, com "\r", ou do socket).
+ */
+static uint32_t assinatura_consulta(const Query *consulta) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < 3 && consulta->trigrama[i]; i++) {
+        h = (h ^ (unsigned char)consulta->trigrama[i]) * 16777619u;
+    }
+    size_t tamanho = strlen(consulta->expressao);
+    while (tamanho > 0 && (consulta->expressao[tamanho - 1] == ' ' || consulta->expressao[tamanho - 1] == '\r' ||
+                           consulta->expressao[tamanho - 1] == '\t')) {
+        tamanho--;
+    }
+    for (size_t i = 0; i < tamanho; i++) {
+        h = (h ^ (unsigned char)consulta->expressao[i]) * 16777619u;
+    }
+    return h;
+}
+
+/**
+ * Codifica o cursor: '@' e cinco palavras de 32 bits em hexadecimal (bits do
+ * preço, duração, paradas, id e assinatura).
+ */
+void codificar_cursor(const Query *consulta, const Flight *ultimo, char *texto) {
+    uint32_t preco;
+    memcpy(&preco, &ultimo->preco, sizeof(preco));
+    snprintf(texto, CURSOR_TAMANHO + 1, "@%08x%08x%08x%08x%08x", preco, (uint32_t)ultimo->duracao,
+             (uint32_t)ultimo->paradas, (uint32_t)ultimo->id, assinatura_consulta(consulta));
+}
+
+/**
+ * Decodifica um cursor para a consulta.
+ */
+int decodificar_cursor(const char *texto, Query *consulta) {
+    uint32_t palavras[5];
+    if (strlen(texto) != CURSOR_TAMANHO || texto[0] != '@') return 0;
+    for (int p = 0; p < 5; p++) {
+        uint32_t valor = 0;
+        for (int i = 0; i < 8; i++) {
+            char c = texto[1 + p * 8 + i];
+            int digito = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+            if (digito < 0) return 0;
+            valor = (valor << 4) | (uint32_t)digito;
+        }
+        palavras[p] = valor;
+    }
+    if (palavras[4] != assinatura_consulta(consulta)) return 0;
+
+    memset(&consulta->cursor, 0, sizeof(consulta->cursor));
+    memcpy(&consulta->cursor.preco, &palavras[0], sizeof(palavras[0]));
+    consulta->cursor.duracao = (int)palavras[1];
+    consulta->cursor.paradas = (int)palavras[2];
+    consulta->cursor.id = (int)palavras[3];
+    consulta->tem_cursor = 1;
+    return 1;
+}
+
+/**
+ * Verifica se um voo vem depois do cursor da consulta.
+ */
+int depois_do_cursor(const Query *consulta, const Flight *voo) {
+    return !consulta->tem_cursor || comparar_voos_id(voo, &consulta->cursor, consulta->trigrama) > 0;
+}
+
+/**
+ * Mantém em `ids` só os voos posteriores ao cursor.
+ */
+int aplicar_cursor(const Query *consulta, const Flight *voos, int *ids, int n) {
+    if (!consulta->tem_cursor) return n;
+    int mantidos = 0;
+    for (int i = 0; i < n; i++) {
+        if (depois_do_cursor(consulta, &voos[ids[i]])) ids[mantidos++] = ids[i];
+    }
+    return mantidos;
+}
+
+/**
+ * Quantidade de voos a selecionar para a página.
+ */
+int limite_pagina(const Query *consulta) {
+    if (consulta->max_voos <= 0) return 0;
+    return consulta->max_voos + (consulta->paginada ? 1 : 0);
+}
+
+/**
+ * Escreve "cursor <próximo>" ou "cursor -".
+ */
+void imprimir_cursor(Saida *saida, const Query *consulta, const Flight *ultimo, int ha_mais) {
+    if (!consulta->paginada) return;
+    char linha[CURSOR_TAMANHO + 9];
+    memcpy(linha, "cursor ", 7);
+    if (ha_mais && ultimo) {
+        codificar_cursor(consulta, ultimo, linha + 7);
+    } else {
+        strcpy(linha + 7, "-");
+    }
+    size_t tamanho = strlen(linha);
+    linha[tamanho++] = '\n';
+    escrever_saida(saida, linha, tamanho);
+}
@@ -0,0 +1,52 @@
+#include "deadline.h"
+#include "capture.h"
+
+/**
+ * Prazo da consulta em andamento na thread.
+ */
+typedef struct {
+    uint64_t limite;     // 0 = sem prazo
+    unsigned contador;   // Verificações desde a última leitura do relógio
+    int esgotado;
+} PrazoConsulta;
+
+static _Thread_local PrazoConsulta prazo = { 0, 0, 0 };
+
+/**
+ * Define o prazo da consulta que a thread atual vai responder.
+ */
+void iniciar_prazo(uint64_t limite) {
+    prazo.limite = limite;
+    prazo.contador = 0;
+    prazo.esgotado = 0;
+}
+
+/**
+ * Verifica se o prazo da thread atual acabou, lendo o relógio só a cada
+ * PRAZO_INTERVALO_RELOGIO chamadas.
+ */
+int prazo_esgotado() {
+    if (!prazo.limite) return 0;
+    if (prazo.esgotado) return 1;
+    if (++prazo.contador % PRAZO_INTERVALO_RELOGIO != 0) return 0;
+    prazo.esgotado = relogio_ns() >= prazo.limite;
+    return prazo.esgotado;
+}
+
+/**
+ * Verifica se o prazo da thread atual acabou, sempre lendo o relógio.
+ */
+int verificar_prazo() {
+    if (!prazo.limite) return 0;
+    if (!prazo.esgotado) prazo.esgotado = relogio_ns() >= prazo.limite;
+    return prazo.esgotado;
+}
+
+/**
+ * Remove o prazo da thread atual.
+ */
+int encerrar_prazo() {
+    int esgotado = prazo.esgotado;
+    iniciar_prazo(0);
+    return esgotado;
+}
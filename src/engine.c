@@ -0,0 +1,143 @@
+#include <stdatomic.h>
+#include "engine.h"
+#include "flight.h"
+#include "query.h"
+#include "output.h"
+#include "server.h"
+#include "epoch.h"
+
+/**
+ * Conjunto de dados publicado: voos e os seus índices. Imutável depois de
+ * publicado, exceto pelas atualizações copy-on-write dos índices.
+ */
+typedef struct {
+    Flight *voos;
+    int n;
+    IndicesVoos *indices;
+} DadosEngine;
+
+/**
+ * Motor de consultas.
+ */
+struct Engine {
+    _Atomic(DadosEngine *) dados;  // Conjunto vigente
+};
+
+/**
+ * Constrói um conjunto de dados a partir dos voos (que passam a pertencer a ele).
+ */
+static DadosEngine *criar_dados(Flight *voos, int n) {
+    DadosEngine *dados = malloc(sizeof(DadosEngine));
+    if (!dados) {
+        fprintf(stderr, "Erro ao alocar memória para o motor.\n");
+        exit(EXIT_FAILURE);
+    }
+    dados->voos = voos;
+    dados->n = n;
+    dados->indices = criar_indices();
+    construir_indices(dados->indices, voos, n);
+    return dados;
+}
+
+/**
+ * Libera um conjunto de dados (assinatura compatível com aposentar).
+ */
+static void liberar_dados(void *ptr) {
+    DadosEngine *dados = ptr;
+    liberar_indices(dados->indices);
+    free(dados->voos);
+    free(dados);
+}
+
+/**
+ * Cria um motor com um conjunto vazio.
+ */
+Engine *engine_create(void) {
+    Engine *engine = malloc(sizeof(Engine));
+    if (!engine) {
+        fprintf(stderr, "Erro ao alocar memória para o motor.\n");
+        exit(EXIT_FAILURE);
+    }
+    atomic_init(&engine->dados, criar_dados(malloc(sizeof(Flight)), 0));
+    return engine;
+}
+
+/**
+ * Lê os voos, constrói os índices e publica o novo conjunto com uma troca
+ * atômica; o anterior é liberado pelo coletor de épocas.
+ */
+int engine_load(Engine *engine, FILE *arquivo) {
+    int n;
+    if (fscanf(arquivo, "%d", &n) != 1 || n < 0) return -1;
+
+    Flight *voos = malloc((n > 0 ? n : 1) * sizeof(Flight));
+    if (!voos) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < n; i++) {
+        if (!ler_voo(arquivo, &voos[i])) {
+            free(voos);
+            return -1;
+        }
+        voos[i].id = i;
+    }
+    DadosEngine *novos = criar_dados(voos, n);
+
+    DadosEngine *antigos = atomic_exchange(&engine->dados, novos);
+    aposentar(antigos, liberar_dados);
+    recolher_aposentados();
+    return n;
+}
+
+/**
+ * Responde uma consulta sobre o conjunto vigente.
+ */
+int engine_query(Engine *engine, const char *linha, char **resposta, size_t *tamanho) {
+    Query consulta;
+    if (!interpretar_consulta(linha, &consulta)) return -1;
+
+    Saida *saida = criar_saida(-1, 4096);
+    entrar_epoca();
+    DadosEngine *dados = atomic_load(&engine->dados);
+    int linhas = responder_consulta_indices(saida, dados->indices, dados->voos, dados->n, &consulta);
+    sair_epoca();
+
+    // O buffer em memória passa ao chamador
+    escrever_saida(saida, "", 1);
+    if (tamanho) *tamanho = saida->tamanho - 1;
+    *resposta = saida->dados;
+    free(saida);
+    return linhas;
+}
+
+/**
+ * Atualiza um voo do conjunto vigente.
+ */
+int engine_update(Engine *engine, int id, const char *campo, const char *valor) {
+    entrar_epoca();
+    DadosEngine *dados = atomic_load(&engine->dados);
+    int atualizado = atualizar_voo(dados->indices, dados->voos, dados->n, id, campo, valor);
+    sair_epoca();
+    return atualizado;
+}
+
+/**
+ * Quantidade de voos do conjunto vigente.
+ */
+int engine_size(Engine *engine) {
+    entrar_epoca();
+    int n = atomic_load(&engine->dados)->n;
+    sair_epoca();
+    return n;
+}
+
+/**
+ * Libera o motor e o conjunto vigente.
+ */
+void engine_destroy(Engine *engine) {
+    if (!engine) return;
+    recolher_aposentados();
+    liberar_dados(atomic_load(&engine->dados));
+    free(engine);
+}
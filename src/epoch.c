@@ -0,0 +1,186 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "epoch.h"
+
+#define EPOCA_INATIVA 0  // Slot livre ou leitor fora de uma leitura (épocas começam em 1)
+
+/**
+ * Slot de um leitor: época observada ao entrar (ou EPOCA_INATIVA).
+ * Alinhado à linha de cache para evitar falso compartilhamento.
+ */
+typedef struct {
+    _Alignas(64) _Atomic uint64_t epoca;
+    atomic_int ocupado;
+} SlotLeitor;
+
+/**
+ * Bloco aposentado aguardando o fim das leituras que podem alcançá-lo.
+ */
+typedef struct Aposentado {
+    void *ptr;
+    void (*liberar)(void *);
+    uint64_t epoca;              // Época global no momento da aposentadoria
+    struct Aposentado *prox;
+} Aposentado;
+
+static _Atomic uint64_t epoca_global = 1;
+static SlotLeitor slots[EPOCA_MAX_LEITORES];
+
+// Lista de aposentados, compartilhada pelos escritores de todas as tabelas
+static Aposentado *aposentados = NULL;
+static int num_aposentados = 0;
+static pthread_mutex_t trava_aposentados = PTHREAD_MUTEX_INITIALIZER;
+
+// Slot da thread atual (-1 até o primeiro uso); liberado quando a thread termina
+static _Thread_local int slot_atual = -1;
+
+// Leituras aninhadas da thread atual; só a mais externa publica a época
+static _Thread_local int profundidade = 0;
+static pthread_key_t chave_slot;
+static pthread_once_t chave_criada = PTHREAD_ONCE_INIT;
+
+// Threads à espera de um slot quando todos estão ocupados
+static pthread_mutex_t trava_slots = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t slot_devolvido = PTHREAD_COND_INITIALIZER;
+
+static void devolver_slot(void *arg) {
+    SlotLeitor *slot = arg;
+    atomic_store(&slot->epoca, EPOCA_INATIVA);
+    pthread_mutex_lock(&trava_slots);
+    atomic_store(&slot->ocupado, 0);
+    pthread_cond_signal(&slot_devolvido);
+    pthread_mutex_unlock(&trava_slots);
+}
+
+static void criar_chave_slot() {
+    pthread_key_create(&chave_slot, devolver_slot);
+}
+
+/**
+ * Procura um slot livre e o reserva para a thread atual.
+ * @return Índice do slot, ou -1 se todos estão ocupados.
+ */
+static int reservar_slot() {
+    for (int i = 0; i < EPOCA_MAX_LEITORES; i++) {
+        int livre = 0;
+        if (atomic_compare_exchange_strong(&slots[i].ocupado, &livre, 1)) return i;
+    }
+    return -1;
+}
+
+/**
+ * Reserva um slot para a thread atual na primeira leitura. Com todos
+ * ocupados, espera uma thread leitora terminar (os slots são devolvidos
+ * com a trava, então a nova busca não perde a devolução).
+ */
+static SlotLeitor *obter_slot() {
+    if (slot_atual >= 0) return &slots[slot_atual];
+
+    pthread_once(&chave_criada, criar_chave_slot);
+    int i = reservar_slot();
+    if (i < 0) {
+        pthread_mutex_lock(&trava_slots);
+        while ((i = reservar_slot()) < 0) pthread_cond_wait(&slot_devolvido, &trava_slots);
+        pthread_mutex_unlock(&trava_slots);
+    }
+    slot_atual = i;
+    pthread_setspecific(chave_slot, &slots[i]);
+    return &slots[i];
+}
+
+/**
+ * Marca o início de uma leitura.
+ */
+void entrar_epoca() {
+    if (profundidade++ > 0) return;
+    SlotLeitor *slot = obter_slot();
+    // seq_cst: a publicação da época precede qualquer leitura de raiz
+    atomic_store(&slot->epoca, atomic_load(&epoca_global));
+}
+
+/**
+ * Marca o fim da leitura.
+ */
+void sair_epoca() {
+    if (--profundidade > 0) return;
+    atomic_store_explicit(&slots[slot_atual].epoca, EPOCA_INATIVA, memory_order_release);
+}
+
+/**
+ * Espera as leituras iniciadas antes da chamada: as que entraram numa época
+ * anterior à nova época global.
+ */
+void esperar_leituras() {
+    uint64_t limite = atomic_fetch_add(&epoca_global, 1) + 1;
+    for (int i = 0; i < EPOCA_MAX_LEITORES; i++) {
+        if (i == slot_atual) continue;
+        uint64_t e;
+        while ((e = atomic_load(&slots[i].epoca)) != EPOCA_INATIVA && e < limite) sched_yield();
+    }
+}
+
+/**
+ * Entrega ao coletor um bloco que deixou de ser alcançável.
+ */
+void aposentar(void *ptr, void (*liberar)(void *)) {
+    if (!ptr) return;
+    Aposentado *a = malloc(sizeof(Aposentado));
+    if (!a) {
+        fprintf(stderr, "Erro ao alocar memória para o coletor.\n");
+        exit(EXIT_FAILURE);
+    }
+    a->ptr = ptr;
+    a->liberar = liberar;
+
+    pthread_mutex_lock(&trava_aposentados);
+    a->epoca = atomic_load(&epoca_global);
+    a->prox = aposentados;
+    aposentados = a;
+    num_aposentados++;
+    pthread_mutex_unlock(&trava_aposentados);
+}
+
+/**
+ * Avança a época e libera o que nenhum leitor ativo pode alcançar.
+ */
+int recolher_aposentados() {
+    pthread_mutex_lock(&trava_aposentados);
+    atomic_fetch_add(&epoca_global, 1);
+
+    // Menor época entre os leitores ativos
+    uint64_t minima = UINT64_MAX;
+    for (int i = 0; i < EPOCA_MAX_LEITORES; i++) {
+        uint64_t e = atomic_load(&slots[i].epoca);
+        if (e != EPOCA_INATIVA && e < minima) minima = e;
+    }
+
+    int liberados = 0;
+    Aposentado **p = &aposentados;
+    while (*p) {
+        Aposentado *a = *p;
+        if (a->epoca < minima) {
+            *p = a->prox;
+            a->liberar(a->ptr);
+            free(a);
+            liberados++;
+        } else {
+            p = &a->prox;
+        }
+    }
+    num_aposentados -= liberados;
+    pthread_mutex_unlock(&trava_aposentados);
+    return liberados;
+}
+
+/**
+ * Quantidade de blocos aposentados ainda aguardando liberação.
+ */
+int aposentados_pendentes() {
+    pthread_mutex_lock(&trava_aposentados);
+    int pendentes = num_aposentados;
+    pthread_mutex_unlock(&trava_aposentados);
+    return pendentes;
+}
@@ -0,0 +1,179 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "executor.h"
+#include "expr_parser.h"
+
+// Custo relativo de um id lido das listas dos índices (união, ordenação e
+// interseção) frente a um voo testado na varredura. Medido com consultas de
+// uma a quatro folhas sobre 200 mil voos, os dois se equilibram
+#define CUSTO_ID_INDICE 1
+
+/**
+ * Interpreta o nome de um motor.
+ */
+int tipo_executor(const char *nome) {
+    if (strcmp(nome, "index") == 0) return EXECUTOR_INDICE;
+    if (strcmp(nome, "scan") == 0) return EXECUTOR_VARREDURA;
+    if (strcmp(nome, "auto") == 0) return EXECUTOR_AUTO;
+    if (strcmp(nome, "verify") == 0) return EXECUTOR_VERIFICAR;
+    return -1;
+}
+
+static int filtrar_indice(Executor *e, const Query *consulta, int **resultados) {
+    return filtrar_voos(e->indices, e->voos, e->n, consulta, resultados);
+}
+
+static void agregar_indice(Executor *e, const Query *consulta, AgregadoPreco *agregado) {
+    agregar_voos(e->indices, e->voos, e->n, consulta, agregado);
+}
+
+static int filtrar_varredura(Executor *e, const Query *consulta, int **resultados) {
+    return filtrar_voos_varredura(e->zonas, consulta, resultados);
+}
+
+static void agregar_varredura(Executor *e, const Query *consulta, AgregadoPreco *agregado) {
+    agregar_voos_varredura(e->zonas, consulta, agregado);
+}
+
+/**
+ * Decide se a consulta sai mais barata pela varredura. O custo dos índices é
+ * o de estimar_custo_folhas (contagens das folhas lidas dos agregados das
+ * subárvores); o da varredura é a quantidade de voos nos blocos compatíveis
+ * com o mapa de zonas.
+ */
+static int preferir_varredura(Executor *e, const Query *consulta) {
+    ExprNode *expressao = parse_expressao(consulta->expressao);
+    FaixaPredicado folhas[MAX_FOLHAS_EXPRESSAO];
+    int num = expressao ? converter_folhas_expressao(expressao, folhas, MAX_FOLHAS_EXPRESSAO) : -1;
+    liberar_expressao(expressao);
+    if (num <= 0) return 0;
+
+    long custo_indice = estimar_custo_folhas(e->indices, e->n, folhas, num);
+    return estimar_linhas_varredura(e->zonas, folhas, num) < custo_indice * CUSTO_ID_INDICE;
+}
+
+static int filtrar_auto(Executor *e, const Query *consulta, int **resultados) {
+    if (preferir_varredura(e, consulta)) return filtrar_varredura(e, consulta, resultados);
+    return filtrar_indice(e, consulta, resultados);
+}
+
+static void agregar_auto(Executor *e, const Query *consulta, AgregadoPreco *agregado) {
+    if (preferir_varredura(e, consulta)) agregar_varredura(e, consulta, agregado);
+    else agregar_indice(e, consulta, agregado);
+}
+
+/**
+ * Relata uma divergência entre os motores e aborta.
+ */
+static void divergencia(const Query *consulta, const char *detalhe) {
+    fprintf(stderr, "Divergência entre os motores index e scan na consulta \"%s\": %s\n",
+            consulta->expressao, detalhe);
+    abort();
+}
+
+static int filtrar_verificar(Executor *e, const Query *consulta, int **resultados) {
+    int *oraculo;
+    int num = filtrar_indice(e, consulta, resultados);
+    int num_oraculo = filtrar_varredura(e, consulta, &oraculo);
+
+    if (num != num_oraculo || memcmp(*resultados, oraculo, num * sizeof(int)) != 0) {
+        char detalhe[128];
+        int i = 0;
+        while (i < num && i < num_oraculo && (*resultados)[i] == oraculo[i]) i++;
+        snprintf(detalhe, sizeof(detalhe), "%d voos contra %d, primeira diferença na posição %d",
+                 num, num_oraculo, i);
+        divergencia(consulta, detalhe);
+    }
+    free(oraculo);
+    return num;
+}
+
+static void agregar_verificar(Executor *e, const Query *consulta, AgregadoPreco *agregado) {
+    AgregadoPreco oraculo;
+    agregar_indice(e, consulta, agregado);
+    agregar_varredura(e, consulta, &oraculo);
+
+    // A soma depende da ordem das parcelas (subárvores contra voos), então só ela tem tolerância
+    double tolerancia = 1e-9 * fmax(1.0, fabs(oraculo.soma));
+    if (agregado->quantidade != oraculo.quantidade || fabs(agregado->soma - oraculo.soma) > tolerancia ||
+        (oraculo.quantidade > 0 && (agregado->minimo != oraculo.minimo || agregado->maximo != oraculo.maximo))) {
+        char detalhe[160];
+        snprintf(detalhe, sizeof(detalhe), "quantidade %ld/%ld, soma %.2f/%.2f, mínimo %.2f/%.2f, máximo %.2f/%.2f",
+                 agregado->quantidade, oraculo.quantidade, agregado->soma, oraculo.soma,
+                 agregado->minimo, oraculo.minimo, agregado->maximo, oraculo.maximo);
+        divergencia(consulta, detalhe);
+    }
+}
+
+/**
+ * Cria o motor e constrói as estruturas de acesso de que ele precisa.
+ */
+Executor *criar_executor(TipoExecutor tipo, Flight *voos, int n, int comprimir, const PlanoIndices *plano) {
+    Executor *e = calloc(1, sizeof(Executor));
+    if (!e) {
+        fprintf(stderr, "Erro ao alocar memória para o motor de execução.\n");
+        exit(EXIT_FAILURE);
+    }
+    e->tipo = tipo;
+    e->voos = voos;
+    e->n = n;
+
+    if (tipo != EXECUTOR_VARREDURA) {
+        e->indices = criar_indices();
+        if (plano) {
+            construir_indices_plano(e->indices, voos, n, plano);
+        } else {
+            construir_indices(e->indices, voos, n);
+            if (comprimir) comprimir_indices(e->indices);
+        }
+    }
+    if (tipo != EXECUTOR_INDICE) {
+        e->zonas = construir_mapa_zonas(voos, n);
+    }
+
+    switch (tipo) {
+        case EXECUTOR_VARREDURA:
+            e->filtrar = filtrar_varredura;
+            e->agregar = agregar_varredura;
+            break;
+        case EXECUTOR_AUTO:
+            e->filtrar = filtrar_auto;
+            e->agregar = agregar_auto;
+            break;
+        case EXECUTOR_VERIFICAR:
+            e->filtrar = filtrar_verificar;
+            e->agregar = agregar_verificar;
+            break;
+        default:
+            e->filtrar = filtrar_indice;
+            e->agregar = agregar_indice;
+            break;
+    }
+    return e;
+}
+
+/**
+ * Filtra os voos que atendem à consulta.
+ */
+int filtrar_executor(Executor *executor, const Query *consulta, int **resultados) {
+    return executor->filtrar(executor, consulta, resultados);
+}
+
+/**
+ * Agrega os preços dos voos que atendem à consulta.
+ */
+void agregar_executor(Executor *executor, const Query *consulta, AgregadoPreco *agregado) {
+    executor->agregar(executor, consulta, agregado);
+}
+
+/**
+ * Libera o motor e as suas estruturas de acesso.
+ */
+void liberar_executor(Executor *executor) {
+    if (!executor) return;
+    liberar_indices(executor->indices);
+    liberar_mapa_zonas(executor->zonas);
+    free(executor);
+}
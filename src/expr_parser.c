@@ -1,4 +1,6 @@
+#include <math.h>
 #include "expr_parser.h"
+#include "deadline.h"
 
 /**
  * Imprime a árvore de expressão em formato hierárquico.
@@ -56,7 +58,7 @@ OperatorType identificar_operador(const char *op_str) {
     if (strcmp(op_str, "&&") == 0) return OP_AND;
 
     fprintf(stderr, "Erro: Operador desconhecido '%s'\n", op_str);
-    exit(EXIT_FAILURE);
+    return OP_INVALID;
 }
 
 /**
@@ -73,7 +75,9 @@ ExprNode *parse_expressao(const char *expr) {
         }
     }
 
-    char *token = strtok(expr_copia, " ()");
+    // strtok_r mantém o estado local, permitindo várias consultas em paralelo
+    char *estado = NULL;
+    char *token = strtok_r(expr_copia, " ()", &estado);
     ExprNode *root = NULL, *current = NULL;
 
     while (token) {
@@ -81,7 +85,7 @@ ExprNode *parse_expressao(const char *expr) {
 
         // Ignora tokens inválidos
         if (strlen(token) == 0 || token[0] == '\r' || token[0] == '\n') {
-            token = strtok(NULL, " ()");
+            token = strtok_r(NULL, " ()", &estado);
             continue;
         }
 
@@ -100,18 +104,22 @@ ExprNode *parse_expressao(const char *expr) {
 
             root = and_node;
             current = and_node;
-            token = strtok(NULL, " ()");
+            token = strtok_r(NULL, " ()", &estado);
             continue;
         }
 
         // Lê campo, operador e valor da expressão
         if (sscanf(token, "%9[^=<>]%2[=<>]%19s", field, op_str, value) < 3) {
             fprintf(stderr, "Erro ao interpretar expressão: %s\n", token);
-            token = strtok(NULL, " ()");
+            token = strtok_r(NULL, " ()", &estado);
             continue;
         }
 
         OperatorType op = identificar_operador(op_str);
+        if (op == OP_INVALID) {
+            token = strtok_r(NULL, " ()", &estado);
+            continue;
+        }
         ExprNode *new_node = novo_no_expressao(field, op, value);
 
         if (!root) {
@@ -123,31 +131,163 @@ ExprNode *parse_expressao(const char *expr) {
         }
 
         current = new_node;
-        token = strtok(NULL, " ()");
+        token = strtok_r(NULL, " ()", &estado);
     }
 
     return root;
 }
 
 /**
- * Avalia a árvore de expressão e retorna os voos que atendem aos critérios.
+ * Converte um predicado folha no intervalo fechado de chaves do campo.
  */
-AVLNode *avaliar_expressao(const ExprNode *root) {
-    if (!root) return NULL;
+int converter_faixa_predicado(const ExprNode *no, FaixaPredicado *p) {
+    p->campo = strcmp(no->field, "dep") == 0 ? CAMPO_PARTIDA : campo_indice(no->field);
+    if (p->campo < 0) return 0;
 
-    // Se for operador &&, retorna interseção dos resultados das subárvores
-    if (root->operator == OP_AND) {
-        AVLNode *left_results = avaliar_expressao(root->left);
-        AVLNode *right_results = avaliar_expressao(root->right);
+    p->min = INT64_MIN;
+    p->max = INT64_MAX;
 
-        if (!left_results) return right_results;
-        if (!right_results) return left_results;
+    int64_t chave;
+    if (p->campo == CAMPO_ORIGEM || p->campo == CAMPO_DESTINO || p->campo == CAMPO_PARTIDA) {
+        // Aeroportos e datas comparam chaves inteiras exatas
+        if (p->campo == CAMPO_PARTIDA) chave = (int64_t)converter_datetime(no->value);
+        else chave = strlen(no->value) <= 3 ? chave_aeroporto(no->value) : -1;
+        if (chave < 0) {
+            p->min = 1;
+            p->max = 0;
+            return 1;
+        }
+        switch (no->operator) {
+            case OP_EQUAL: p->min = p->max = chave; break;
+            case OP_LESS: p->max = chave - 1; break;
+            case OP_LESS_EQUAL: p->max = chave; break;
+            case OP_GREATER: p->min = chave + 1; break;
+            case OP_GREATER_EQUAL: p->min = chave; break;
+            default: break;
+        }
+        return 1;
+    }
 
-        return intersect_avl_nodes(left_results, right_results);
+    // Valor numérico na escala da chave (centavos para o preço)
+    double valor = strtod(no->value, NULL) * (p->campo == CAMPO_PRECO ? 100 : 1);
+    if (fabs(valor - llround(valor)) < 1e-6) valor = (double)llround(valor);
+    int64_t piso = (int64_t)floor(valor), teto = (int64_t)ceil(valor);
+
+    switch (no->operator) {
+        case OP_EQUAL:
+            if (piso == teto) p->min = p->max = piso;
+            else { p->min = 1; p->max = 0; }
+            break;
+        case OP_LESS: p->max = teto - 1; break;
+        case OP_LESS_EQUAL: p->max = piso; break;
+        case OP_GREATER: p->min = piso + 1; break;
+        case OP_GREATER_EQUAL: p->min = teto; break;
+        default: break;
+    }
+    return 1;
+}
+
+static int converter_folhas(const ExprNode *no, FaixaPredicado *folhas, int *num, int max) {
+    if (!no) return 1;
+    if (no->operator == OP_AND) {
+        return converter_folhas(no->left, folhas, num, max) && converter_folhas(no->right, folhas, num, max);
+    }
+    if (*num >= max) return 1;
+    if (!converter_faixa_predicado(no, &folhas[*num])) {
+        fprintf(stderr, "Campo desconhecido na consulta: %s\n", no->field);
+        return 0;
+    }
+    (*num)++;
+    return 1;
+}
+
+/**
+ * Converte as folhas de uma conjunção, da esquerda para a direita.
+ */
+int converter_folhas_expressao(const ExprNode *root, FaixaPredicado *folhas, int max) {
+    int num = 0;
+    return converter_folhas(root, folhas, &num, max) ? num : -1;
+}
+
+/**
+ * Verifica se a folha é avaliada nos voos: a partida não tem índice e os
+ * campos fora do plano de índices não têm árvore construída.
+ */
+static int folha_residual(AVLTree *const arvores[], const FaixaPredicado *folha) {
+    return folha->campo == CAMPO_PARTIDA || arvores[folha->campo]->ausente;
+}
+
+/**
+ * Aplica as folhas sem índice lendo os voos: aos ids já selecionados pelos
+ * índices ou, se nenhuma folha foi indexada, a todos.
+ */
+static AVLNode *filtrar_residuais(AVLNode *acumulado, AVLTree *const arvores[], const FaixaPredicado *folhas,
+                                  int num, const Flight *voos, int n) {
+    int total = acumulado ? acumulado->num_indices : n;
+    int *indices = malloc((total ? total : 1) * sizeof(int));
+    if (!indices) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (acumulado) {
+        extrair_indices_no(acumulado, indices);
+        liberar_avl(acumulado);
+    } else {
+        for (int i = 0; i < n; i++) indices[i] = i;
+    }
+
+    int aprovados = 0;
+    for (int i = 0; i < total; i++) {
+        if (i % 4096 == 0 && verificar_prazo()) break;
+        int passa = 1;
+        for (int f = 0; f < num && passa; f++) {
+            if (!folha_residual(arvores, &folhas[f])) continue;
+            int64_t chave = chave_voo(&voos[indices[i]], folhas[f].campo);
+            passa = chave >= folhas[f].min && chave <= folhas[f].max;
+        }
+        if (passa) indices[aprovados++] = indices[i];
+    }
+    return criar_no_resultado(indices, aprovados);
+}
+
+static int comparar_faixas(const void *a, const void *b) {
+    long x = ((const FaixaAVL *)a)->total, y = ((const FaixaAVL *)b)->total;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Avalia a árvore de expressão e retorna os voos que atendem aos critérios.
+ * As faixas das folhas indexadas são coletadas antes (sem copiar listas) e
+ * interseccionadas da menor para a maior; uma folha sem resultados esvazia
+ * a conjunção. O nó retornado pertence ao chamador (liberar com liberar_avl).
+ */
+AVLNode *avaliar_expressao(AVLTree *const arvores[], const Flight *voos, int n, const ExprNode *root) {
+    FaixaPredicado folhas[MAX_FOLHAS_EXPRESSAO];
+    int num = root ? converter_folhas_expressao(root, folhas, MAX_FOLHAS_EXPRESSAO) : 0;
+    if (num <= 0) return NULL;
+
+    FaixaAVL faixas[MAX_FOLHAS_EXPRESSAO];
+    int indexadas = 0, vazia = 0;
+    for (int f = 0; f < num && !vazia; f++) {
+        if (folha_residual(arvores, &folhas[f])) continue;
+        buscar_faixa_avl(arvores[folhas[f].campo], &folhas[f], &faixas[indexadas]);
+        vazia = faixas[indexadas++].total == 0;
+    }
+
+    AVLNode *acumulado = NULL;
+    if (!vazia && indexadas > 0) {
+        qsort(faixas, indexadas, sizeof(FaixaAVL), comparar_faixas);
+        acumulado = materializar_faixa_avl(&faixas[0]);
+        for (int f = 1; f < indexadas && acumulado && !verificar_prazo(); f++) {
+            AVLNode *resultado = intersectar_faixa_avl(acumulado, &faixas[f]);
+            liberar_avl(acumulado);
+            acumulado = resultado;
+        }
     }
+    for (int f = 0; f < indexadas; f++) liberar_faixa_avl(&faixas[f]);
 
-    // Busca voos que correspondem ao critério na AVL
-    return buscar_avl_por_campo(root->field, root->value, root->operator);
+    if (vazia || indexadas == num || (indexadas > 0 && !acumulado)) return acumulado;
+    return filtrar_residuais(acumulado, arvores, folhas, num, voos, n);
 }
 
 /**
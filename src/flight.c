@@ -37,6 +37,29 @@ time_t converter_datetime(const char *datetime) {
 }
 
 
+/**
+ * Lê um único voo do arquivo de entrada.
+ * @param arquivo Ponteiro para o arquivo de entrada.
+ * @param voo Estrutura que recebe o voo lido.
+ * @return 1 se a leitura for bem-sucedida, 0 caso contrário.
+ */
+int ler_voo(FILE *arquivo, Flight *voo) {
+    char partida_str[30], chegada_str[30];
+
+    if (fscanf(arquivo, "%3s %3s %f %d %29s %29s %d",
+               voo->origem, voo->destino,
+               &voo->preco, &voo->assentos,
+               partida_str, chegada_str, &voo->paradas) != 7) {
+        return 0;
+    }
+
+    // Converte datas para timestamp
+    voo->partida = converter_datetime(partida_str);
+    voo->chegada = converter_datetime(chegada_str);
+    voo->duracao = (int)difftime(voo->chegada, voo->partida);
+    return 1;
+}
+
 /**
  * Lê os voos do arquivo de entrada e os armazena em um vetor.
  * @param arquivo Ponteiro para o arquivo de entrada (stdin).
@@ -59,20 +82,11 @@ void carregar_voos(FILE *arquivo, Flight **voos, int *n) {
 
     // Lê cada voo e armazena no vetor
     for (int i = 0; i < *n; i++) {
-        char partida_str[30], chegada_str[30];
-
-        if (fscanf(arquivo, "%s %s %f %d %s %s %d",
-                   (*voos)[i].origem, (*voos)[i].destino,
-                   &(*voos)[i].preco, &(*voos)[i].assentos,
-                   partida_str, chegada_str, &(*voos)[i].paradas) != 7) {
+        if (!ler_voo(arquivo, &(*voos)[i])) {
             fprintf(stderr, "Erro ao ler os dados do voo %d.\n", i + 1);
             exit(EXIT_FAILURE);
         }
-
-        // Converte datas para timestamp
-        (*voos)[i].partida = converter_datetime(partida_str);
-        (*voos)[i].chegada = converter_datetime(chegada_str);
-        (*voos)[i].duracao = (int)difftime((*voos)[i].chegada, (*voos)[i].partida);
+        (*voos)[i].id = i;
     }
 }
 
@@ -0,0 +1,487 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "itinerary.h"
+#include "avl.h"
+#include "profile.h"
+#include "deadline.h"
+
+/**
+ * Voo na construção da rede: chave de ordenação e posição no vetor.
+ */
+typedef struct {
+    int64_t aeroporto;
+    time_t partida;
+    int id;
+    int posicao;
+} EntradaRede;
+
+/**
+ * Itinerário parcial ou completo da busca. Os nós ficam numa arena e
+ * apontam para o anterior, então prefixos comuns são compartilhados.
+ */
+typedef struct {
+    int voo;            // Posição da última perna
+    int pai;            // Nó da perna anterior (-1 na primeira)
+    int pernas;
+    int completo;       // 1 se a última perna chega ao destino
+    double preco;
+    long duracao;       // Última chegada menos a primeira partida
+    int paradas;
+    time_t partida;     // Partida da primeira perna
+} NoBusca;
+
+/**
+ * Estado de uma busca: arena de nós, fila de prioridade (heap de mínimo pelo
+ * critério) e os k melhores completos já gerados (heap de máximo), que
+ * definem o corte.
+ */
+typedef struct {
+    const Flight *voos;
+    const char *trigrama;
+    int conexao_min;
+
+    NoBusca *nos;
+    int num_nos, cap_nos;
+
+    int *fila;
+    int tam_fila, cap_fila;
+
+    int *corte;         // Heap de máximo com até k completos
+    int tam_corte, k;
+} Busca;
+
+static void *realocar(void *ptr, size_t tamanho) {
+    void *novo = realloc(ptr, tamanho);
+    if (!novo) {
+        fprintf(stderr, "Erro ao alocar memória para a busca de itinerários.\n");
+        exit(EXIT_FAILURE);
+    }
+    return novo;
+}
+
+static int comparar_entradas_rede(const void *a, const void *b) {
+    const EntradaRede *x = a, *y = b;
+    if (x->aeroporto != y->aeroporto) return x->aeroporto > y->aeroporto ? 1 : -1;
+    if (x->partida != y->partida) return x->partida > y->partida ? 1 : -1;
+    return (x->id > y->id) - (x->id < y->id);
+}
+
+/**
+ * Constrói a rede de rotas: ordena os voos por (origem, partida, id) e
+ * registra onde começa cada aeroporto.
+ */
+RedeRotas *construir_rede_rotas(const Flight *voos, int n) {
+    RedeRotas *rede = calloc(1, sizeof(RedeRotas));
+    EntradaRede *entradas = malloc((n ? n : 1) * sizeof(EntradaRede));
+    if (!rede || !entradas) {
+        fprintf(stderr, "Erro ao alocar memória para a rede de rotas.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // A poda supõe que cada perna só aumenta o critério: voos que chegam antes
+    // de partir ou com preço ou paradas negativos ficam fora da rede
+    int m = 0;
+    for (int i = 0; i < n; i++) {
+        if (voos[i].chegada < voos[i].partida || voos[i].preco < 0 || voos[i].paradas < 0) continue;
+        entradas[m].aeroporto = chave_aeroporto(voos[i].origem);
+        entradas[m].partida = voos[i].partida;
+        entradas[m].id = voos[i].id;
+        entradas[m].posicao = i;
+        m++;
+    }
+    n = m;
+    qsort(entradas, n, sizeof(EntradaRede), comparar_entradas_rede);
+
+    int num = 0;
+    for (int i = 0; i < n; i++) {
+        if (i == 0 || entradas[i].aeroporto != entradas[i - 1].aeroporto) num++;
+    }
+    rede->num_aeroportos = num;
+    rede->aeroportos = malloc((num ? num : 1) * sizeof(int64_t));
+    rede->inicio = malloc((num + 1) * sizeof(int));
+    rede->voos = malloc((n ? n : 1) * sizeof(int));
+    rede->partidas = malloc((n ? n : 1) * sizeof(time_t));
+    if (!rede->aeroportos || !rede->inicio || !rede->voos || !rede->partidas) {
+        fprintf(stderr, "Erro ao alocar memória para a rede de rotas.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int a = -1;
+    for (int i = 0; i < n; i++) {
+        if (i == 0 || entradas[i].aeroporto != entradas[i - 1].aeroporto) {
+            a++;
+            rede->aeroportos[a] = entradas[i].aeroporto;
+            rede->inicio[a] = i;
+        }
+        rede->voos[i] = entradas[i].posicao;
+        rede->partidas[i] = entradas[i].partida;
+    }
+    rede->inicio[num] = n;
+
+    free(entradas);
+    return rede;
+}
+
+/**
+ * Libera a rede de rotas.
+ */
+void liberar_rede_rotas(RedeRotas *rede) {
+    if (!rede) return;
+    free(rede->aeroportos);
+    free(rede->inicio);
+    free(rede->voos);
+    free(rede->partidas);
+    free(rede);
+}
+
+/**
+ * Índice do aeroporto na rede, ou -1 se nenhum voo parte dele.
+ */
+static int buscar_aeroporto(const RedeRotas *rede, int64_t aeroporto) {
+    int ini = 0, fim = rede->num_aeroportos - 1;
+    while (ini <= fim) {
+        int meio = (ini + fim) / 2;
+        if (rede->aeroportos[meio] == aeroporto) return meio;
+        if (rede->aeroportos[meio] < aeroporto) ini = meio + 1;
+        else fim = meio - 1;
+    }
+    return -1;
+}
+
+/**
+ * Primeira posição em [ini, fim) cuja partida é maior ou igual a `instante`.
+ */
+static int primeira_partida(const RedeRotas *rede, int ini, int fim, time_t instante) {
+    while (ini < fim) {
+        int meio = (ini + fim) / 2;
+        if (rede->partidas[meio] < instante) ini = meio + 1;
+        else fim = meio;
+    }
+    return ini;
+}
+
+static int codigo_aeroporto_valido(const char *codigo) {
+    if (strlen(codigo) != 3) return 0;
+    for (int i = 0; i < 3; i++) {
+        if (!isupper((unsigned char)codigo[i])) return 0;
+    }
+    return 1;
+}
+
+static int data_valida(const char *texto) {
+    int ano, mes, dia, hora, minuto, segundo, lidos = 0;
+    return sscanf(texto, "%d-%d-%dT%d:%d:%d%n", &ano, &mes, &dia, &hora, &minuto, &segundo, &lidos) == 6 &&
+           texto[lidos] == '\0';
+}
+
+/**
+ * Interpreta os parâmetros de uma consulta itn.
+ * @param texto Parâmetros no formato "org dst início fim pernas [conexão]".
+ * @param consulta Estrutura que recebe os parâmetros.
+ * @return 1 se os parâmetros forem válidos, 0 caso contrário.
+ */
+int interpretar_itinerario(const char *texto, ConsultaItinerario *consulta) {
+    char origem[8], destino[8], inicio[32], fim[32];
+    int max_pernas, conexao = ITINERARIO_CONEXAO_PADRAO, lidos = 0;
+
+    if (sscanf(texto, " %7s %7s %31s %31s %d%n", origem, destino, inicio, fim, &max_pernas, &lidos) != 5) return 0;
+    texto += lidos;
+    if (sscanf(texto, " %d%n", &conexao, &lidos) == 1) texto += lidos;
+    while (isspace((unsigned char)*texto)) texto++;
+    if (*texto != '\0') return 0;
+
+    if (!codigo_aeroporto_valido(origem) || !codigo_aeroporto_valido(destino) || strcmp(origem, destino) == 0 ||
+        !data_valida(inicio) || !data_valida(fim) || max_pernas < 1 || max_pernas > ITINERARIO_MAX_PERNAS ||
+        conexao < 0) {
+        return 0;
+    }
+
+    consulta->origem = chave_aeroporto(origem);
+    consulta->destino = chave_aeroporto(destino);
+    consulta->partida_min = converter_datetime(inicio);
+    consulta->partida_max = converter_datetime(fim);
+    consulta->max_pernas = max_pernas;
+    consulta->conexao_min = conexao * 60;
+    return 1;
+}
+
+/**
+ * Ids (ordem de entrada) das pernas de um nó, em ordem de viagem.
+ * @return Quantidade de pernas.
+ */
+static int pernas_no(const Busca *b, int no, int *ids) {
+    int pernas = b->nos[no].pernas;
+    for (int i = pernas - 1; i >= 0; i--) {
+        ids[i] = b->voos[b->nos[no].voo].id;
+        no = b->nos[no].pai;
+    }
+    return pernas;
+}
+
+/**
+ * Compara dois nós pelo trigrama, como comparar_voos: preço, duração e
+ * paradas. Um parcial entra pelo limite inferior dos itinerários que ele
+ * ainda pode gerar (mais uma conexão e uma parada); empates saem pela
+ * sequência das pernas na ordem de entrada, com um prefixo antes das suas
+ * extensões, então nenhum completo derivado de um parcial o precede.
+ */
+static int comparar_nos(const Busca *b, int x, int y) {
+    const NoBusca *a = &b->nos[x], *c = &b->nos[y];
+    long duracao_a = a->duracao + (a->completo ? 0 : b->conexao_min);
+    long duracao_c = c->duracao + (c->completo ? 0 : b->conexao_min);
+    int paradas_a = a->paradas + (a->completo ? 0 : 1);
+    int paradas_c = c->paradas + (c->completo ? 0 : 1);
+
+    for (int i = 0; i < 3; i++) {
+        switch (b->trigrama[i]) {
+            case 'p':
+                if (a->preco != c->preco) return a->preco > c->preco ? 1 : -1;
+                break;
+            case 'd':
+                if (duracao_a != duracao_c) return duracao_a > duracao_c ? 1 : -1;
+                break;
+            case 's':
+                if (paradas_a != paradas_c) return paradas_a > paradas_c ? 1 : -1;
+                break;
+        }
+    }
+
+    int ids_a[ITINERARIO_MAX_PERNAS], ids_c[ITINERARIO_MAX_PERNAS];
+    int na = pernas_no(b, x, ids_a), nc = pernas_no(b, y, ids_c);
+    for (int i = 0; i < na && i < nc; i++) {
+        if (ids_a[i] != ids_c[i]) return ids_a[i] > ids_c[i] ? 1 : -1;
+    }
+    return (na > nc) - (na < nc);
+}
+
+/**
+ * Sobe ou desce um elemento de um heap; `sinal` 1 para mínimo, -1 para máximo.
+ */
+static void subir_heap(const Busca *b, int *heap, int i, int sinal) {
+    while (i > 0) {
+        int pai = (i - 1) / 2;
+        if (sinal * comparar_nos(b, heap[i], heap[pai]) >= 0) break;
+        int temp = heap[i];
+        heap[i] = heap[pai];
+        heap[pai] = temp;
+        i = pai;
+    }
+}
+
+static void descer_heap(const Busca *b, int *heap, int tamanho, int i, int sinal) {
+    for (;;) {
+        int menor = i, esq = 2 * i + 1, dir = 2 * i + 2;
+        if (esq < tamanho && sinal * comparar_nos(b, heap[esq], heap[menor]) < 0) menor = esq;
+        if (dir < tamanho && sinal * comparar_nos(b, heap[dir], heap[menor]) < 0) menor = dir;
+        if (menor == i) return;
+        int temp = heap[i];
+        heap[i] = heap[menor];
+        heap[menor] = temp;
+        i = menor;
+    }
+}
+
+/**
+ * Acrescenta uma perna a um nó (ou inicia um itinerário, com pai -1) e o põe
+ * na fila, a menos que ele não possa superar o k-ésimo completo já gerado.
+ */
+static void estender(Busca *b, int pai, int voo, int64_t destino) {
+    if (b->num_nos == b->cap_nos) {
+        b->cap_nos = b->cap_nos ? 2 * b->cap_nos : 1024;
+        b->nos = realocar(b->nos, b->cap_nos * sizeof(NoBusca));
+    }
+    const Flight *v = &b->voos[voo];
+    int no = b->num_nos;
+    NoBusca *novo = &b->nos[no];
+    novo->voo = voo;
+    novo->pai = pai;
+    novo->completo = chave_aeroporto(v->destino) == destino;
+    if (pai < 0) {
+        novo->pernas = 1;
+        novo->preco = v->preco;
+        novo->paradas = v->paradas;
+        novo->partida = v->partida;
+    } else {
+        const NoBusca *anterior = &b->nos[pai];
+        novo->pernas = anterior->pernas + 1;
+        novo->preco = anterior->preco + v->preco;
+        novo->paradas = anterior->paradas + v->paradas + 1;
+        novo->partida = anterior->partida;
+    }
+    novo->duracao = (long)(v->chegada - novo->partida);
+
+    if (b->tam_corte == b->k && comparar_nos(b, no, b->corte[0]) > 0) return;
+    b->num_nos++;
+
+    if (novo->completo) {
+        if (b->tam_corte < b->k) {
+            b->corte[b->tam_corte] = no;
+            subir_heap(b, b->corte, b->tam_corte++, -1);
+        } else {
+            b->corte[0] = no;
+            descer_heap(b, b->corte, b->tam_corte, 0, -1);
+        }
+    }
+
+    if (b->tam_fila == b->cap_fila) {
+        b->cap_fila = b->cap_fila ? 2 * b->cap_fila : 1024;
+        b->fila = realocar(b->fila, b->cap_fila * sizeof(int));
+    }
+    b->fila[b->tam_fila] = no;
+    subir_heap(b, b->fila, b->tam_fila++, 1);
+}
+
+/**
+ * Verifica se o aeroporto já está no caminho do nó (origens das pernas).
+ */
+static int aeroporto_no_caminho(const Busca *b, int no, const char *aeroporto) {
+    for (; no >= 0; no = b->nos[no].pai) {
+        if (strcmp(b->voos[b->nos[no].voo].origem, aeroporto) == 0) return 1;
+    }
+    return 0;
+}
+
+/**
+ * Busca os `k` melhores itinerários pelo trigrama.
+ */
+int buscar_itinerarios(const RedeRotas *rede, const Flight *voos, const ConsultaItinerario *consulta,
+                       const char *trigrama, int k, Itinerario **resultados) {
+    *resultados = malloc((k > 0 ? k : 1) * sizeof(Itinerario));
+    if (!*resultados) {
+        fprintf(stderr, "Erro ao alocar memória para a busca de itinerários.\n");
+        exit(EXIT_FAILURE);
+    }
+    int origem = rede ? buscar_aeroporto(rede, consulta->origem) : -1;
+    if (k <= 0 || origem < 0 || consulta->partida_min > consulta->partida_max) return 0;
+
+    Busca b;
+    memset(&b, 0, sizeof(b));
+    b.voos = voos;
+    b.trigrama = trigrama;
+    b.conexao_min = consulta->conexao_min;
+    b.k = k;
+    b.corte = malloc(k * sizeof(int));
+    if (!b.corte) {
+        fprintf(stderr, "Erro ao alocar memória para a busca de itinerários.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Primeiras pernas: partidas da origem dentro da janela
+    int fim = rede->inicio[origem + 1];
+    for (int i = primeira_partida(rede, rede->inicio[origem], fim, consulta->partida_min);
+         i < fim && rede->partidas[i] <= consulta->partida_max; i++) {
+        int voo = rede->voos[i];
+        if (consulta->max_pernas > 1 || chave_aeroporto(voos[voo].destino) == consulta->destino) {
+            estender(&b, -1, voo, consulta->destino);
+        }
+    }
+
+    int encontrados = 0;
+    while (b.tam_fila > 0 && encontrados < k && !prazo_esgotado()) {
+        int no = b.fila[0];
+        b.fila[0] = b.fila[--b.tam_fila];
+        descer_heap(&b, b.fila, b.tam_fila, 0, 1);
+
+        NoBusca atual = b.nos[no];
+        if (atual.completo) {
+            Itinerario *it = &(*resultados)[encontrados++];
+            it->num_pernas = atual.pernas;
+            for (int i = atual.pernas - 1, p = no; i >= 0; i--, p = b.nos[p].pai) {
+                it->pernas[i] = b.nos[p].voo;
+            }
+            it->preco = atual.preco;
+            it->duracao = atual.duracao;
+            it->paradas = atual.paradas;
+            continue;
+        }
+
+        // Conexões: partidas do aeroporto de chegada dentro da janela de espera
+        const Flight *ultimo = &voos[atual.voo];
+        int a = buscar_aeroporto(rede, chave_aeroporto(ultimo->destino));
+        if (a < 0) continue;
+        int ultima_perna = atual.pernas + 1 == consulta->max_pernas;
+        time_t limite = ultimo->chegada + ITINERARIO_ESPERA_MAXIMA;
+        fim = rede->inicio[a + 1];
+        for (int i = primeira_partida(rede, rede->inicio[a], fim, ultimo->chegada + b.conexao_min);
+             i < fim && rede->partidas[i] <= limite; i++) {
+            int voo = rede->voos[i];
+            if (ultima_perna && chave_aeroporto(voos[voo].destino) != consulta->destino) continue;
+            if (aeroporto_no_caminho(&b, no, voos[voo].destino)) continue;
+            estender(&b, no, voo, consulta->destino);
+        }
+    }
+
+    free(b.nos);
+    free(b.fila);
+    free(b.corte);
+    return encontrados;
+}
+
+/**
+ * Resume um itinerário no formato de um voo.
+ */
+void resumir_itinerario(const Flight *voos, const Itinerario *itinerario, Flight *resumo) {
+    const Flight *ultimo = &voos[itinerario->pernas[itinerario->num_pernas - 1]];
+    *resumo = voos[itinerario->pernas[0]];
+    memcpy(resumo->destino, ultimo->destino, MAX_DESTINO);
+    resumo->preco = (float)itinerario->preco;
+    resumo->chegada = ultimo->chegada;
+    resumo->duracao = (int)itinerario->duracao;
+    resumo->paradas = itinerario->paradas;
+    // Assentos: o gargalo entre as pernas
+    for (int p = 1; p < itinerario->num_pernas; p++) {
+        if (voos[itinerario->pernas[p]].assentos < resumo->assentos) resumo->assentos = voos[itinerario->pernas[p]].assentos;
+    }
+}
+
+/**
+ * Escreve os itinerários encontrados (sem a linha da consulta).
+ */
+int imprimir_itinerarios(Saida *saida, const Flight *voos, const Itinerario *itinerarios, int num) {
+    int linhas = 0;
+    for (int i = 0; i < num; i++) {
+        const Itinerario *it = &itinerarios[i];
+        Flight resumo;
+        resumir_itinerario(voos, it, &resumo);
+        imprimir_voo(saida, &resumo);
+
+        for (int p = 0; p < it->num_pernas; p++) {
+            escrever_saida(saida, "  ", 2);
+            imprimir_voo(saida, &voos[it->pernas[p]]);
+        }
+        linhas += 1 + it->num_pernas;
+    }
+    return linhas;
+}
+
+/**
+ * Interpreta os parâmetros de uma consulta itn e busca os itinerários.
+ */
+int executar_itinerarios(const RedeRotas *rede, const Flight *voos, const Query *consulta, Itinerario **resultados) {
+    ConsultaItinerario parametros;
+    if (!interpretar_itinerario(consulta->expressao, &parametros)) {
+        *resultados = NULL;
+        return 0;
+    }
+    return buscar_itinerarios(rede, voos, &parametros, consulta->trigrama, consulta->max_voos, resultados);
+}
+
+/**
+ * Responde uma consulta itn.
+ */
+int responder_itinerarios(Saida *saida, const RedeRotas *rede, const Flight *voos, const Query *consulta) {
+    Itinerario *itinerarios;
+    entrar_fase(FASE_AVALIACAO);
+    int num = executar_itinerarios(rede, voos, consulta, &itinerarios);
+    sair_fase();
+
+    entrar_fase(FASE_SAIDA);
+    imprimir_consulta(saida, consulta);
+    int linhas = 1 + imprimir_itinerarios(saida, voos, itinerarios, num);
+    sair_fase();
+
+    free(itinerarios);
+    return linhas;
+}
@@ -0,0 +1,287 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lsm.h"
+#include "shard.h"
+#include "epoch.h"
+#include "cursor.h"
+
+/**
+ * Cria um segmento vazio com capacidade para `capacidade` voos.
+ */
+static Segmento *criar_segmento(int capacidade, int primeiro_id) {
+    Segmento *segmento = calloc(1, sizeof(Segmento));
+    if (!segmento) {
+        fprintf(stderr, "Erro ao alocar memória para o segmento.\n");
+        exit(EXIT_FAILURE);
+    }
+    segmento->voos = malloc((capacidade > 0 ? capacidade : 1) * sizeof(Flight));
+    if (!segmento->voos) {
+        fprintf(stderr, "Erro ao alocar memória para o segmento.\n");
+        exit(EXIT_FAILURE);
+    }
+    segmento->capacidade = capacidade;
+    segmento->primeiro_id = primeiro_id;
+    for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+        segmento->arvores[f] = criar_avl();
+    }
+    return segmento;
+}
+
+/**
+ * Libera um segmento, seus voos e índices (assinatura compatível com aposentar).
+ */
+static void liberar_segmento(void *ptr) {
+    Segmento *segmento = ptr;
+    for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+        liberar_avl(segmento->arvores[f]->raiz);
+        free(segmento->arvores[f]);
+    }
+    free(segmento->voos);
+    free(segmento);
+}
+
+/**
+ * Aloca uma lista de segmentos com `num` posições.
+ */
+static ListaSegmentos *criar_lista(int num) {
+    ListaSegmentos *lista = malloc(sizeof(ListaSegmentos) + num * sizeof(Segmento *));
+    if (!lista) {
+        fprintf(stderr, "Erro ao alocar memória para a lista de segmentos.\n");
+        exit(EXIT_FAILURE);
+    }
+    lista->num_segmentos = num;
+    return lista;
+}
+
+/**
+ * Publica uma nova versão da lista e aposenta a anterior. Chamada com a trava.
+ */
+static void publicar_lista(TabelaLSM *tabela, ListaSegmentos *nova) {
+    ListaSegmentos *antiga = atomic_load_explicit(&tabela->lista, memory_order_relaxed);
+    atomic_store_explicit(&tabela->lista, nova, memory_order_release);
+    aposentar(antiga, free);
+}
+
+/**
+ * Procura LSM_FATOR_MESCLA segmentos selados consecutivos do mesmo nível.
+ * @return Posição do primeiro da sequência, ou -1 se não houver.
+ */
+static int encontrar_mescla(const ListaSegmentos *lista) {
+    int selados = lista->num_segmentos - 1;  // O último é o mutável
+    for (int i = 0; i + LSM_FATOR_MESCLA <= selados; i++) {
+        int j = 1;
+        while (j < LSM_FATOR_MESCLA && lista->segmentos[i + j]->nivel == lista->segmentos[i]->nivel) j++;
+        if (j == LSM_FATOR_MESCLA) return i;
+    }
+    return -1;
+}
+
+/**
+ * Concatena segmentos selados consecutivos num novo segmento, com índices
+ * construídos em lote.
+ */
+static Segmento *mesclar_segmentos(Segmento *const *segmentos, int num) {
+    int total = 0;
+    for (int i = 0; i < num; i++) total += segmentos[i]->n;
+
+    Segmento *mesclado = criar_segmento(total, segmentos[0]->primeiro_id);
+    int pos = 0;
+    for (int i = 0; i < num; i++) {
+        memcpy(mesclado->voos + pos, segmentos[i]->voos, segmentos[i]->n * sizeof(Flight));
+        pos += segmentos[i]->n;
+    }
+    mesclado->n = total;
+    mesclado->nivel = segmentos[0]->nivel + 1;
+    construir_arvores_indices(mesclado->arvores, mesclado->voos, total);
+    return mesclado;
+}
+
+/**
+ * Thread de mescla: a cada segmento selado, mescla as sequências de
+ * segmentos do mesmo nível. A construção acontece fora da trava; só a troca
+ * da lista é serializada com a ingestão.
+ */
+static void *executar_mesclador(void *arg) {
+    TabelaLSM *tabela = arg;
+
+    pthread_mutex_lock(&tabela->trava);
+    while (1) {
+        while (!tabela->mescla_pendente && !tabela->encerrar) {
+            pthread_cond_wait(&tabela->tem_mescla, &tabela->trava);
+        }
+        if (tabela->encerrar) break;
+        tabela->mescla_pendente = 0;
+
+        while (!tabela->encerrar) {
+            ListaSegmentos *lista = atomic_load(&tabela->lista);
+            int inicio = encontrar_mescla(lista);
+            if (inicio < 0) break;
+
+            // Segmentos selados são imutáveis e só esta thread os remove
+            Segmento *origem[LSM_FATOR_MESCLA];
+            memcpy(origem, &lista->segmentos[inicio], sizeof(origem));
+
+            pthread_mutex_unlock(&tabela->trava);
+            Segmento *mesclado = mesclar_segmentos(origem, LSM_FATOR_MESCLA);
+            pthread_mutex_lock(&tabela->trava);
+
+            // Segmentos selados depois ficam à direita; a posição da sequência não muda
+            lista = atomic_load(&tabela->lista);
+            ListaSegmentos *nova = criar_lista(lista->num_segmentos - LSM_FATOR_MESCLA + 1);
+            memcpy(nova->segmentos, lista->segmentos, inicio * sizeof(Segmento *));
+            nova->segmentos[inicio] = mesclado;
+            memcpy(nova->segmentos + inicio + 1, lista->segmentos + inicio + LSM_FATOR_MESCLA,
+                   (lista->num_segmentos - inicio - LSM_FATOR_MESCLA) * sizeof(Segmento *));
+            publicar_lista(tabela, nova);
+
+            for (int i = 0; i < LSM_FATOR_MESCLA; i++) aposentar(origem[i], liberar_segmento);
+            recolher_aposentados();
+        }
+    }
+    pthread_mutex_unlock(&tabela->trava);
+    return NULL;
+}
+
+/**
+ * Cria uma tabela vazia e inicia a thread de mescla.
+ */
+TabelaLSM *criar_tabela_lsm(int num_threads) {
+    TabelaLSM *tabela = calloc(1, sizeof(TabelaLSM));
+    if (!tabela) {
+        fprintf(stderr, "Erro ao alocar memória para a tabela.\n");
+        exit(EXIT_FAILURE);
+    }
+    ListaSegmentos *lista = criar_lista(1);
+    lista->segmentos[0] = criar_segmento(LSM_CAPACIDADE_SEGMENTO, 0);
+    atomic_init(&tabela->lista, lista);
+
+    tabela->pool = criar_pool(num_threads);
+    pthread_mutex_init(&tabela->trava, NULL);
+    pthread_cond_init(&tabela->tem_mescla, NULL);
+    if (pthread_create(&tabela->mesclador, NULL, executar_mesclador, tabela) != 0) {
+        fprintf(stderr, "Erro ao criar a thread de mescla.\n");
+        exit(EXIT_FAILURE);
+    }
+    return tabela;
+}
+
+/**
+ * Encerra a thread de mescla e libera a tabela e os seus segmentos.
+ */
+void liberar_tabela_lsm(TabelaLSM *tabela) {
+    if (!tabela) return;
+
+    pthread_mutex_lock(&tabela->trava);
+    tabela->encerrar = 1;
+    pthread_cond_signal(&tabela->tem_mescla);
+    pthread_mutex_unlock(&tabela->trava);
+    pthread_join(tabela->mesclador, NULL);
+
+    // Sem leitores restantes: tudo o que foi aposentado pode ser liberado
+    recolher_aposentados();
+    ListaSegmentos *lista = atomic_load(&tabela->lista);
+    for (int i = 0; i < lista->num_segmentos; i++) liberar_segmento(lista->segmentos[i]);
+    free(lista);
+
+    destruir_pool(tabela->pool);
+    pthread_mutex_destroy(&tabela->trava);
+    pthread_cond_destroy(&tabela->tem_mescla);
+    free(tabela);
+}
+
+/**
+ * Anexa um voo ao segmento mutável e o sela quando ele enche.
+ */
+int inserir_voo_lsm(TabelaLSM *tabela, const Flight *voo) {
+    pthread_mutex_lock(&tabela->trava);
+
+    ListaSegmentos *lista = atomic_load_explicit(&tabela->lista, memory_order_relaxed);
+    Segmento *mutavel = lista->segmentos[lista->num_segmentos - 1];
+    int local = mutavel->n;
+
+    // O voo é escrito antes de qualquer raiz que o alcance ser publicada
+    int id = tabela->proximo_id++;
+    Flight *destino = &mutavel->voos[local];
+    *destino = *voo;
+    destino->id = id;
+
+    for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+        char chave[TAM_CHAVE_INDICE];
+        formatar_chave_indice(destino, (CampoIndice)f, chave);
+        AVLNode *raiz = atomic_load_explicit(&mutavel->arvores[f]->raiz, memory_order_relaxed);
+        atomic_store_explicit(&mutavel->arvores[f]->raiz,
+                              inserir_avl_cow(raiz, chave, local, mutavel->voos), memory_order_release);
+    }
+    atomic_store_explicit(&mutavel->n, local + 1, memory_order_release);
+
+    // Segmento cheio: sela e abre um novo mutável
+    if (local + 1 == mutavel->capacidade) {
+        ListaSegmentos *nova = criar_lista(lista->num_segmentos + 1);
+        memcpy(nova->segmentos, lista->segmentos, lista->num_segmentos * sizeof(Segmento *));
+        nova->segmentos[lista->num_segmentos] = criar_segmento(LSM_CAPACIDADE_SEGMENTO, tabela->proximo_id);
+        publicar_lista(tabela, nova);
+
+        tabela->mescla_pendente = 1;
+        pthread_cond_signal(&tabela->tem_mescla);
+    }
+
+    recolher_aposentados();
+    pthread_mutex_unlock(&tabela->trava);
+    return id;
+}
+
+/**
+ * Executa uma consulta sobre os segmentos da versão vigente da lista.
+ */
+void responder_consulta_lsm(TabelaLSM *tabela, const Query *consulta, Saida *saida) {
+    entrar_epoca();
+    ListaSegmentos *lista = atomic_load_explicit(&tabela->lista, memory_order_acquire);
+
+    // Cada segmento é uma fatia; o segmento mutável entra com o tamanho visível agora
+    ConjuntoFatias conjunto;
+    conjunto.num_fatias = lista->num_segmentos;
+    conjunto.pool = tabela->pool;
+    conjunto.fatias = malloc(lista->num_segmentos * sizeof(Fatia));
+    if (!conjunto.fatias) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < lista->num_segmentos; i++) {
+        Segmento *segmento = lista->segmentos[i];
+        conjunto.fatias[i].voos = segmento->voos;
+        conjunto.fatias[i].n = atomic_load_explicit(&segmento->n, memory_order_acquire);
+        memcpy(conjunto.fatias[i].arvores, segmento->arvores, sizeof(segmento->arvores));
+    }
+
+    imprimir_consulta(saida, consulta);
+    if (consulta->agregacao == CONSULTA_ITINERARIO) {
+        fprintf(stderr, "Consultas itn não são suportadas no modo LSM.\n");
+    } else if (consulta->agregacao != AGREGACAO_NENHUMA) {
+        AgregadoPreco agregado;
+        agregar_consulta_fatias(&conjunto, consulta, &agregado);
+        imprimir_agregacao(saida, consulta, &agregado);
+    } else {
+        const Flight **melhores;
+        int num = responder_consulta_fatias(&conjunto, consulta, &melhores);
+        int impressos = num < consulta->max_voos ? num : consulta->max_voos;
+        for (int j = 0; j < impressos; j++) {
+            imprimir_voo(saida, melhores[j]);
+        }
+        imprimir_cursor(saida, consulta, impressos > 0 ? melhores[impressos - 1] : NULL, num > impressos);
+        free(melhores);
+    }
+
+    free(conjunto.fatias);
+    sair_epoca();
+}
+
+/**
+ * Número de segmentos da versão publicada (incluindo o mutável).
+ */
+int num_segmentos_lsm(TabelaLSM *tabela) {
+    entrar_epoca();
+    int num = atomic_load(&tabela->lista)->num_segmentos;
+    sair_epoca();
+    return num;
+}
@@ -1,93 +1,519 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include "flight.h"
 #include "query.h"
 #include "sort.h"
+#include "output.h"
+#include "server.h"
+#include "pipeline.h"
+#include "ooc.h"
+#include "shard.h"
+#include "lsm.h"
+#include "scan.h"
+#include "executor.h"
+#include "itinerary.h"
+#include "cursor.h"
+#include "output_binary.h"
+#include "capture.h"
+#include "profile.h"
+#include "thread_pool.h"
+#include "advisor.h"
 
+/**
+ * Exibe a forma de uso do programa.
+ */
+static void imprimir_uso(const char *programa)
+{
+    fprintf(stderr, "Uso: %s [opções] <arquivo_de_entrada>\n", programa);
+    fprintf(stderr, "  --server=<socket>   Mantém os dados residentes e atende consultas num socket Unix\n");
+    fprintf(stderr, "  --server=-          Atende consultas pela entrada padrão\n");
+    fprintf(stderr, "  --deadline=<ms>     Prazo de cada consulta do servidor; ao esgotar, a resposta é TIMEOUT\n");
+    fprintf(stderr, "  --max-expensive=<n> Consultas caras (pelo custo estimado) em andamento ao mesmo tempo no servidor\n");
+    fprintf(stderr, "  --pipeline          Sobrepõe leitura, execução e saída das consultas em threads\n");
+    fprintf(stderr, "  --threads=<n>       Threads para construir os índices (padrão: processadores disponíveis)\n");
+    fprintf(stderr, "  --shards=<n>        Particiona os voos em <n> fatias e executa cada consulta em paralelo entre elas\n");
+    fprintf(stderr, "  --lsm               Ingere os voos num log de segmentos (aceita linhas \"add <voo>\" entre as consultas)\n");
+    fprintf(stderr, "  --engine=<motor>    Motor de execução: index (padrão), scan (varredura com mapas de zonas, sem índices),\n");
+    fprintf(stderr, "                      auto (escolhe por consulta pelo custo estimado) ou verify (index e scan, aborta se divergirem)\n");
+    fprintf(stderr, "  --scan              O mesmo que --engine=scan\n");
+    fprintf(stderr, "  --batch=<n>         Varredura compartilhada: responde cada <n> consultas numa única passagem (implica --engine=scan)\n");
+    fprintf(stderr, "  --cluster=<route|date>  Reagrupa a ordem de carga dos voos por rota ou por data de partida\n");
+    fprintf(stderr, "  --postings=compressed  Guarda as listas de índices em blocos comprimidos (padrão: raw)\n");
+    fprintf(stderr, "  --index-budget=<MiB>   Constrói só os índices (e representações) que cabem em <MiB> e mais reduzem o custo\n");
+    fprintf(stderr, "  --workload=<arquivo>   Amostra de consultas (texto ou log de --capture) que orienta a escolha dos índices\n");
+    fprintf(stderr, "  --ooc-build=<dir>   Constrói o armazém externo em <dir> e responde as consultas a partir dele\n");
+    fprintf(stderr, "  --ooc=<dir>         Responde as consultas do arquivo (só consultas) usando o armazém em <dir>\n");
+    fprintf(stderr, "  --ooc-mem=<MiB>     Memória para a construção do armazém externo (padrão 256)\n");
+    fprintf(stderr, "  --profile           Mede contadores de hardware por fase (carga, índices, parse, avaliação, ordenação, saída)\n");
+    fprintf(stderr, "  --output=binary     Escreve os resultados num fluxo binário de registros (ver tp3-binread)\n");
+    fprintf(stderr, "  --capture=<arquivo> Grava cada consulta executada, com chegada e latência, num log binário (ver tp3-replay)\n");
+}
+
+/**
+ * Responde as consultas do arquivo usando o armazém externo, construindo-o
+ * antes a partir dos voos do mesmo arquivo quando solicitado.
+ */
+static int executar_externo(FILE *entrada, const char *diretorio, int construir, size_t memoria)
+{
+    if (construir)
+    {
+        int num_voos;
+        if (fscanf(entrada, "%d", &num_voos) != 1)
+        {
+            fprintf(stderr, "Erro ao ler o número de voos.\n");
+            return EXIT_FAILURE;
+        }
+        if (!construir_armazem_externo(entrada, num_voos, diretorio, memoria))
+            return EXIT_FAILURE;
+    }
 
-void imprimir_voo(Flight voo) {
-    char partida_str[20], chegada_str[20];
-
-    // Converter timestamps para strings formatadas
-    formatar_data(voo.partida, partida_str);
-    formatar_data(voo.chegada, chegada_str);
-
-    // Ajuste na formatação do preço
-    double preco = voo.preco;
-    int preco_inteiro = (int)preco;  // Parte inteira do preço
-    int centavos = (int)(preco * 100) % 100;  // Obtém os dois últimos dígitos decimais (centavos)
-
-    if (centavos == 0) {
-        // Se não houver centavos, imprime como um número inteiro
-        printf("%s %s %.0f %d %s %s %d\n",
-               voo.origem, voo.destino,
-               preco, voo.assentos,
-               partida_str, chegada_str,
-               voo.paradas);
-    } else {
-        // Converte para string e remove zero desnecessário no final
-        char preco_formatado[10];
-        snprintf(preco_formatado, sizeof(preco_formatado), "%.2f", preco);
-
-        // Remove zero final se necessário
-        if (preco_formatado[strlen(preco_formatado) - 1] == '0') {
-            preco_formatado[strlen(preco_formatado) - 1] = '\0';
-        }
-        printf("%s %s %s %d %s %s %d\n",
-               voo.origem, voo.destino,
-               preco_formatado, voo.assentos,
-               partida_str, chegada_str,
-               voo.paradas);
+    ArmazemExterno *armazem = abrir_armazem_externo(diretorio);
+    if (!armazem)
+        return EXIT_FAILURE;
+
+    int num_consultas;
+    if (fscanf(entrada, "%d", &num_consultas) != 1)
+    {
+        // Construção sem consultas no arquivo não é erro
+        fechar_armazem_externo(armazem);
+        return construir ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    Saida *saida = criar_saida(STDOUT_FILENO, SAIDA_CAPACIDADE_PADRAO);
+    int status = EXIT_SUCCESS;
+    for (int i = 0; i < num_consultas; i++)
+    {
+        Query consulta;
+        if (!carregar_consulta(entrada, &consulta))
+        {
+            status = EXIT_FAILURE;
+            break;
+        }
+        responder_consulta_externa(armazem, &consulta, saida);
     }
+
+    liberar_saida(saida);
+    fechar_armazem_externo(armazem);
+    return status;
 }
 
+/**
+ * Ingere os voos do arquivo, um a um, numa tabela LSM e responde as consultas
+ * sobre ela. Entre as consultas, uma linha "add <voo>" (mesmo formato das
+ * linhas de voo) ingere mais um voo; ela conta como uma das linhas de consulta
+ * e não produz saída.
+ */
+static int executar_lsm(FILE *entrada, int num_threads)
+{
+    int num_voos;
+    if (fscanf(entrada, "%d", &num_voos) != 1)
+    {
+        fprintf(stderr, "Erro ao ler o número de voos.\n");
+        return EXIT_FAILURE;
+    }
+
+    TabelaLSM *tabela = criar_tabela_lsm(num_threads > 0 ? num_threads : processadores_disponiveis());
+    for (int i = 0; i < num_voos; i++)
+    {
+        Flight voo;
+        if (!ler_voo(entrada, &voo))
+        {
+            fprintf(stderr, "Erro ao ler os dados do voo %d.\n", i + 1);
+            liberar_tabela_lsm(tabela);
+            return EXIT_FAILURE;
+        }
+        inserir_voo_lsm(tabela, &voo);
+    }
+
+    int num_consultas;
+    if (fscanf(entrada, "%d", &num_consultas) != 1)
+    {
+        fprintf(stderr, "Erro ao ler o número de consultas.\n");
+        liberar_tabela_lsm(tabela);
+        return EXIT_FAILURE;
+    }
+
+    Saida *saida = criar_saida(STDOUT_FILENO, SAIDA_CAPACIDADE_PADRAO);
+    int status = EXIT_SUCCESS;
+    for (int i = 0; i < num_consultas; i++)
+    {
+        // Linhas de ingestão começam com "add"; consultas, com um número ou palavra-chave
+        int c;
+        if (fscanf(entrada, " ") == EOF || (c = fgetc(entrada)) == EOF)
+        {
+            fprintf(stderr, "Erro ao ler a consulta.\n");
+            status = EXIT_FAILURE;
+            break;
+        }
+        if (c == 'a')
+        {
+            Flight voo;
+            if (fgetc(entrada) != 'd' || fgetc(entrada) != 'd' || !ler_voo(entrada, &voo))
+            {
+                fprintf(stderr, "Erro ao ler o voo da linha %d.\n", i + 1);
+                status = EXIT_FAILURE;
+                break;
+            }
+            inserir_voo_lsm(tabela, &voo);
+            continue;
+        }
+        ungetc(c, entrada);
+
+        Query consulta;
+        if (!carregar_consulta(entrada, &consulta))
+        {
+            status = EXIT_FAILURE;
+            break;
+        }
+        responder_consulta_lsm(tabela, &consulta, saida);
+    }
+
+    liberar_saida(saida);
+    liberar_tabela_lsm(tabela);
+    return status;
+}
 
 int main(int argc, char *argv[])
 {
+    const char *arquivo = NULL;
+    const char *servidor = NULL;
+    int usar_pipeline = 0;
+    const char *externo = NULL;
+    int construir_externo = 0;
+    size_t memoria_externa = OOC_MEMORIA_PADRAO;
+    int comprimir = 0;
+    int num_fatias = 0;
+    int num_threads = 0;
+    int usar_lsm = 0;
+    int motor = EXECUTOR_INDICE;
+    int tamanho_lote = 0;
+    int agrupamento = AGRUPAR_NENHUM;
+    const char *arquivo_captura = NULL;
+    int perfil = 0;
+    int saida_binaria = 0;
+    long prazo_ms = 0;
+    int max_caras = 0;
+    size_t orcamento_indices = 0;
+    const char *arquivo_amostra = NULL;
+
+    // Interpretar as opções de linha de comando
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--server=", 9) == 0)
+            servidor = argv[i] + 9;
+        else if (strcmp(argv[i], "--pipeline") == 0)
+            usar_pipeline = 1;
+        else if (strncmp(argv[i], "--deadline=", 11) == 0)
+            prazo_ms = atol(argv[i] + 11);
+        else if (strncmp(argv[i], "--max-expensive=", 16) == 0)
+            max_caras = atoi(argv[i] + 16);
+        else if (strncmp(argv[i], "--threads=", 10) == 0)
+            num_threads = atoi(argv[i] + 10);
+        else if (strncmp(argv[i], "--shards=", 9) == 0)
+            num_fatias = atoi(argv[i] + 9);
+        else if (strcmp(argv[i], "--lsm") == 0)
+            usar_lsm = 1;
+        else if (strcmp(argv[i], "--scan") == 0)
+            motor = EXECUTOR_VARREDURA;
+        else if (strncmp(argv[i], "--engine=", 9) == 0)
+        {
+            motor = tipo_executor(argv[i] + 9);
+            if (motor < 0)
+            {
+                fprintf(stderr, "Motor de execução desconhecido: %s\n", argv[i] + 9);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strncmp(argv[i], "--batch=", 8) == 0)
+            tamanho_lote = atoi(argv[i] + 8);
+        else if (strncmp(argv[i], "--cluster=", 10) == 0)
+        {
+            agrupamento = criterio_agrupamento(argv[i] + 10);
+            if (agrupamento < 0)
+            {
+                fprintf(stderr, "Critério de agrupamento desconhecido: %s\n", argv[i] + 10);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--postings=compressed") == 0)
+            comprimir = 1;
+        else if (strcmp(argv[i], "--postings=raw") == 0)
+            comprimir = 0;
+        else if (strncmp(argv[i], "--index-budget=", 15) == 0)
+            orcamento_indices = (size_t)strtoull(argv[i] + 15, NULL, 10) << 20;
+        else if (strncmp(argv[i], "--workload=", 11) == 0)
+            arquivo_amostra = argv[i] + 11;
+        else if (strncmp(argv[i], "--ooc-build=", 12) == 0)
+            externo = argv[i] + 12, construir_externo = 1;
+        else if (strncmp(argv[i], "--ooc=", 6) == 0)
+            externo = argv[i] + 6;
+        else if (strncmp(argv[i], "--ooc-mem=", 10) == 0)
+            memoria_externa = (size_t)strtoull(argv[i] + 10, NULL, 10) << 20;
+        else if (strncmp(argv[i], "--capture=", 10) == 0)
+            arquivo_captura = argv[i] + 10;
+        else if (strcmp(argv[i], "--profile") == 0)
+            perfil = 1;
+        else if (strcmp(argv[i], "--output=binary") == 0)
+            saida_binaria = 1;
+        else if (strcmp(argv[i], "--output=text") == 0)
+            saida_binaria = 0;
+        else if (argv[i][0] == '-' && argv[i][1] == '-')
+        {
+            fprintf(stderr, "Opção desconhecida: %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+        else if (!arquivo)
+            arquivo = argv[i];
+        else
+        {
+            imprimir_uso(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
     // Verificar se o nome do arquivo foi fornecido como argumento
-    if (argc != 2)
+    if (arquivo == NULL)
+    {
+        imprimir_uso(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (num_fatias > 0 && (servidor || usar_pipeline))
     {
-        fprintf(stderr, "Uso: %s <arquivo_de_entrada>\n", argv[0]);
+        fprintf(stderr, "--shards só é suportado no modo sequencial.\n");
         return EXIT_FAILURE;
     }
+    if (tamanho_lote > 0)
+        motor = EXECUTOR_VARREDURA;
+    if (motor != EXECUTOR_INDICE && (servidor || usar_pipeline || num_fatias > 0 || usar_lsm || externo))
+    {
+        fprintf(stderr, "--engine, --scan e --batch só são suportados no modo sequencial.\n");
+        return EXIT_FAILURE;
+    }
+    if ((usar_lsm || agrupamento != AGRUPAR_NENHUM) && externo)
+    {
+        fprintf(stderr, "--lsm e --cluster não se aplicam ao armazém externo.\n");
+        return EXIT_FAILURE;
+    }
+    if (usar_lsm && (servidor || usar_pipeline || num_fatias > 0 || externo))
+    {
+        fprintf(stderr, "--lsm não pode ser combinado com --server, --pipeline, --shards ou --ooc.\n");
+        return EXIT_FAILURE;
+    }
+    if (arquivo_captura && (usar_pipeline || usar_lsm || externo || tamanho_lote > 1))
+    {
+        fprintf(stderr, "--capture só é suportado no modo sequencial e no servidor.\n");
+        return EXIT_FAILURE;
+    }
+    if (saida_binaria && (servidor || usar_pipeline || usar_lsm || externo || tamanho_lote > 1))
+    {
+        fprintf(stderr, "--output=binary só é suportado no modo sequencial (sem --batch).\n");
+        return EXIT_FAILURE;
+    }
+    if ((prazo_ms > 0 || max_caras > 0) && !servidor)
+    {
+        fprintf(stderr, "--deadline e --max-expensive só se aplicam ao servidor (--server).\n");
+        return EXIT_FAILURE;
+    }
+    int usar_plano = orcamento_indices > 0 || arquivo_amostra;
+    if (usar_plano && (num_fatias > 0 || usar_lsm || externo || motor == EXECUTOR_VARREDURA || comprimir))
+    {
+        fprintf(stderr, "--index-budget e --workload escolhem os índices da tabela e não se combinam com "
+                        "--shards, --lsm, --ooc, --engine=scan ou --postings.\n");
+        return EXIT_FAILURE;
+    }
+    definir_threads_indices(num_threads);
+    if (perfil)
+        ativar_perfil();
 
     // Abrir o arquivo de entrada
-    FILE *entrada = fopen(argv[1], "r");
+    FILE *entrada = fopen(arquivo, "r");
     if (entrada == NULL)
     {
-        fprintf(stderr, "Erro ao abrir o arquivo %s.\n", argv[1]);
+        fprintf(stderr, "Erro ao abrir o arquivo %s.\n", arquivo);
         return EXIT_FAILURE;
     }
 
-    // Inicializar as árvores AVL
-    inicializar_indices();
+    // Modo externo: voos e índices ficam em disco, mapeados em memória
+    if (externo)
+    {
+        int status = executar_externo(entrada, externo, construir_externo, memoria_externa);
+        fclose(entrada);
+        return status;
+    }
+
+    // Modo LSM: voos ingeridos em fluxo num log de segmentos
+    if (usar_lsm)
+    {
+        int status = executar_lsm(entrada, num_threads);
+        fclose(entrada);
+        return status;
+    }
 
     // Variáveis para armazenar os voos e consultas
     Flight *voos;
     int num_voos;
 
     // Carregar a lista de voos
+    entrar_fase(FASE_CARGA);
     carregar_voos(entrada, &voos, &num_voos);
+    sair_fase();
 
-    // Construir os índices AVL com os voos carregados
-    construir_indices(voos, num_voos);
+    // Reagrupar a ordem de carga (os ids continuam sendo a ordem de entrada)
+    entrar_fase(FASE_INDICES);
+    agrupar_voos(voos, num_voos, (CriterioAgrupamento)agrupamento);
+
+    // Construir os índices AVL por fatia, ou as estruturas do motor de execução
+    // (índices da tabela, resumos por bloco da varredura ou ambos)
+    Executor *executor = NULL;
+    ConjuntoFatias *fatias = NULL;
+    if (num_fatias > 0)
+    {
+        fatias = criar_fatias(voos, num_voos, num_fatias,
+                              num_threads > 0 ? num_threads : processadores_disponiveis());
+        if (comprimir)
+            comprimir_fatias(fatias);
+    }
+    else if (usar_plano)
+    {
+        // Índices escolhidos pela amostra de consultas dentro do orçamento de memória
+        Query *amostra = NULL;
+        int num_amostra = arquivo_amostra ? carregar_amostra_consultas(arquivo_amostra, &amostra) : 0;
+        if (num_amostra < 0)
+        {
+            fprintf(stderr, "Erro ao abrir a amostra de consultas %s.\n", arquivo_amostra);
+            free(voos);
+            fclose(entrada);
+            return EXIT_FAILURE;
+        }
+        PlanoIndices plano;
+        planejar_indices(voos, num_voos, amostra, num_amostra, orcamento_indices ? orcamento_indices : SIZE_MAX,
+                         &plano);
+        free(amostra);
+        executor = criar_executor((TipoExecutor)motor, voos, num_voos, 0, &plano);
+        relatar_plano_indices(stderr, &plano, executor->indices);
+    }
+    else
+    {
+        executor = criar_executor((TipoExecutor)motor, voos, num_voos, comprimir, NULL);
+    }
+    IndicesVoos *indices = executor ? executor->indices : NULL;
+    MapaZonas *zonas = executor ? executor->zonas : NULL;
+    sair_fase();
+
+    // Log de captura: a contagem do tempo de chegada começa com os dados prontos
+    CapturaConsultas *captura = NULL;
+    if (arquivo_captura && !(captura = abrir_captura(arquivo_captura)))
+    {
+        liberar_executor(executor);
+        liberar_fatias(fatias);
+        free(voos);
+        fclose(entrada);
+        return EXIT_FAILURE;
+    }
+
+    // Modo servidor: os dados ficam residentes e as consultas chegam pelo socket
+    if (servidor)
+    {
+        fclose(entrada);
+        LimitesServidor limites = {
+            .prazo_ns = (uint64_t)(prazo_ms > 0 ? prazo_ms : 0) * 1000000ULL,
+            .max_caras = max_caras > 0 ? max_caras : 0,
+            .custo_caro = num_voos / SERVIDOR_FRACAO_CARA,
+        };
+        int usar_limites = limites.prazo_ns > 0 || limites.max_caras > 0;
+        int status = executar_servidor(servidor, indices, voos, num_voos, captura, usar_limites ? &limites : NULL);
+        fechar_captura(captura);
+        liberar_executor(executor);
+        free(voos);
+        return status;
+    }
+
+    // Buffer de saída único para todas as consultas
+    Saida *saida = criar_saida(STDOUT_FILENO, SAIDA_CAPACIDADE_PADRAO);
+    if (saida_binaria)
+        escrever_cabecalho_binario(saida);
 
     // Ler o número de consultas
     int num_consultas;
     if (fscanf(entrada, "%d", &num_consultas) != 1)
     {
         fprintf(stderr, "Erro ao ler o número de consultas.\n");
+        liberar_saida(saida);
+        fechar_captura(captura);
+        liberar_executor(executor);
+        liberar_fatias(fatias);
         free(voos);
         fclose(entrada);
         return EXIT_FAILURE;
     }
 
+    // Modo pipeline: leitura, execução e saída em threads separadas
+    if (usar_pipeline)
+    {
+        int sucesso = executar_pipeline(entrada, num_consultas, indices, voos, num_voos, saida);
+        liberar_saida(saida);
+        liberar_executor(executor);
+        fclose(entrada);
+        free(voos);
+        return sucesso ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Varredura compartilhada: cada lote de consultas é respondido numa passagem
+    if (tamanho_lote > 1)
+    {
+        Query *lote = malloc(tamanho_lote * sizeof(Query));
+        if (!lote)
+        {
+            fprintf(stderr, "Erro de alocação de memória.\n");
+            exit(EXIT_FAILURE);
+        }
+        int status = EXIT_SUCCESS;
+        for (int i = 0; i < num_consultas && status == EXIT_SUCCESS;)
+        {
+            int num_lote = 0;
+            while (num_lote < tamanho_lote && i < num_consultas)
+            {
+                entrar_fase(FASE_PARSE);
+                int lida = carregar_consulta(entrada, &lote[num_lote]);
+                sair_fase();
+                if (!lida)
+                {
+                    status = EXIT_FAILURE;
+                    break;
+                }
+                num_lote++;
+                i++;
+            }
+            entrar_fase(FASE_AVALIACAO);
+            responder_lote_varredura(zonas, lote, num_lote, saida);
+            sair_fase();
+        }
+        free(lote);
+        liberar_saida(saida);
+        liberar_executor(executor);
+        fclose(entrada);
+        free(voos);
+        return status;
+    }
+
     // Processar cada consulta
+    RedeRotas *rotas = NULL;  // Só sem índices (varredura ou fatias)
     for (int i = 0; i < num_consultas; i++)
     {
         Query consulta;
-        if (!carregar_consulta(entrada, &consulta))
+        entrar_fase(FASE_PARSE);
+        int lida = carregar_consulta(entrada, &consulta);
+        sair_fase();
+        if (!lida)
         {
+            liberar_saida(saida);
+            fechar_captura(captura);
+            liberar_rede_rotas(rotas);
+            liberar_executor(executor);
+            liberar_fatias(fatias);
             free(voos);
             fclose(entrada);
             return EXIT_FAILURE;
@@ -95,27 +521,135 @@ int main(int argc, char *argv[])
 
         // Depuração: Imprimir as árvores AVL antes da filtragem das consultas
         // imprimir_todas_as_avls();
+        uint64_t chegada = captura ? relogio_ns() : 0;
 
-        // Filtrar os voos que atendem à consulta
-        Flight *voos_filtrados;
-        int num_filtrados = filtrar_voos(voos, num_voos, &consulta, &voos_filtrados);
+        // Itinerários: a rede de rotas vem dos índices ou é montada na primeira busca
+        if (consulta.agregacao == CONSULTA_ITINERARIO)
+        {
+            if (!indices && !rotas)
+            {
+                entrar_fase(FASE_INDICES);
+                rotas = construir_rede_rotas(voos, num_voos);
+                sair_fase();
+            }
+            const RedeRotas *rede = indices ? rede_rotas_consulta(indices, voos, num_voos) : rotas;
+            if (saida_binaria)
+            {
+                Itinerario *itinerarios;
+                entrar_fase(FASE_AVALIACAO);
+                int num = executar_itinerarios(rede, voos, &consulta, &itinerarios);
+                sair_fase();
+                entrar_fase(FASE_SAIDA);
+                escrever_itinerarios_binarios(saida, &consulta, (uint32_t)i, voos, itinerarios, num);
+                sair_fase();
+                free(itinerarios);
+            }
+            else
+                responder_itinerarios(saida, rede, voos, &consulta);
+            if (indices)
+                liberar_rede_consulta(indices, rede);
+        }
+        // Agregações são respondidas sem copiar os voos
+        else if (consulta.agregacao != AGREGACAO_NENHUMA)
+        {
+            AgregadoPreco agregado;
+            entrar_fase(FASE_AVALIACAO);
+            if (fatias)
+                agregar_consulta_fatias(fatias, &consulta, &agregado);
+            else
+                agregar_executor(executor, &consulta, &agregado);
+            sair_fase();
+            entrar_fase(FASE_SAIDA);
+            if (saida_binaria)
+                escrever_agregacao_binaria(saida, &consulta, (uint32_t)i, &agregado);
+            else
+            {
+                imprimir_consulta(saida, &consulta);
+                imprimir_agregacao(saida, &consulta, &agregado);
+            }
+            sair_fase();
+        }
+        else if (fatias)
+        {
+            // Cada fatia filtra e seleciona os seus melhores; o resultado já vem ordenado
+            const Flight **melhores;
+            entrar_fase(FASE_AVALIACAO);
+            int num_melhores = responder_consulta_fatias(fatias, &consulta, &melhores);
+            sair_fase();
+            entrar_fase(FASE_SAIDA);
+            int impressos = num_melhores < consulta.max_voos ? num_melhores : consulta.max_voos;
+            const Flight *ultimo = impressos > 0 ? melhores[impressos - 1] : NULL;
+            if (saida_binaria)
+            {
+                escrever_listagem_binaria(saida, &consulta, (uint32_t)i, impressos);
+                for (int j = 0; j < impressos; j++)
+                    escrever_voo_binario(saida, melhores[j]);
+                escrever_cursor_binario(saida, &consulta, ultimo, num_melhores > impressos);
+            }
+            else
+            {
+                imprimir_consulta(saida, &consulta);
+                for (int j = 0; j < impressos; j++)
+                {
+                    imprimir_voo(saida, melhores[j]);
+                }
+                imprimir_cursor(saida, &consulta, ultimo, num_melhores > impressos);
+            }
+            sair_fase();
+            free(melhores);
+        }
+        else
+        {
+            // Filtrar os voos que atendem à consulta (apenas os ids)
+            int *ids_filtrados;
+            int num_filtrados;
+            entrar_fase(FASE_AVALIACAO);
+            num_filtrados = filtrar_executor(executor, &consulta, &ids_filtrados);
+            num_filtrados = aplicar_cursor(&consulta, voos, ids_filtrados, num_filtrados);
+            sair_fase();
 
-        // Ordenar os voos filtrados conforme o trigrama
-        ordenar_voos(voos_filtrados, num_filtrados, consulta.trigrama, consulta.max_voos);
+            // Ordenar os ids filtrados conforme o trigrama
+            entrar_fase(FASE_ORDENACAO);
+            ordenar_voos(voos, ids_filtrados, num_filtrados, consulta.trigrama, consulta.max_voos);
+            sair_fase();
 
-        // Imprimir a consulta
-        printf("%d %s %s\n", consulta.max_voos, consulta.trigrama, consulta.expressao);
+            // Imprimir a consulta e os voos filtrados (só aqui os voos são lidos)
+            entrar_fase(FASE_SAIDA);
+            int impressos = num_filtrados < consulta.max_voos ? num_filtrados : consulta.max_voos;
+            const Flight *ultimo = impressos > 0 ? &voos[ids_filtrados[impressos - 1]] : NULL;
+            if (saida_binaria)
+            {
+                escrever_listagem_binaria(saida, &consulta, (uint32_t)i, impressos);
+                for (int j = 0; j < impressos; j++)
+                    escrever_voo_binario(saida, &voos[ids_filtrados[j]]);
+                escrever_cursor_binario(saida, &consulta, ultimo, num_filtrados > impressos);
+            }
+            else
+            {
+                imprimir_consulta(saida, &consulta);
+                for (int j = 0; j < impressos; j++)
+                {
+                    imprimir_voo(saida, &voos[ids_filtrados[j]]);
+                }
+                imprimir_cursor(saida, &consulta, ultimo, num_filtrados > impressos);
+            }
+            sair_fase();
 
-        // Imprimir os voos filtrados no formato correto
-        for (int j = 0; j < consulta.max_voos && j < num_filtrados; j++)
-        {
-            imprimir_voo(voos_filtrados[j]);
+            free(ids_filtrados); // Liberar os ids filtrados
         }
 
-        free(voos_filtrados); // Liberar a memória dos voos filtrados
+        if (captura)
+            registrar_consulta(captura, &consulta, chegada, relogio_ns());
     }
 
-    // Fechar o arquivo e liberar memória
+    // Fechar o arquivo e liberar memória (a descarga final da saída conta na fase de saída)
+    entrar_fase(FASE_SAIDA);
+    liberar_saida(saida);
+    sair_fase();
+    fechar_captura(captura);
+    liberar_rede_rotas(rotas);
+    liberar_executor(executor);
+    liberar_fatias(fatias);
     fclose(entrada);
     free(voos);
 
@@ -0,0 +1,721 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ooc.h"
+#include "expr_parser.h"
+#include "sort.h"
+#include "cursor.h"
+
+#define OOC_BUFFER_EXECUCAO 4096   // Entradas lidas por vez de cada execução na intercalação
+#define OOC_MIN_BLOCO 1024         // Menor bloco de ordenação aceito
+
+// Campos consultáveis, na ordem dos arquivos de índice
+static const char *campos_externos[OOC_NUM_CAMPOS] = { "org", "dst", "prc", "sea", "dur", "sto" };
+
+/**
+ * Colunas gravadas para cada voo.
+ */
+enum {
+    COL_ORIGEM, COL_DESTINO, COL_PRECO, COL_ASSENTOS,
+    COL_PARTIDA, COL_CHEGADA, COL_PARADAS, COL_DURACAO, NUM_COLUNAS
+};
+
+static const char *nomes_colunas[NUM_COLUNAS] = { "org", "dst", "prc", "sea", "dep", "arr", "sto", "dur" };
+
+/**
+ * Cabeçalho do arquivo "meta" do armazém.
+ */
+typedef struct {
+    uint32_t magico;
+    uint32_t versao;
+    uint64_t num_voos;
+} MetaExterna;
+
+/**
+ * Arquivo mapeado em memória.
+ */
+typedef struct {
+    void *dados;
+    size_t tamanho;
+} Mapeamento;
+
+struct ArmazemExterno {
+    int n;                                       // Número de voos
+    Mapeamento colunas[NUM_COLUNAS];             // Colunas mapeadas
+    Mapeamento indices[OOC_NUM_CAMPOS];          // Índices mapeados
+    const char (*origem)[MAX_ORIGEM];
+    const char (*destino)[MAX_DESTINO];
+    const float *preco;
+    const int32_t *assentos;
+    const int64_t *partida;
+    const int64_t *chegada;
+    const int32_t *paradas;
+    const int32_t *duracao;
+};
+
+/**
+ * Predicado já convertido para um intervalo fechado de chaves.
+ */
+typedef struct {
+    int campo;
+    int64_t min;
+    int64_t max;
+} PredicadoExterno;
+
+/**
+ * Execução ordenada em disco sendo intercalada.
+ */
+typedef struct {
+    FILE *arquivo;
+    EntradaExterna buffer[OOC_BUFFER_EXECUCAO];
+    size_t pos;
+    size_t usados;
+} LeitorExecucao;
+
+/**
+ * Monta o caminho "<diretorio>/<nome>.<extensao>".
+ */
+static void montar_caminho(char *caminho, const char *diretorio, const char *nome, const char *extensao) {
+    snprintf(caminho, PATH_MAX, "%s/%s.%s", diretorio, nome, extensao);
+}
+
+/**
+ * Converte o preço em centavos.
+ */
+static int64_t chave_preco(float preco) {
+    return preco_centavos(preco);
+}
+
+/**
+ * Chave de um voo para o campo indicado, lida diretamente das colunas.
+ */
+static int64_t chave_coluna(const ArmazemExterno *a, int campo, uint32_t id) {
+    switch (campo) {
+        case 0: return chave_aeroporto(a->origem[id]);
+        case 1: return chave_aeroporto(a->destino[id]);
+        case 2: return chave_preco(a->preco[id]);
+        case 3: return a->assentos[id];
+        case 4: return a->duracao[id];
+        default: return a->paradas[id];
+    }
+}
+
+/**
+ * Ordena entradas por (chave, id).
+ */
+static int comparar_entradas(const void *x, const void *y) {
+    const EntradaExterna *a = x, *b = y;
+    if (a->chave != b->chave) return a->chave < b->chave ? -1 : 1;
+    if (a->id != b->id) return a->id < b->id ? -1 : 1;
+    return 0;
+}
+
+/**
+ * Ordena um bloco e grava como execução temporária.
+ */
+static int gravar_execucao(const char *diretorio, int campo, int numero, EntradaExterna *bloco, size_t usados) {
+    char nome[32], caminho[PATH_MAX];
+    snprintf(nome, sizeof(nome), "%s.run%d", campos_externos[campo], numero);
+    montar_caminho(caminho, diretorio, nome, "tmp");
+
+    qsort(bloco, usados, sizeof(EntradaExterna), comparar_entradas);
+
+    FILE *f = fopen(caminho, "wb");
+    if (!f || fwrite(bloco, sizeof(EntradaExterna), usados, f) != usados) {
+        fprintf(stderr, "Erro ao gravar a execução %s.\n", caminho);
+        if (f) fclose(f);
+        return 0;
+    }
+    fclose(f);
+    return 1;
+}
+
+/**
+ * Recarrega o buffer de uma execução.
+ * @return 1 se há entrada disponível, 0 no fim da execução.
+ */
+static int avancar_execucao(LeitorExecucao *leitor) {
+    if (leitor->pos < leitor->usados) return 1;
+    leitor->usados = fread(leitor->buffer, sizeof(EntradaExterna), OOC_BUFFER_EXECUCAO, leitor->arquivo);
+    leitor->pos = 0;
+    return leitor->usados > 0;
+}
+
+/**
+ * Intercala as execuções de um campo no arquivo de índice final (heap mínimo de execuções).
+ */
+static int intercalar_execucoes(const char *diretorio, int campo, int num_execucoes) {
+    char nome[32], caminho[PATH_MAX];
+    montar_caminho(caminho, diretorio, campos_externos[campo], "idx");
+    FILE *destino = fopen(caminho, "wb");
+    if (!destino) {
+        fprintf(stderr, "Erro ao criar o índice %s.\n", caminho);
+        return 0;
+    }
+
+    LeitorExecucao **leitores = malloc((num_execucoes + 1) * sizeof(LeitorExecucao *));
+    int *heap = malloc((num_execucoes + 1) * sizeof(int));
+    if (!leitores || !heap) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int tamanho_heap = 0;
+    for (int k = 0; k < num_execucoes; k++) {
+        snprintf(nome, sizeof(nome), "%s.run%d", campos_externos[campo], k);
+        montar_caminho(caminho, diretorio, nome, "tmp");
+        leitores[k] = malloc(sizeof(LeitorExecucao));
+        if (!leitores[k]) {
+            fprintf(stderr, "Erro de alocação de memória.\n");
+            exit(EXIT_FAILURE);
+        }
+        leitores[k]->arquivo = fopen(caminho, "rb");
+        leitores[k]->pos = leitores[k]->usados = 0;
+        if (!leitores[k]->arquivo) {
+            fprintf(stderr, "Erro ao abrir a execução %s.\n", caminho);
+            exit(EXIT_FAILURE);
+        }
+        if (avancar_execucao(leitores[k])) heap[tamanho_heap++] = k;
+    }
+
+    #define TOPO_EXECUCAO(k) (&leitores[k]->buffer[leitores[k]->pos])
+
+    // Constrói o heap mínimo pelas entradas correntes de cada execução
+    for (int i = tamanho_heap / 2 - 1; i >= 0; i--) {
+        int j = i;
+        while (1) {
+            int menor = j, e = 2 * j + 1, d = 2 * j + 2;
+            if (e < tamanho_heap && comparar_entradas(TOPO_EXECUCAO(heap[e]), TOPO_EXECUCAO(heap[menor])) < 0) menor = e;
+            if (d < tamanho_heap && comparar_entradas(TOPO_EXECUCAO(heap[d]), TOPO_EXECUCAO(heap[menor])) < 0) menor = d;
+            if (menor == j) break;
+            int t = heap[j]; heap[j] = heap[menor]; heap[menor] = t;
+            j = menor;
+        }
+    }
+
+    while (tamanho_heap > 0) {
+        int k = heap[0];
+        fwrite(TOPO_EXECUCAO(k), sizeof(EntradaExterna), 1, destino);
+        leitores[k]->pos++;
+        if (!avancar_execucao(leitores[k])) {
+            heap[0] = heap[--tamanho_heap];
+        }
+
+        // Desce a nova raiz
+        int j = 0;
+        while (1) {
+            int menor = j, e = 2 * j + 1, d = 2 * j + 2;
+            if (e < tamanho_heap && comparar_entradas(TOPO_EXECUCAO(heap[e]), TOPO_EXECUCAO(heap[menor])) < 0) menor = e;
+            if (d < tamanho_heap && comparar_entradas(TOPO_EXECUCAO(heap[d]), TOPO_EXECUCAO(heap[menor])) < 0) menor = d;
+            if (menor == j) break;
+            int t = heap[j]; heap[j] = heap[menor]; heap[menor] = t;
+            j = menor;
+        }
+    }
+
+    #undef TOPO_EXECUCAO
+
+    for (int k = 0; k < num_execucoes; k++) {
+        fclose(leitores[k]->arquivo);
+        free(leitores[k]);
+        snprintf(nome, sizeof(nome), "%s.run%d", campos_externos[campo], k);
+        montar_caminho(caminho, diretorio, nome, "tmp");
+        unlink(caminho);
+    }
+    free(leitores);
+    free(heap);
+
+    if (fclose(destino) != 0) {
+        fprintf(stderr, "Erro ao gravar o índice de %s.\n", campos_externos[campo]);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Constrói o armazém externo lendo os voos em fluxo.
+ */
+int construir_armazem_externo(FILE *arquivo, int n, const char *diretorio, size_t memoria) {
+    char caminho[PATH_MAX];
+    FILE *colunas[NUM_COLUNAS];
+
+    for (int c = 0; c < NUM_COLUNAS; c++) {
+        montar_caminho(caminho, diretorio, nomes_colunas[c], "col");
+        colunas[c] = fopen(caminho, "wb");
+        if (!colunas[c]) {
+            fprintf(stderr, "Erro ao criar a coluna %s: %s\n", caminho, strerror(errno));
+            return 0;
+        }
+    }
+
+    // Um bloco de ordenação por campo; juntos respeitam o limite de memória
+    size_t capacidade = memoria / (OOC_NUM_CAMPOS * sizeof(EntradaExterna));
+    if (capacidade < OOC_MIN_BLOCO) capacidade = OOC_MIN_BLOCO;
+
+    EntradaExterna *blocos[OOC_NUM_CAMPOS];
+    size_t usados = 0;
+    int execucoes = 0;
+    for (int c = 0; c < OOC_NUM_CAMPOS; c++) {
+        blocos[c] = malloc(capacidade * sizeof(EntradaExterna));
+        if (!blocos[c]) {
+            fprintf(stderr, "Erro de alocação de memória.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    int ok = 1;
+    for (int i = 0; i < n && ok; i++) {
+        Flight voo;
+        memset(&voo, 0, sizeof(voo));
+        if (!ler_voo(arquivo, &voo)) {
+            fprintf(stderr, "Erro ao ler os dados do voo %d.\n", i + 1);
+            ok = 0;
+            break;
+        }
+
+        int64_t partida = voo.partida, chegada = voo.chegada;
+        int32_t assentos = voo.assentos, paradas = voo.paradas, duracao = voo.duracao;
+        fwrite(voo.origem, MAX_ORIGEM, 1, colunas[COL_ORIGEM]);
+        fwrite(voo.destino, MAX_DESTINO, 1, colunas[COL_DESTINO]);
+        fwrite(&voo.preco, sizeof(float), 1, colunas[COL_PRECO]);
+        fwrite(&assentos, sizeof(int32_t), 1, colunas[COL_ASSENTOS]);
+        fwrite(&partida, sizeof(int64_t), 1, colunas[COL_PARTIDA]);
+        fwrite(&chegada, sizeof(int64_t), 1, colunas[COL_CHEGADA]);
+        fwrite(&paradas, sizeof(int32_t), 1, colunas[COL_PARADAS]);
+        fwrite(&duracao, sizeof(int32_t), 1, colunas[COL_DURACAO]);
+
+        for (int c = 0; c < OOC_NUM_CAMPOS; c++) {
+            blocos[c][usados].chave = chave_voo(&voo, c);
+            blocos[c][usados].id = (uint32_t)i;
+            blocos[c][usados].pad = 0;
+        }
+
+        // Bloco cheio: ordena e grava uma execução por campo
+        if (++usados == capacidade) {
+            for (int c = 0; c < OOC_NUM_CAMPOS && ok; c++) {
+                ok = gravar_execucao(diretorio, c, execucoes, blocos[c], usados);
+            }
+            execucoes++;
+            usados = 0;
+        }
+    }
+
+    if (ok && (usados > 0 || execucoes == 0)) {
+        for (int c = 0; c < OOC_NUM_CAMPOS && ok; c++) {
+            ok = gravar_execucao(diretorio, c, execucoes, blocos[c], usados);
+        }
+        execucoes++;
+    }
+
+    for (int c = 0; c < OOC_NUM_CAMPOS; c++) free(blocos[c]);
+    for (int c = 0; c < NUM_COLUNAS; c++) {
+        if (fclose(colunas[c]) != 0) ok = 0;
+    }
+
+    for (int c = 0; c < OOC_NUM_CAMPOS && ok; c++) {
+        ok = intercalar_execucoes(diretorio, c, execucoes);
+    }
+    if (!ok) return 0;
+
+    // O arquivo meta é gravado por último: sua presença marca o armazém como completo
+    MetaExterna meta = { OOC_MAGICO, OOC_VERSAO, (uint64_t)n };
+    snprintf(caminho, PATH_MAX, "%s/meta", diretorio);
+    FILE *f = fopen(caminho, "wb");
+    if (!f || fwrite(&meta, sizeof(meta), 1, f) != 1) {
+        fprintf(stderr, "Erro ao gravar %s.\n", caminho);
+        if (f) fclose(f);
+        return 0;
+    }
+    fclose(f);
+    return 1;
+}
+
+/**
+ * Mapeia um arquivo somente para leitura.
+ */
+static int mapear_arquivo(const char *caminho, size_t tamanho_esperado, Mapeamento *m) {
+    m->dados = NULL;
+    m->tamanho = 0;
+
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Erro ao abrir %s: %s\n", caminho, strerror(errno));
+        return 0;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size != tamanho_esperado) {
+        fprintf(stderr, "Arquivo %s com tamanho inesperado.\n", caminho);
+        close(fd);
+        return 0;
+    }
+
+    if (tamanho_esperado > 0) {
+        m->dados = mmap(NULL, tamanho_esperado, PROT_READ, MAP_SHARED, fd, 0);
+        if (m->dados == MAP_FAILED) {
+            fprintf(stderr, "Erro ao mapear %s: %s\n", caminho, strerror(errno));
+            m->dados = NULL;
+            close(fd);
+            return 0;
+        }
+        m->tamanho = tamanho_esperado;
+    }
+    close(fd);
+    return 1;
+}
+
+/**
+ * Mapeia em memória um armazém construído anteriormente.
+ */
+ArmazemExterno *abrir_armazem_externo(const char *diretorio) {
+    char caminho[PATH_MAX];
+    MetaExterna meta;
+
+    snprintf(caminho, PATH_MAX, "%s/meta", diretorio);
+    FILE *f = fopen(caminho, "rb");
+    if (!f || fread(&meta, sizeof(meta), 1, f) != 1 ||
+        meta.magico != OOC_MAGICO || meta.versao != OOC_VERSAO || meta.num_voos > INT_MAX) {
+        fprintf(stderr, "Armazém externo inválido em %s.\n", diretorio);
+        if (f) fclose(f);
+        return NULL;
+    }
+    fclose(f);
+
+    ArmazemExterno *a = calloc(1, sizeof(ArmazemExterno));
+    if (!a) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        exit(EXIT_FAILURE);
+    }
+    a->n = (int)meta.num_voos;
+
+    static const size_t tamanhos[NUM_COLUNAS] = {
+        MAX_ORIGEM, MAX_DESTINO, sizeof(float), sizeof(int32_t),
+        sizeof(int64_t), sizeof(int64_t), sizeof(int32_t), sizeof(int32_t)
+    };
+
+    int ok = 1;
+    for (int c = 0; c < NUM_COLUNAS && ok; c++) {
+        montar_caminho(caminho, diretorio, nomes_colunas[c], "col");
+        ok = mapear_arquivo(caminho, tamanhos[c] * (size_t)a->n, &a->colunas[c]);
+    }
+    for (int c = 0; c < OOC_NUM_CAMPOS && ok; c++) {
+        montar_caminho(caminho, diretorio, campos_externos[c], "idx");
+        ok = mapear_arquivo(caminho, sizeof(EntradaExterna) * (size_t)a->n, &a->indices[c]);
+        // Os índices são percorridos sequencialmente dentro de cada intervalo
+        if (ok && a->indices[c].dados) madvise(a->indices[c].dados, a->indices[c].tamanho, MADV_SEQUENTIAL);
+    }
+    if (!ok) {
+        fechar_armazem_externo(a);
+        return NULL;
+    }
+
+    for (int c = 0; c < NUM_COLUNAS; c++) {
+        // As colunas são acessadas por id, de forma esparsa
+        if (a->colunas[c].dados) madvise(a->colunas[c].dados, a->colunas[c].tamanho, MADV_RANDOM);
+    }
+
+    a->origem = a->colunas[COL_ORIGEM].dados;
+    a->destino = a->colunas[COL_DESTINO].dados;
+    a->preco = a->colunas[COL_PRECO].dados;
+    a->assentos = a->colunas[COL_ASSENTOS].dados;
+    a->partida = a->colunas[COL_PARTIDA].dados;
+    a->chegada = a->colunas[COL_CHEGADA].dados;
+    a->paradas = a->colunas[COL_PARADAS].dados;
+    a->duracao = a->colunas[COL_DURACAO].dados;
+    return a;
+}
+
+/**
+ * Desfaz os mapeamentos e libera o armazém.
+ */
+void fechar_armazem_externo(ArmazemExterno *armazem) {
+    if (!armazem) return;
+    for (int c = 0; c < NUM_COLUNAS; c++) {
+        if (armazem->colunas[c].dados) munmap(armazem->colunas[c].dados, armazem->colunas[c].tamanho);
+    }
+    for (int c = 0; c < OOC_NUM_CAMPOS; c++) {
+        if (armazem->indices[c].dados) munmap(armazem->indices[c].dados, armazem->indices[c].tamanho);
+    }
+    free(armazem);
+}
+
+/**
+ * Número de voos do armazém.
+ */
+int tamanho_armazem_externo(const ArmazemExterno *armazem) {
+    return armazem->n;
+}
+
+/**
+ * Converte um predicado da expressão no intervalo fechado [min, max] de chaves.
+ * @return 1 se o campo é conhecido, 0 caso contrário (a partida não é gravada).
+ */
+static int converter_predicado(const ExprNode *no, PredicadoExterno *p) {
+    FaixaPredicado faixa;
+    if (!converter_faixa_predicado(no, &faixa) || faixa.campo >= OOC_NUM_CAMPOS) return 0;
+    p->campo = faixa.campo;
+    p->min = faixa.min;
+    p->max = faixa.max;
+    return 1;
+}
+
+/**
+ * Coleta os predicados folha de uma conjunção.
+ * @return 0 se algum campo for desconhecido.
+ */
+static int coletar_predicados(const ExprNode *no, PredicadoExterno *predicados, int *num, int max) {
+    if (!no) return 1;
+    if (no->operator == OP_AND) {
+        return coletar_predicados(no->left, predicados, num, max) &&
+               coletar_predicados(no->right, predicados, num, max);
+    }
+    if (*num >= max) return 1;
+    if (!converter_predicado(no, &predicados[*num])) {
+        fprintf(stderr, "Campo desconhecido na consulta: %s\n", no->field);
+        return 0;
+    }
+    (*num)++;
+    return 1;
+}
+
+/**
+ * Primeira posição do índice com (chave, id) >= (chave, 0).
+ */
+static size_t limite_inferior(const EntradaExterna *indice, size_t n, int64_t chave) {
+    size_t ini = 0, fim = n;
+    while (ini < fim) {
+        size_t meio = ini + (fim - ini) / 2;
+        if (indice[meio].chave < chave) ini = meio + 1;
+        else fim = meio;
+    }
+    return ini;
+}
+
+/**
+ * Primeira posição do índice com chave > chave.
+ */
+static size_t limite_superior(const EntradaExterna *indice, size_t n, int64_t chave) {
+    size_t ini = 0, fim = n;
+    while (ini < fim) {
+        size_t meio = ini + (fim - ini) / 2;
+        if (indice[meio].chave <= chave) ini = meio + 1;
+        else fim = meio;
+    }
+    return ini;
+}
+
+/**
+ * Monta um voo a partir das colunas.
+ */
+static void materializar_voo(const ArmazemExterno *a, uint32_t id, Flight *voo) {
+    memcpy(voo->origem, a->origem[id], MAX_ORIGEM);
+    memcpy(voo->destino, a->destino[id], MAX_DESTINO);
+    voo->preco = a->preco[id];
+    voo->assentos = a->assentos[id];
+    voo->partida = (time_t)a->partida[id];
+    voo->chegada = (time_t)a->chegada[id];
+    voo->paradas = a->paradas[id];
+    voo->duracao = a->duracao[id];
+    voo->id = (int)id;
+}
+
+/**
+ * Heap de máximo limitado aos `capacidade` melhores voos (a raiz é o pior retido).
+ */
+typedef struct {
+    Flight *voos;
+    uint32_t *ids;
+    int tamanho;
+    int capacidade;
+    const char *trigrama;
+    const Query *consulta;  // Só os voos posteriores ao cursor da página entram
+} HeapExterno;
+
+/**
+ * Ordem total: critério do trigrama e, em empate, o id do voo.
+ */
+static int comparar_heap(const HeapExterno *h, int i, int j) {
+    int c = comparar_voos(&h->voos[i], &h->voos[j], h->trigrama);
+    if (c != 0) return c;
+    return (h->ids[i] > h->ids[j]) - (h->ids[i] < h->ids[j]);
+}
+
+static void trocar_heap(HeapExterno *h, int i, int j) {
+    Flight v = h->voos[i]; h->voos[i] = h->voos[j]; h->voos[j] = v;
+    uint32_t id = h->ids[i]; h->ids[i] = h->ids[j]; h->ids[j] = id;
+}
+
+static void descer_heap(HeapExterno *h, int i, int tamanho) {
+    while (1) {
+        int maior = i, e = 2 * i + 1, d = 2 * i + 2;
+        if (e < tamanho && comparar_heap(h, e, maior) > 0) maior = e;
+        if (d < tamanho && comparar_heap(h, d, maior) > 0) maior = d;
+        if (maior == i) return;
+        trocar_heap(h, i, maior);
+        i = maior;
+    }
+}
+
+/**
+ * Oferece um voo ao heap; ele só entra se for melhor que o pior retido.
+ */
+static void oferecer_heap(HeapExterno *h, const ArmazemExterno *a, uint32_t id) {
+    if (h->capacidade <= 0) return;
+
+    int pos;
+    if (h->tamanho < h->capacidade) {
+        pos = h->tamanho;
+        materializar_voo(a, id, &h->voos[pos]);
+        if (!depois_do_cursor(h->consulta, &h->voos[pos])) return;
+        h->tamanho++;
+        h->ids[pos] = id;
+        // Sobe o novo elemento
+        while (pos > 0 && comparar_heap(h, pos, (pos - 1) / 2) > 0) {
+            trocar_heap(h, pos, (pos - 1) / 2);
+            pos = (pos - 1) / 2;
+        }
+        return;
+    }
+
+    // Usa a posição extra (capacidade) como área temporária de comparação
+    materializar_voo(a, id, &h->voos[h->capacidade]);
+    h->ids[h->capacidade] = id;
+    if (comparar_heap(h, h->capacidade, 0) >= 0 || !depois_do_cursor(h->consulta, &h->voos[h->capacidade])) return;
+    h->voos[0] = h->voos[h->capacidade];
+    h->ids[0] = id;
+    descer_heap(h, 0, h->tamanho);
+}
+
+/**
+ * Interpreta a expressão e escolhe como condutor o predicado com o menor
+ * intervalo no seu índice ordenado.
+ * @return 0 se nenhum voo pode satisfazer a consulta.
+ */
+static int preparar_varredura(const ArmazemExterno *armazem, const Query *consulta,
+                              PredicadoExterno *predicados, int *num,
+                              size_t *melhor_ini, size_t *melhor_fim, int *condutor) {
+    ExprNode *expressao = parse_expressao(consulta->expressao);
+    *num = 0;
+    int valida = expressao && coletar_predicados(expressao, predicados, num, 32) && *num > 0;
+    liberar_expressao(expressao);
+    if (!valida || armazem->n == 0) return 0;
+
+    size_t melhor_tam = SIZE_MAX;
+    *condutor = 0;
+    for (int i = 0; i < *num; i++) {
+        const EntradaExterna *indice = armazem->indices[predicados[i].campo].dados;
+        size_t ini = 0, fim = 0;
+        if (predicados[i].min <= predicados[i].max) {
+            ini = limite_inferior(indice, (size_t)armazem->n, predicados[i].min);
+            fim = limite_superior(indice, (size_t)armazem->n, predicados[i].max);
+        }
+        if (fim - ini < melhor_tam) {
+            melhor_tam = fim - ini;
+            *melhor_ini = ini;
+            *melhor_fim = fim;
+            *condutor = i;
+        }
+    }
+    return melhor_tam > 0;
+}
+
+/**
+ * Verifica nas colunas os predicados que não conduzem a varredura.
+ */
+static int passa_predicados(const ArmazemExterno *armazem, const PredicadoExterno *predicados,
+                            int num, int condutor, uint32_t id) {
+    for (int p = 0; p < num; p++) {
+        if (p == condutor) continue;
+        int64_t chave = chave_coluna(armazem, predicados[p].campo, id);
+        if (chave < predicados[p].min || chave > predicados[p].max) return 0;
+    }
+    return 1;
+}
+
+/**
+ * Agrega os preços dos voos que satisfazem a consulta lendo só as colunas.
+ */
+void agregar_consulta_externa(const ArmazemExterno *armazem, const Query *consulta, AgregadoPreco *agregado) {
+    AgregadoPreco vazio = AGREGADO_PRECO_VAZIO;
+    *agregado = vazio;
+
+    PredicadoExterno predicados[32];
+    int num, condutor;
+    size_t ini, fim;
+    if (!preparar_varredura(armazem, consulta, predicados, &num, &ini, &fim, &condutor)) return;
+
+    const EntradaExterna *indice = armazem->indices[predicados[condutor].campo].dados;
+    for (size_t i = ini; i < fim; i++) {
+        uint32_t id = indice[i].id;
+        if (passa_predicados(armazem, predicados, num, condutor, id)) {
+            acumular_preco(agregado, armazem->preco[id]);
+        }
+    }
+}
+
+
+/**
+ * Executa uma consulta sobre o armazém externo.
+ */
+void responder_consulta_externa(const ArmazemExterno *armazem, const Query *consulta, Saida *saida) {
+    imprimir_consulta(saida, consulta);
+
+    if (consulta->agregacao == CONSULTA_ITINERARIO) {
+        fprintf(stderr, "Consultas itn não são suportadas no armazém externo.\n");
+        return;
+    }
+    if (consulta->agregacao != AGREGACAO_NENHUMA) {
+        AgregadoPreco agregado;
+        agregar_consulta_externa(armazem, consulta, &agregado);
+        imprimir_agregacao(saida, consulta, &agregado);
+        return;
+    }
+
+    PredicadoExterno predicados[32];
+    int num, condutor;
+    size_t melhor_ini, melhor_fim;
+    if (!preparar_varredura(armazem, consulta, predicados, &num, &melhor_ini, &melhor_fim, &condutor)) {
+        imprimir_cursor(saida, consulta, NULL, 0);
+        return;
+    }
+    size_t melhor_tam = melhor_fim - melhor_ini;
+
+    HeapExterno heap;
+    heap.capacidade = limite_pagina(consulta);
+    if ((size_t)heap.capacidade > melhor_tam) heap.capacidade = (int)melhor_tam;
+    heap.tamanho = 0;
+    heap.trigrama = consulta->trigrama;
+    heap.consulta = consulta;
+    heap.voos = malloc((heap.capacidade + 1) * sizeof(Flight));
+    heap.ids = malloc((heap.capacidade + 1) * sizeof(uint32_t));
+    if (!heap.voos || !heap.ids) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Percorre o intervalo do condutor e verifica os demais predicados nas colunas
+    const EntradaExterna *indice = armazem->indices[predicados[condutor].campo].dados;
+    for (size_t i = melhor_ini; i < melhor_fim; i++) {
+        uint32_t id = indice[i].id;
+        if (passa_predicados(armazem, predicados, num, condutor, id)) oferecer_heap(&heap, armazem, id);
+    }
+
+    // Ordena o heap em ordem crescente extraindo o máximo repetidamente
+    for (int fim = heap.tamanho - 1; fim > 0; fim--) {
+        trocar_heap(&heap, 0, fim);
+        descer_heap(&heap, 0, fim);
+    }
+    int impressos = heap.tamanho < consulta->max_voos ? heap.tamanho : consulta->max_voos;
+    for (int i = 0; i < impressos; i++) {
+        imprimir_voo(saida, &heap.voos[i]);
+    }
+    imprimir_cursor(saida, consulta, impressos > 0 ? &heap.voos[impressos - 1] : NULL, heap.tamanho > impressos);
+
+    free(heap.voos);
+    free(heap.ids);
+}
@@ -0,0 +1,371 @@
+#include <errno.h>
+#include <math.h>
+#include <unistd.h>
+#include "output.h"
+#include "cursor.h"
+
+#define CACHE_DIAS 512       // Entradas do cache de datas (potência de 2)
+#define SEGUNDOS_DIA 86400
+
+/**
+ * Entrada do cache de datas. Cada dia UTC intersecta no máximo dois dias
+ * locais, por isso cada entrada guarda até dois intervalos [inicio, fim)
+ * com a string "YYYY-MM-DD" correspondente.
+ */
+typedef struct {
+    long long dia_utc;      // Dia UTC a que a entrada pertence (-1 se vazia)
+    time_t inicio[2];       // Início do dia local (inclusive)
+    time_t fim[2];          // Fim do dia local (exclusivo)
+    char data[2][11];       // "YYYY-MM-DD"
+    int usados;             // Intervalos preenchidos
+} EntradaDia;
+
+// Cache por thread: evita sincronização entre threads de formatação
+static _Thread_local EntradaDia cache_dias[CACHE_DIAS];
+static _Thread_local int cache_iniciado = 0;
+
+/**
+ * Cria um buffer de saída.
+ */
+Saida *criar_saida(int fd, size_t capacidade) {
+    Saida *saida = malloc(sizeof(Saida));
+    if (!saida) {
+        fprintf(stderr, "Erro ao alocar memória para a saída.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (capacidade < SAIDA_MAX_LINHA) capacidade = SAIDA_MAX_LINHA;
+    saida->dados = malloc(capacidade);
+    if (!saida->dados) {
+        fprintf(stderr, "Erro ao alocar memória para a saída.\n");
+        exit(EXIT_FAILURE);
+    }
+    saida->tamanho = 0;
+    saida->capacidade = capacidade;
+    saida->fd = fd;
+    return saida;
+}
+
+/**
+ * Descarrega o conteúdo pendente e libera o buffer.
+ */
+void liberar_saida(Saida *saida) {
+    if (!saida) return;
+    descarregar_saida(saida);
+    free(saida->dados);
+    free(saida);
+}
+
+/**
+ * Envia o conteúdo acumulado ao descritor, tratando escritas parciais.
+ */
+void descarregar_saida(Saida *saida) {
+    if (saida->fd < 0) return;
+
+    size_t enviado = 0;
+    while (enviado < saida->tamanho) {
+        ssize_t r = write(saida->fd, saida->dados + enviado, saida->tamanho - enviado);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "Erro ao escrever a saída.\n");
+            exit(EXIT_FAILURE);
+        }
+        enviado += (size_t)r;
+    }
+    saida->tamanho = 0;
+}
+
+/**
+ * Garante espaço para `tamanho` bytes e retorna a posição livre.
+ */
+char *reservar_saida(Saida *saida, size_t tamanho) {
+    if (saida->capacidade - saida->tamanho >= tamanho) {
+        return saida->dados + saida->tamanho;
+    }
+
+    if (saida->fd >= 0) {
+        descarregar_saida(saida);
+    }
+
+    if (saida->capacidade - saida->tamanho < tamanho) {
+        size_t nova = saida->capacidade * 2;
+        while (nova - saida->tamanho < tamanho) nova *= 2;
+        char *dados = realloc(saida->dados, nova);
+        if (!dados) {
+            fprintf(stderr, "Erro ao alocar memória para a saída.\n");
+            exit(EXIT_FAILURE);
+        }
+        saida->dados = dados;
+        saida->capacidade = nova;
+    }
+    return saida->dados + saida->tamanho;
+}
+
+/**
+ * Copia `tamanho` bytes para o buffer de saída.
+ */
+void escrever_saida(Saida *saida, const char *dados, size_t tamanho) {
+    char *destino = reservar_saida(saida, tamanho);
+    memcpy(destino, dados, tamanho);
+    saida->tamanho += tamanho;
+}
+
+/**
+ * Escreve um inteiro em base 10 e retorna o número de caracteres escritos.
+ */
+static int escrever_inteiro(char *buffer, long long valor) {
+    char temp[24];
+    int n = 0, pos = 0;
+    unsigned long long v;
+
+    if (valor < 0) {
+        buffer[pos++] = '-';
+        v = 0ULL - (unsigned long long)valor;
+    } else {
+        v = (unsigned long long)valor;
+    }
+
+    do {
+        temp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+
+    while (n) buffer[pos++] = temp[--n];
+    return pos;
+}
+
+/**
+ * Escreve um valor com dois dígitos (00-99).
+ */
+static inline void escrever_dois_digitos(char *buffer, int valor) {
+    buffer[0] = (char)('0' + valor / 10);
+    buffer[1] = (char)('0' + valor % 10);
+}
+
+/**
+ * Formata o preço reproduzindo as regras de "%.0f" / "%.2f" com remoção de zero final.
+ * O produto de um float por 100 é exato em double (24 + 7 bits de mantissa),
+ * logo rint() equivale ao arredondamento feito pelo printf.
+ */
+int formatar_preco(float preco, char *buffer) {
+    double valor = preco;
+    double centesimos = valor * 100;
+    int centavos_truncados = (int)centesimos % 100;
+
+    if (centavos_truncados == 0) {
+        // Sem centavos: equivalente a "%.0f"
+        return escrever_inteiro(buffer, llrint(valor));
+    }
+
+    // Equivalente a "%.2f", removendo um zero final
+    long long arredondado = llrint(centesimos);
+    int pos = 0;
+    if (arredondado < 0) {
+        buffer[pos++] = '-';
+        arredondado = -arredondado;
+    }
+    pos += escrever_inteiro(buffer + pos, arredondado / 100);
+    int centavos = (int)(arredondado % 100);
+    buffer[pos++] = '.';
+    buffer[pos++] = (char)('0' + centavos / 10);
+    if (centavos % 10 != 0) {
+        buffer[pos++] = (char)('0' + centavos % 10);
+    }
+    return pos;
+}
+
+/**
+ * Divisão inteira com arredondamento para baixo (também para negativos).
+ */
+static inline long long dividir_piso(long long a, long long b) {
+    long long q = a / b;
+    if ((a % b != 0) && ((a < 0) != (b < 0))) q--;
+    return q;
+}
+
+/**
+ * Formata a data via localtime_r (caminho lento, usado em falhas do cache).
+ */
+static void formatar_data_lenta(time_t timestamp, char *buffer) {
+    struct tm tm_info;
+    localtime_r(&timestamp, &tm_info);
+    strftime(buffer, 20, "%Y-%m-%dT%H:%M:%S", &tm_info);
+}
+
+/**
+ * Tenta registrar no cache o dia local que contém `timestamp`.
+ * Dias com mudança de fuso (horário de verão) não são armazenados.
+ * @return Índice do intervalo registrado na entrada ou -1.
+ */
+static int registrar_dia(EntradaDia *entrada, long long dia_utc, time_t timestamp) {
+    struct tm tm_info;
+    localtime_r(&timestamp, &tm_info);
+
+    time_t inicio = timestamp - (tm_info.tm_hour * 3600 + tm_info.tm_min * 60 + tm_info.tm_sec);
+    time_t fim = inicio + SEGUNDOS_DIA;
+
+    // O dia só é regular se começa às 00:00:00 e termina às 23:59:59 locais
+    struct tm tm_inicio, tm_fim;
+    time_t ultimo = fim - 1;
+    localtime_r(&inicio, &tm_inicio);
+    localtime_r(&ultimo, &tm_fim);
+    if (tm_inicio.tm_hour != 0 || tm_inicio.tm_min != 0 || tm_inicio.tm_sec != 0 ||
+        tm_fim.tm_hour != 23 || tm_fim.tm_min != 59 || tm_fim.tm_sec != 59 ||
+        tm_inicio.tm_mday != tm_info.tm_mday || tm_fim.tm_mday != tm_info.tm_mday) {
+        return -1;
+    }
+
+    if (entrada->dia_utc != dia_utc) {
+        entrada->dia_utc = dia_utc;
+        entrada->usados = 0;
+    }
+    int slot = entrada->usados < 2 ? entrada->usados++ : 1;
+    entrada->inicio[slot] = inicio;
+    entrada->fim[slot] = fim;
+    strftime(entrada->data[slot], sizeof(entrada->data[slot]), "%Y-%m-%d", &tm_info);
+    return slot;
+}
+
+/**
+ * Formata um timestamp como YYYY-MM-DDTHH:MM:SS usando o cache de dias.
+ */
+void formatar_data_cache(time_t timestamp, char *buffer) {
+    if (!cache_iniciado) {
+        for (int i = 0; i < CACHE_DIAS; i++) cache_dias[i].dia_utc = -1;
+        cache_iniciado = 1;
+    }
+
+    long long dia_utc = dividir_piso((long long)timestamp, SEGUNDOS_DIA);
+    EntradaDia *entrada = &cache_dias[dia_utc & (CACHE_DIAS - 1)];
+
+    int slot = -1;
+    if (entrada->dia_utc == dia_utc) {
+        for (int i = 0; i < entrada->usados; i++) {
+            if (timestamp >= entrada->inicio[i] && timestamp < entrada->fim[i]) {
+                slot = i;
+                break;
+            }
+        }
+    }
+    if (slot < 0) slot = registrar_dia(entrada, dia_utc, timestamp);
+    if (slot < 0) {
+        formatar_data_lenta(timestamp, buffer);
+        return;
+    }
+
+    int segundos = (int)(timestamp - entrada->inicio[slot]);
+    memcpy(buffer, entrada->data[slot], 10);
+    buffer[10] = 'T';
+    escrever_dois_digitos(buffer + 11, segundos / 3600);
+    buffer[13] = ':';
+    escrever_dois_digitos(buffer + 14, (segundos / 60) % 60);
+    buffer[16] = ':';
+    escrever_dois_digitos(buffer + 17, segundos % 60);
+    buffer[19] = '\0';
+}
+
+/**
+ * Escreve a linha de cabeçalho de uma consulta.
+ */
+void imprimir_consulta(Saida *saida, const Query *consulta) {
+    size_t len_trigrama = strlen(consulta->trigrama);
+    size_t len_expressao = strlen(consulta->expressao);
+    char *p = reservar_saida(saida, 32 + CURSOR_TAMANHO + len_trigrama + len_expressao);
+    char *inicio = p;
+
+    const char *agregacao = nome_agregacao(consulta->agregacao);
+    if (agregacao) {
+        // "COUNT expressão" ou "AVG prc expressão"
+        size_t len = strlen(agregacao);
+        memcpy(p, agregacao, len);
+        p += len;
+        if (consulta->agregacao != AGREGACAO_COUNT) {
+            memcpy(p, " prc", 4);
+            p += 4;
+        }
+    } else {
+        if (consulta->agregacao == CONSULTA_ITINERARIO) {
+            memcpy(p, "itn ", 4);
+            p += 4;
+        } else if (consulta->paginada) {
+            memcpy(p, "page ", 5);
+            p += 5;
+            if (consulta->tem_cursor) {
+                codificar_cursor(consulta, &consulta->cursor, p);
+                p += CURSOR_TAMANHO;
+                *p++ = ' ';
+            }
+        }
+        p += escrever_inteiro(p, consulta->max_voos);
+        *p++ = ' ';
+        memcpy(p, consulta->trigrama, len_trigrama);
+        p += len_trigrama;
+    }
+    *p++ = ' ';
+    memcpy(p, consulta->expressao, len_expressao);
+    p += len_expressao;
+    *p++ = '\n';
+
+    saida->tamanho += (size_t)(p - inicio);
+}
+
+/**
+ * Escreve um voo no formato "ORG DST preço assentos partida chegada paradas".
+ */
+void imprimir_voo(Saida *saida, const Flight *voo) {
+    char *p = reservar_saida(saida, SAIDA_MAX_LINHA);
+    char *inicio = p;
+
+    size_t len = strnlen(voo->origem, MAX_ORIGEM);
+    memcpy(p, voo->origem, len);
+    p += len;
+    *p++ = ' ';
+    len = strnlen(voo->destino, MAX_DESTINO);
+    memcpy(p, voo->destino, len);
+    p += len;
+    *p++ = ' ';
+    p += formatar_preco(voo->preco, p);
+    *p++ = ' ';
+    p += escrever_inteiro(p, voo->assentos);
+    *p++ = ' ';
+    formatar_data_cache(voo->partida, p);
+    p += 19;
+    *p++ = ' ';
+    formatar_data_cache(voo->chegada, p);
+    p += 19;
+    *p++ = ' ';
+    p += escrever_inteiro(p, voo->paradas);
+    *p++ = '\n';
+
+    saida->tamanho += (size_t)(p - inicio);
+}
+
+/**
+ * Escreve o resultado de uma consulta de agregação numa linha: a contagem,
+ * o preço (MIN/MAX, no formato dos voos) ou o valor com duas casas (AVG/SUM).
+ * Sem voos, MIN/MAX/AVG escrevem "-".
+ */
+void imprimir_agregacao(Saida *saida, const Query *consulta, const AgregadoPreco *agregado) {
+    char *p = reservar_saida(saida, SAIDA_MAX_LINHA);
+    char *inicio = p;
+
+    switch (consulta->agregacao) {
+        case AGREGACAO_COUNT:
+            p += escrever_inteiro(p, agregado->quantidade);
+            break;
+        case AGREGACAO_SUM:
+            p += snprintf(p, SAIDA_MAX_LINHA - 1, "%.2f", agregado->soma);
+            break;
+        default:
+            if (agregado->quantidade == 0) {
+                *p++ = '-';
+            } else if (consulta->agregacao == AGREGACAO_AVG) {
+                p += snprintf(p, SAIDA_MAX_LINHA - 1, "%.2f", agregado->soma / agregado->quantidade);
+            } else {
+                p += formatar_preco(consulta->agregacao == AGREGACAO_MIN ? agregado->minimo : agregado->maximo, p);
+            }
+            break;
+    }
+    *p++ = '\n';
+
+    saida->tamanho += (size_t)(p - inicio);
+}
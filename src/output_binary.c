@@ -0,0 +1,173 @@
+#include <math.h>
+#include "output_binary.h"
+#include "cursor.h"
+
+/**
+ * Descrição de uma coluna no cabeçalho do fluxo.
+ */
+typedef struct {
+    const char *nome;
+    TipoColuna tipo;
+    uint8_t largura;
+    uint16_t deslocamento;
+} DescricaoColuna;
+
+static const DescricaoColuna colunas[BINARIO_NUM_COLUNAS] = {
+    { "id", COLUNA_INTEIRO, 4, 0 },
+    { "origem", COLUNA_AEROPORTO, 4, 4 },
+    { "destino", COLUNA_AEROPORTO, 4, 8 },
+    { "preco", COLUNA_CENTAVOS, 4, 12 },
+    { "assentos", COLUNA_INTEIRO, 4, 16 },
+    { "paradas", COLUNA_INTEIRO, 4, 20 },
+    { "partida", COLUNA_EPOCA, 8, 24 },
+    { "chegada", COLUNA_EPOCA, 8, 32 },
+    { "preco_real", COLUNA_REAL, 4, 40 },
+};
+
+/**
+ * Copia um valor para o buffer e avança o ponteiro.
+ */
+static inline char *copiar(char *p, const void *valor, size_t tamanho) {
+    memcpy(p, valor, tamanho);
+    return p + tamanho;
+}
+
+/**
+ * Escreve o cabeçalho do fluxo com a descrição das colunas.
+ */
+void escrever_cabecalho_binario(Saida *saida) {
+    char *p = reservar_saida(saida, 12 + BINARIO_NUM_COLUNAS * 16);
+    char *inicio = p;
+    uint32_t versao = BINARIO_VERSAO;
+    uint16_t tamanho_linha = BINARIO_TAMANHO_LINHA, num_colunas = BINARIO_NUM_COLUNAS;
+
+    p = copiar(p, BINARIO_MAGICA, 4);
+    p = copiar(p, &versao, sizeof(versao));
+    p = copiar(p, &tamanho_linha, sizeof(tamanho_linha));
+    p = copiar(p, &num_colunas, sizeof(num_colunas));
+    for (int c = 0; c < BINARIO_NUM_COLUNAS; c++) {
+        char nome[12] = {0};
+        uint8_t tipo = (uint8_t)colunas[c].tipo;
+        memcpy(nome, colunas[c].nome, strlen(colunas[c].nome));
+        p = copiar(p, nome, sizeof(nome));
+        p = copiar(p, &tipo, 1);
+        p = copiar(p, &colunas[c].largura, 1);
+        p = copiar(p, &colunas[c].deslocamento, sizeof(uint16_t));
+    }
+    saida->tamanho += (size_t)(p - inicio);
+}
+
+/**
+ * Escreve o cabeçalho de um registro de consulta.
+ * @param tamanho_dados Bytes do registro depois do cabeçalho.
+ */
+static void escrever_registro(Saida *saida, const Query *consulta, uint32_t numero, uint32_t resultados,
+                              size_t tamanho_dados) {
+    char *p = reservar_saida(saida, BINARIO_TAMANHO_CABECALHO);
+    uint32_t tamanho = (uint32_t)(BINARIO_TAMANHO_CABECALHO - sizeof(uint32_t) + tamanho_dados);
+    uint8_t tipo = (uint8_t)consulta->agregacao;
+    uint8_t flags = consulta->paginada ? 1 : 0;
+    uint16_t reservado = 0;
+    int32_t max_voos = consulta->max_voos;
+    char trigrama[4] = {0};
+    memcpy(trigrama, consulta->trigrama, strnlen(consulta->trigrama, 3));
+
+    char *q = p;
+    q = copiar(q, &tamanho, sizeof(tamanho));
+    q = copiar(q, &tipo, 1);
+    q = copiar(q, &flags, 1);
+    q = copiar(q, &reservado, sizeof(reservado));
+    q = copiar(q, &max_voos, sizeof(max_voos));
+    q = copiar(q, trigrama, sizeof(trigrama));
+    q = copiar(q, &numero, sizeof(numero));
+    q = copiar(q, &resultados, sizeof(resultados));
+    saida->tamanho += (size_t)(q - p);
+}
+
+/**
+ * Escreve o cabeçalho de uma listagem.
+ */
+void escrever_listagem_binaria(Saida *saida, const Query *consulta, uint32_t numero, int num_voos) {
+    size_t dados = (size_t)num_voos * BINARIO_TAMANHO_LINHA + (consulta->paginada ? CURSOR_TAMANHO : 0);
+    escrever_registro(saida, consulta, numero, (uint32_t)num_voos, dados);
+}
+
+/**
+ * Escreve um voo na linha de largura fixa.
+ */
+void escrever_voo_binario(Saida *saida, const Flight *voo) {
+    char *p = reservar_saida(saida, BINARIO_TAMANHO_LINHA);
+    int32_t id = voo->id;
+    uint32_t origem = (uint32_t)chave_aeroporto(voo->origem);
+    uint32_t destino = (uint32_t)chave_aeroporto(voo->destino);
+    int32_t preco = (int32_t)preco_centavos(voo->preco);
+    int32_t assentos = voo->assentos, paradas = voo->paradas;
+    int64_t partida = (int64_t)voo->partida, chegada = (int64_t)voo->chegada;
+
+    char *q = p;
+    q = copiar(q, &id, 4);
+    q = copiar(q, &origem, 4);
+    q = copiar(q, &destino, 4);
+    q = copiar(q, &preco, 4);
+    q = copiar(q, &assentos, 4);
+    q = copiar(q, &paradas, 4);
+    q = copiar(q, &partida, 8);
+    q = copiar(q, &chegada, 8);
+    q = copiar(q, &voo->preco, 4);
+    saida->tamanho += BINARIO_TAMANHO_LINHA;
+}
+
+/**
+ * Escreve o cursor da próxima página (zeros quando não há mais voos).
+ */
+void escrever_cursor_binario(Saida *saida, const Query *consulta, const Flight *ultimo, int ha_mais) {
+    if (!consulta->paginada) return;
+    char cursor[CURSOR_TAMANHO + 1] = {0};
+    if (ha_mais && ultimo) codificar_cursor(consulta, ultimo, cursor);
+    escrever_saida(saida, cursor, CURSOR_TAMANHO);
+}
+
+/**
+ * Escreve o registro de uma agregação.
+ */
+void escrever_agregacao_binaria(Saida *saida, const Query *consulta, uint32_t numero, const AgregadoPreco *agregado) {
+    int64_t quantidade = agregado->quantidade;
+    double soma = agregado->soma;
+    int64_t minimo = quantidade > 0 ? preco_centavos(agregado->minimo) : 0;
+    int64_t maximo = quantidade > 0 ? preco_centavos(agregado->maximo) : 0;
+    float minimo_real = quantidade > 0 ? agregado->minimo : 0, maximo_real = quantidade > 0 ? agregado->maximo : 0;
+
+    escrever_registro(saida, consulta, numero, 1, 40);
+    char *p = reservar_saida(saida, 40);
+    char *q = p;
+    q = copiar(q, &quantidade, 8);
+    q = copiar(q, &soma, 8);
+    q = copiar(q, &minimo, 8);
+    q = copiar(q, &maximo, 8);
+    q = copiar(q, &minimo_real, 4);
+    q = copiar(q, &maximo_real, 4);
+    saida->tamanho += 40;
+}
+
+/**
+ * Escreve o registro de uma busca de itinerários.
+ */
+void escrever_itinerarios_binarios(Saida *saida, const Query *consulta, uint32_t numero, const Flight *voos,
+                                   const Itinerario *itinerarios, int num) {
+    size_t dados = 0;
+    for (int i = 0; i < num; i++) {
+        dados += sizeof(uint32_t) + (size_t)(1 + itinerarios[i].num_pernas) * BINARIO_TAMANHO_LINHA;
+    }
+    escrever_registro(saida, consulta, numero, (uint32_t)num, dados);
+
+    for (int i = 0; i < num; i++) {
+        uint32_t pernas = (uint32_t)itinerarios[i].num_pernas;
+        Flight resumo;
+        resumir_itinerario(voos, &itinerarios[i], &resumo);
+        escrever_saida(saida, (const char *)&pernas, sizeof(pernas));
+        escrever_voo_binario(saida, &resumo);
+        for (int p = 0; p < itinerarios[i].num_pernas; p++) {
+            escrever_voo_binario(saida, &voos[itinerarios[i].pernas[p]]);
+        }
+    }
+}
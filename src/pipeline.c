@@ -0,0 +1,164 @@
+#include <pthread.h>
+#include "pipeline.h"
+#include "ring_buffer.h"
+#include "expr_parser.h"
+#include "sort.h"
+#include "itinerary.h"
+#include "cursor.h"
+
+/**
+ * Consulta em trânsito pelo pipeline.
+ */
+typedef struct {
+    Query consulta;         // Consulta lida
+    ExprNode *expressao;    // Preenchida pela etapa de leitura
+    int *resultados;        // Ids selecionados, preenchidos pela etapa de execução
+    int num_resultados;
+    AgregadoPreco agregado; // Resultado de uma consulta de agregação
+    Itinerario *itinerarios; // Resultado de uma busca de itinerários
+    int fim;                // Marca o fim do fluxo (1) ou erro de leitura (-1)
+} ItemPipeline;
+
+/**
+ * Estado compartilhado entre as três etapas.
+ */
+typedef struct {
+    FILE *entrada;
+    int num_consultas;
+    const IndicesVoos *indices;
+    Flight *voos;
+    int n;
+    Saida *saida;
+    RingBuffer *lidas;       // Leitura -> execução
+    RingBuffer *executadas;  // Execução -> saída
+    int sucesso;             // Escrito apenas pela etapa de saída
+} Pipeline;
+
+static ItemPipeline *novo_item(void) {
+    ItemPipeline *item = calloc(1, sizeof(ItemPipeline));
+    if (!item) {
+        fprintf(stderr, "Erro ao alocar memória para o pipeline.\n");
+        exit(EXIT_FAILURE);
+    }
+    return item;
+}
+
+/**
+ * Etapa 1: lê e interpreta as consultas.
+ */
+static void *etapa_leitura(void *arg) {
+    Pipeline *p = arg;
+
+    for (int i = 0; i < p->num_consultas; i++) {
+        ItemPipeline *item = novo_item();
+        if (!carregar_consulta(p->entrada, &item->consulta)) {
+            item->fim = -1;
+            inserir_ring(p->lidas, item);
+            return NULL;
+        }
+        if (item->consulta.agregacao == AGREGACAO_NENHUMA) {
+            item->expressao = parse_expressao(item->consulta.expressao);
+        }
+        inserir_ring(p->lidas, item);
+    }
+
+    ItemPipeline *fim = novo_item();
+    fim->fim = 1;
+    inserir_ring(p->lidas, fim);
+    return NULL;
+}
+
+/**
+ * Etapa 2: filtra e ordena.
+ */
+static void *etapa_execucao(void *arg) {
+    Pipeline *p = arg;
+
+    while (1) {
+        ItemPipeline *item = remover_ring(p->lidas);
+        if (!item->fim && item->consulta.agregacao == CONSULTA_ITINERARIO) {
+            const RedeRotas *rede = rede_rotas_consulta(p->indices, p->voos, p->n);
+            item->num_resultados = executar_itinerarios(rede, p->voos, &item->consulta, &item->itinerarios);
+            liberar_rede_consulta(p->indices, rede);
+        } else if (!item->fim && item->consulta.agregacao != AGREGACAO_NENHUMA) {
+            agregar_voos(p->indices, p->voos, p->n, &item->consulta, &item->agregado);
+        } else if (!item->fim) {
+            item->num_resultados = filtrar_voos_expressao(p->indices, p->voos, p->n, item->expressao, &item->resultados);
+            item->num_resultados = aplicar_cursor(&item->consulta, p->voos, item->resultados, item->num_resultados);
+            ordenar_voos(p->voos, item->resultados, item->num_resultados, item->consulta.trigrama, item->consulta.max_voos);
+            liberar_expressao(item->expressao);
+            item->expressao = NULL;
+        }
+        inserir_ring(p->executadas, item);
+        if (item->fim) return NULL;
+    }
+}
+
+/**
+ * Etapa 3: formata os resultados na ordem de chegada.
+ */
+static void *etapa_saida(void *arg) {
+    Pipeline *p = arg;
+
+    while (1) {
+        ItemPipeline *item = remover_ring(p->executadas);
+        if (item->fim) {
+            p->sucesso = (item->fim == 1);
+            free(item);
+            return NULL;
+        }
+
+        imprimir_consulta(p->saida, &item->consulta);
+        if (item->consulta.agregacao == CONSULTA_ITINERARIO) {
+            imprimir_itinerarios(p->saida, p->voos, item->itinerarios, item->num_resultados);
+            free(item->itinerarios);
+            free(item);
+            continue;
+        }
+        if (item->consulta.agregacao != AGREGACAO_NENHUMA) {
+            imprimir_agregacao(p->saida, &item->consulta, &item->agregado);
+        }
+        int impressos = 0;
+        for (; impressos < item->consulta.max_voos && impressos < item->num_resultados; impressos++) {
+            imprimir_voo(p->saida, &p->voos[item->resultados[impressos]]);
+        }
+        imprimir_cursor(p->saida, &item->consulta, impressos > 0 ? &p->voos[item->resultados[impressos - 1]] : NULL,
+                        item->num_resultados > impressos);
+
+        free(item->resultados);
+        free(item);
+    }
+}
+
+/**
+ * Processa as consultas no pipeline de três etapas.
+ */
+int executar_pipeline(FILE *entrada, int num_consultas, const IndicesVoos *indices, Flight *voos, int n, Saida *saida) {
+    Pipeline p = {
+        .entrada = entrada,
+        .num_consultas = num_consultas,
+        .indices = indices,
+        .voos = voos,
+        .n = n,
+        .saida = saida,
+        .lidas = criar_ring_buffer(PIPELINE_CAPACIDADE),
+        .executadas = criar_ring_buffer(PIPELINE_CAPACIDADE),
+        .sucesso = 0
+    };
+
+    pthread_t leitura, execucao, formatacao;
+    if (pthread_create(&leitura, NULL, etapa_leitura, &p) != 0 ||
+        pthread_create(&execucao, NULL, etapa_execucao, &p) != 0 ||
+        pthread_create(&formatacao, NULL, etapa_saida, &p) != 0) {
+        fprintf(stderr, "Erro ao criar as threads do pipeline.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    pthread_join(leitura, NULL);
+    pthread_join(execucao, NULL);
+    pthread_join(formatacao, NULL);
+
+    liberar_ring_buffer(p.lidas);
+    liberar_ring_buffer(p.executadas);
+    return p.sucesso;
+}
@@ -0,0 +1,248 @@
+#include <stdio.h>
+#include <string.h>
+#include "posting.h"
+
+/**
+ * Desempacotadores de 32 valores com largura fixa. Com a largura conhecida em
+ * tempo de compilação o laço é totalmente desenrolado e vetorizável, sem
+ * desvios dependentes de dados.
+ */
+#define DEFINIR_DESEMPACOTAR(W)                                                   \
+    static void desempacotar_##W(const uint32_t *entrada, uint32_t *saida) {      \
+        for (int j = 0; j < 32; j++) {                                            \
+            const int bit = j * (W);                                              \
+            const int palavra = bit >> 5, desloc = bit & 31;                      \
+            uint64_t v = entrada[palavra];                                        \
+            if (desloc + (W) > 32) v |= (uint64_t)entrada[palavra + 1] << 32;     \
+            saida[j] = (uint32_t)((v >> desloc) & ((1ULL << (W)) - 1));           \
+        }                                                                         \
+    }
+
+DEFINIR_DESEMPACOTAR(1)  DEFINIR_DESEMPACOTAR(2)  DEFINIR_DESEMPACOTAR(3)  DEFINIR_DESEMPACOTAR(4)
+DEFINIR_DESEMPACOTAR(5)  DEFINIR_DESEMPACOTAR(6)  DEFINIR_DESEMPACOTAR(7)  DEFINIR_DESEMPACOTAR(8)
+DEFINIR_DESEMPACOTAR(9)  DEFINIR_DESEMPACOTAR(10) DEFINIR_DESEMPACOTAR(11) DEFINIR_DESEMPACOTAR(12)
+DEFINIR_DESEMPACOTAR(13) DEFINIR_DESEMPACOTAR(14) DEFINIR_DESEMPACOTAR(15) DEFINIR_DESEMPACOTAR(16)
+DEFINIR_DESEMPACOTAR(17) DEFINIR_DESEMPACOTAR(18) DEFINIR_DESEMPACOTAR(19) DEFINIR_DESEMPACOTAR(20)
+DEFINIR_DESEMPACOTAR(21) DEFINIR_DESEMPACOTAR(22) DEFINIR_DESEMPACOTAR(23) DEFINIR_DESEMPACOTAR(24)
+DEFINIR_DESEMPACOTAR(25) DEFINIR_DESEMPACOTAR(26) DEFINIR_DESEMPACOTAR(27) DEFINIR_DESEMPACOTAR(28)
+DEFINIR_DESEMPACOTAR(29) DEFINIR_DESEMPACOTAR(30) DEFINIR_DESEMPACOTAR(31) DEFINIR_DESEMPACOTAR(32)
+
+static void desempacotar_0(const uint32_t *entrada, uint32_t *saida) {
+    (void)entrada;
+    memset(saida, 0, 32 * sizeof(uint32_t));
+}
+
+static void (*const desempacotadores[33])(const uint32_t *, uint32_t *) = {
+    desempacotar_0,  desempacotar_1,  desempacotar_2,  desempacotar_3,
+    desempacotar_4,  desempacotar_5,  desempacotar_6,  desempacotar_7,
+    desempacotar_8,  desempacotar_9,  desempacotar_10, desempacotar_11,
+    desempacotar_12, desempacotar_13, desempacotar_14, desempacotar_15,
+    desempacotar_16, desempacotar_17, desempacotar_18, desempacotar_19,
+    desempacotar_20, desempacotar_21, desempacotar_22, desempacotar_23,
+    desempacotar_24, desempacotar_25, desempacotar_26, desempacotar_27,
+    desempacotar_28, desempacotar_29, desempacotar_30, desempacotar_31,
+    desempacotar_32
+};
+
+/**
+ * Número de bits necessários para representar `v`.
+ */
+static int bits_necessarios(uint32_t v) {
+    return v ? 32 - __builtin_clz(v) : 0;
+}
+
+/**
+ * Empacota 32 valores com `largura` bits cada (ocupa `largura` palavras).
+ * Com largura 0 (ids consecutivos) o grupo não ocupa nenhuma palavra e
+ * `saida` pode já estar além do fim dos dados.
+ */
+static void empacotar_grupo(const uint32_t *valores, int largura, uint32_t *saida) {
+    if (largura == 0) return;
+    memset(saida, 0, largura * sizeof(uint32_t));
+    for (int j = 0; j < 32; j++) {
+        int bit = j * largura;
+        int palavra = bit >> 5, desloc = bit & 31;
+        uint64_t v = (uint64_t)valores[j] << desloc;
+        saida[palavra] |= (uint32_t)v;
+        if (desloc + largura > 32) saida[palavra + 1] |= (uint32_t)(v >> 32);
+    }
+}
+
+/**
+ * Comprime uma lista de índices em ordem crescente estrita.
+ */
+ListaPostings *comprimir_postings(const int *indices, int n) {
+    ListaPostings *lista = malloc(sizeof(ListaPostings));
+    if (!lista) {
+        fprintf(stderr, "Erro ao alocar memória para postings.\n");
+        exit(EXIT_FAILURE);
+    }
+    lista->total = n;
+    lista->num_blocos = (n + POSTINGS_BLOCO - 1) / POSTINGS_BLOCO;
+    lista->blocos = malloc((lista->num_blocos ? lista->num_blocos : 1) * sizeof(BlocoPostings));
+
+    // Primeira passada: larguras e tamanho total dos dados
+    uint32_t deltas[POSTINGS_BLOCO];
+    size_t palavras = 0;
+    for (int b = 0; b < lista->num_blocos; b++) {
+        int inicio = b * POSTINGS_BLOCO;
+        int qtd = n - inicio < POSTINGS_BLOCO ? n - inicio : POSTINGS_BLOCO;
+        uint32_t maior = 0;
+        for (int i = 1; i < qtd; i++) {
+            uint32_t d = (uint32_t)(indices[inicio + i] - indices[inicio + i - 1] - 1);
+            if (d > maior) maior = d;
+        }
+        BlocoPostings *bloco = &lista->blocos[b];
+        bloco->primeiro = indices[inicio];
+        bloco->ultimo = indices[inicio + qtd - 1];
+        bloco->quantidade = (uint8_t)qtd;
+        bloco->largura = (uint8_t)bits_necessarios(maior);
+        bloco->deslocamento = (uint32_t)palavras;
+        palavras += (size_t)bloco->largura * (POSTINGS_BLOCO / 32);
+    }
+
+    lista->dados = malloc((palavras ? palavras : 1) * sizeof(uint32_t));
+    if (!lista->blocos || !lista->dados) {
+        fprintf(stderr, "Erro ao alocar memória para postings.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Segunda passada: empacota os deltas (com zeros completando o último bloco)
+    for (int b = 0; b < lista->num_blocos; b++) {
+        int inicio = b * POSTINGS_BLOCO;
+        int qtd = n - inicio < POSTINGS_BLOCO ? n - inicio : POSTINGS_BLOCO;
+        deltas[0] = 0;
+        for (int i = 1; i < POSTINGS_BLOCO; i++) {
+            deltas[i] = i < qtd ? (uint32_t)(indices[inicio + i] - indices[inicio + i - 1] - 1) : 0;
+        }
+        BlocoPostings *bloco = &lista->blocos[b];
+        for (int g = 0; g < POSTINGS_BLOCO / 32; g++) {
+            empacotar_grupo(deltas + g * 32, bloco->largura,
+                            lista->dados + bloco->deslocamento + (size_t)g * bloco->largura);
+        }
+    }
+    return lista;
+}
+
+/**
+ * Libera uma lista comprimida.
+ */
+void liberar_postings(ListaPostings *lista) {
+    if (!lista) return;
+    free(lista->blocos);
+    free(lista->dados);
+    free(lista);
+}
+
+/**
+ * Decodifica um bloco: desempacota os deltas e faz a soma prefixada.
+ */
+int decodificar_bloco_postings(const ListaPostings *lista, int bloco, int *destino) {
+    const BlocoPostings *b = &lista->blocos[bloco];
+    int qtd = b->quantidade;
+    uint32_t deltas[POSTINGS_BLOCO];
+
+    const uint32_t *dados = lista->dados + b->deslocamento;
+    for (int g = 0; g < POSTINGS_BLOCO / 32; g++) {
+        desempacotadores[b->largura](dados + g * b->largura, deltas + g * 32);
+    }
+
+    int atual = b->primeiro;
+    destino[0] = atual;
+    for (int i = 1; i < qtd; i++) {
+        atual += (int)deltas[i] + 1;
+        destino[i] = atual;
+    }
+    return qtd;
+}
+
+/**
+ * Decodifica a lista inteira.
+ */
+int descomprimir_postings(const ListaPostings *lista, int *destino) {
+    int total = 0;
+    for (int b = 0; b < lista->num_blocos; b++) {
+        total += decodificar_bloco_postings(lista, b, destino + total);
+    }
+    return total;
+}
+
+/**
+ * Primeiro bloco a partir de `inicio` cujo último índice é >= valor
+ * (busca exponencial seguida de busca binária na tabela de saltos).
+ */
+static int procurar_bloco(const ListaPostings *lista, int inicio, int valor) {
+    int passo = 1, fim = inicio;
+    while (fim < lista->num_blocos && lista->blocos[fim].ultimo < valor) {
+        inicio = fim + 1;
+        fim += passo;
+        passo <<= 1;
+    }
+    if (fim > lista->num_blocos) fim = lista->num_blocos;
+
+    while (inicio < fim) {
+        int meio = inicio + (fim - inicio) / 2;
+        if (lista->blocos[meio].ultimo < valor) inicio = meio + 1;
+        else fim = meio;
+    }
+    return inicio;
+}
+
+/**
+ * Intersecciona um vetor ordenado com a lista comprimida, pulando blocos.
+ */
+int intersectar_postings(const int *candidatos, int n, const ListaPostings *lista, int *destino) {
+    int buffer[POSTINGS_BLOCO];
+    int bloco = 0, decodificado = -1, qtd = 0, pos = 0, total = 0;
+
+    for (int i = 0; i < n && bloco < lista->num_blocos; i++) {
+        int x = candidatos[i];
+
+        if (lista->blocos[bloco].ultimo < x) {
+            bloco = procurar_bloco(lista, bloco + 1, x);
+            if (bloco >= lista->num_blocos) break;
+        }
+        if (x < lista->blocos[bloco].primeiro) continue;
+
+        if (decodificado != bloco) {
+            qtd = decodificar_bloco_postings(lista, bloco, buffer);
+            decodificado = bloco;
+            pos = 0;
+        }
+        while (pos < qtd && buffer[pos] < x) pos++;
+        if (pos < qtd && buffer[pos] == x) destino[total++] = x;
+    }
+    return total;
+}
+
+/**
+ * Memória ocupada pela lista comprimida, em bytes.
+ */
+size_t memoria_postings(const ListaPostings *lista) {
+    if (!lista) return 0;
+    size_t palavras = 0;
+    for (int b = 0; b < lista->num_blocos; b++) {
+        palavras += (size_t)lista->blocos[b].largura * (POSTINGS_BLOCO / 32);
+    }
+    return sizeof(ListaPostings) + lista->num_blocos * sizeof(BlocoPostings) + palavras * sizeof(uint32_t);
+}
+
+/**
+ * Memória que a lista ocuparia comprimida (a de memoria_postings depois de
+ * comprimir_postings), calculada sem alocar nem empacotar.
+ */
+size_t estimar_memoria_postings(const int *indices, int n) {
+    int num_blocos = (n + POSTINGS_BLOCO - 1) / POSTINGS_BLOCO;
+    size_t palavras = 0;
+    for (int b = 0; b < num_blocos; b++) {
+        int inicio = b * POSTINGS_BLOCO;
+        int qtd = n - inicio < POSTINGS_BLOCO ? n - inicio : POSTINGS_BLOCO;
+        uint32_t maior = 0;
+        for (int i = 1; i < qtd; i++) {
+            uint32_t d = (uint32_t)(indices[inicio + i] - indices[inicio + i - 1] - 1);
+            if (d > maior) maior = d;
+        }
+        palavras += (size_t)bits_necessarios(maior) * (POSTINGS_BLOCO / 32);
+    }
+    return sizeof(ListaPostings) + num_blocos * sizeof(BlocoPostings) + palavras * sizeof(uint32_t);
+}
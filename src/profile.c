@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "profile.h"
+#include "capture.h"
+
+#define PERFIL_MAX_ANINHAMENTO 8  // Fases abertas ao mesmo tempo
+#define NUM_CONTADORES 5
+
+/**
+ * Contador de hardware medido.
+ */
+typedef struct {
+    const char *nome;
+    uint32_t tipo;
+    uint64_t config;
+} DescricaoContador;
+
+static const DescricaoContador descricoes[NUM_CONTADORES] = {
+    { "ciclos", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { "instrucoes", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { "falhas L1d", PERF_TYPE_HW_CACHE,
+      PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { "falhas LLC", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { "erros desvio", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+static const char *nomes_fases[NUM_FASES] = {
+    "carga", "indices", "parse", "avaliacao", "ordenacao", "saida"
+};
+
+// Estado do perfil (só a thread dona o altera)
+static int ativo = 0;
+static pthread_t dono;
+static int fds[NUM_CONTADORES];
+static uint64_t ultima_leitura[NUM_CONTADORES + 1];         // Contadores e tempo (ns) na última troca de fase
+static uint64_t acumulado[NUM_FASES][NUM_CONTADORES + 1];
+static long entradas[NUM_FASES];
+static int pilha[PERFIL_MAX_ANINHAMENTO];
+static int profundidade = 0;
+
+/**
+ * Abre um contador da thread atual (e das threads que ela criar), só em espaço de usuário.
+ * @return Descritor, ou -1 se o contador não estiver disponível.
+ */
+static int abrir_contador(const DescricaoContador *d) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = d->tipo;
+    attr.config = d->config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.inherit = 1;
+    // Com multiplexação o contador não fica ativo o tempo todo; os tempos permitem escalar
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/**
+ * Lê os contadores (escalados pela fração de tempo em que estiveram ativos) e o relógio.
+ */
+static void ler_contadores(uint64_t *valores) {
+    for (int c = 0; c < NUM_CONTADORES; c++) {
+        uint64_t leitura[3];  // valor, tempo habilitado, tempo em execução
+        if (fds[c] < 0 || read(fds[c], leitura, sizeof(leitura)) != sizeof(leitura)) {
+            valores[c] = 0;
+            continue;
+        }
+        valores[c] = leitura[2] > 0 && leitura[2] < leitura[1]
+                         ? (uint64_t)((double)leitura[0] * leitura[1] / leitura[2])
+                         : leitura[0];
+    }
+    valores[NUM_CONTADORES] = relogio_ns();
+}
+
+/**
+ * Atribui à fase aberta o que foi contado desde a última troca.
+ */
+static void trocar_fase() {
+    uint64_t atual[NUM_CONTADORES + 1];
+    ler_contadores(atual);
+    if (profundidade > 0 && profundidade <= PERFIL_MAX_ANINHAMENTO) {
+        int fase = pilha[profundidade - 1];
+        for (int c = 0; c <= NUM_CONTADORES; c++) {
+            acumulado[fase][c] += atual[c] - ultima_leitura[c];
+        }
+    }
+    memcpy(ultima_leitura, atual, sizeof(atual));
+}
+
+static void imprimir_perfil_na_saida() {
+    imprimir_perfil();
+}
+
+/**
+ * Abre os contadores e passa a medir a thread atual.
+ */
+int ativar_perfil() {
+    if (ativo) return 0;
+
+    int disponiveis = 0;
+    for (int c = 0; c < NUM_CONTADORES; c++) {
+        fds[c] = abrir_contador(&descricoes[c]);
+        if (fds[c] >= 0) disponiveis++;
+    }
+    if (disponiveis == 0) {
+        fprintf(stderr, "Perfil: contadores de hardware indisponíveis; apenas o tempo por fase será medido.\n");
+    }
+
+    dono = pthread_self();
+    ativo = 1;
+    ler_contadores(ultima_leitura);
+    atexit(imprimir_perfil_na_saida);
+    return disponiveis;
+}
+
+/**
+ * Abre uma fase.
+ */
+void entrar_fase(FasePerfil fase) {
+    if (!ativo || !pthread_equal(pthread_self(), dono)) return;
+    trocar_fase();
+    if (profundidade < PERFIL_MAX_ANINHAMENTO) pilha[profundidade] = fase;
+    profundidade++;
+    entradas[fase]++;
+}
+
+/**
+ * Fecha a fase mais interna.
+ */
+void sair_fase() {
+    if (!ativo || !pthread_equal(pthread_self(), dono) || profundidade == 0) return;
+    trocar_fase();
+    profundidade--;
+}
+
+/**
+ * Escreve um valor da tabela, ou "n/d" se o contador não estiver disponível.
+ */
+static void imprimir_valor(int contador, uint64_t valor) {
+    if (fds[contador] < 0) {
+        fprintf(stderr, " %14s", "n/d");
+    } else {
+        fprintf(stderr, " %14llu", (unsigned long long)valor);
+    }
+}
+
+/**
+ * Imprime uma linha da tabela.
+ */
+static void imprimir_linha(const char *nome, long chamadas, const uint64_t *valores) {
+    fprintf(stderr, "%-10s %9ld %11.3f", nome, chamadas, valores[NUM_CONTADORES] / 1e6);
+    for (int c = 0; c < NUM_CONTADORES; c++) {
+        imprimir_valor(c, valores[c]);
+    }
+    if (fds[0] >= 0 && fds[1] >= 0 && valores[0] > 0) {
+        fprintf(stderr, " %6.2f\n", (double)valores[1] / valores[0]);
+    } else {
+        fprintf(stderr, " %6s\n", "n/d");
+    }
+}
+
+/**
+ * Imprime a tabela de contadores por fase.
+ */
+void imprimir_perfil() {
+    if (!ativo) return;
+
+    fprintf(stderr, "%-10s %9s %11s", "fase", "chamadas", "tempo (ms)");
+    for (int c = 0; c < NUM_CONTADORES; c++) {
+        fprintf(stderr, " %14s", descricoes[c].nome);
+    }
+    fprintf(stderr, " %6s\n", "IPC");
+
+    uint64_t total[NUM_CONTADORES + 1] = {0};
+    long total_chamadas = 0;
+    for (int f = 0; f < NUM_FASES; f++) {
+        imprimir_linha(nomes_fases[f], entradas[f], acumulado[f]);
+        for (int c = 0; c <= NUM_CONTADORES; c++) total[c] += acumulado[f][c];
+        total_chamadas += entradas[f];
+    }
+    imprimir_linha("total", total_chamadas, total);
+}
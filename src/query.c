@@ -1,80 +1,650 @@
 #include "query.h"
 #include "expr_parser.h"
+#include "itinerary.h"
+#include "cursor.h"
 
-// Árvores AVL globais para indexação dos voos
-struct AVLTree *indice_origem;
-struct AVLTree *indice_destino;
-struct AVLTree *indice_preco;
-struct AVLTree *indice_assentos;
-struct AVLTree *indice_duracao;
-struct AVLTree *indice_paradas;
+#include "thread_pool.h"
+#include "epoch.h"
+#include "profile.h"
+#include <pthread.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+
+#define LIMIAR_CONSTRUCAO_PARALELA 4096  // Abaixo disso a inserção um a um é suficiente
+#define VOOS_POR_PARTICAO 65536          // Tamanho mínimo de uma faixa de chaves
+#define AMOSTRAS_POR_PARTICAO 32         // Amostras usadas para escolher os divisores
+
+// Threads usadas na construção dos índices (0 = processadores disponíveis)
+static int threads_indices = 0;
+
+/**
+ * Estado da construção em lote de um índice.
+ */
+typedef struct {
+    AVLTree *arvore;                   // Árvore de destino
+    Flight *voos;
+    int n;
+    CampoIndice campo;                 // Campo indexado
+    char (*chaves)[TAM_CHAVE_INDICE];  // Chave de cada voo
+    int num_particoes;                 // Faixas de chaves construídas em paralelo
+    char (*divisores)[TAM_CHAVE_INDICE]; // Limites entre faixas (num_particoes - 1)
+    int *ids;                          // Ids agrupados por faixa (em ordem crescente em cada faixa)
+    int *inicio_particao;              // Início de cada faixa em `ids` (num_particoes + 1)
+    AVLNode ***nos;                    // Nós gerados por faixa, em ordem de chave
+    int *num_nos;                      // Quantidade de nós por faixa
+} ConstrucaoIndice;
+
+/**
+ * Uma faixa de chaves de um índice.
+ */
+typedef struct {
+    ConstrucaoIndice *construcao;
+    int particao;
+} TarefaParticao;
+
+/**
+ * Par (chave, id) usado na ordenação de uma faixa.
+ */
+typedef struct {
+    const char *chave;
+    int id;
+} ParChave;
+
+/**
+ * Cria um conjunto de índices com as seis árvores vazias.
+ */
+IndicesVoos *criar_indices() {
+    IndicesVoos *indices = malloc(sizeof(IndicesVoos));
+    if (!indices) {
+        fprintf(stderr, "Erro ao alocar memória para os índices.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+        indices->arvores[f] = criar_avl();
+    }
+    indices->rotas = NULL;
+    pthread_mutex_init(&indices->trava_escrita, NULL);
+    return indices;
+}
+
+/**
+ * Libera as árvores e o conjunto de índices.
+ */
+void liberar_indices(IndicesVoos *indices) {
+    if (!indices) return;
+    for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+        liberar_avl(indices->arvores[f]->raiz);
+        free(indices->arvores[f]);
+    }
+    liberar_rede_rotas(indices->rotas);
+    pthread_mutex_destroy(&indices->trava_escrita);
+    free(indices);
+}
+
+/**
+ * Define quantas threads a construção dos índices usa (0 = processadores disponíveis).
+ */
+void definir_threads_indices(int num_threads) {
+    threads_indices = num_threads;
+}
+
+/**
+ * Popula as árvores AVL e a rede de rotas com os voos.
+ * @param indices Índices de destino.
+ * @param voos Vetor de voos.
+ * @param n Quantidade total de voos.
+ */
+void construir_indices(IndicesVoos *indices, Flight *voos, int n) {
+    construir_arvores_indices(indices->arvores, voos, n);
+    indices->rotas = construir_rede_rotas(voos, n);
+}
 
 /**
- * Inicializa as árvores AVL para indexação.
+ * Rede de rotas para uma busca de itinerários: a dos índices ou, quando o
+ * plano de índices não a incluiu, uma rede temporária montada só para a
+ * busca (a memória volta ao fim dela, dentro do orçamento do plano).
+ * @param indices Índices da tabela.
+ * @param voos Vetor de voos.
+ * @param n Quantidade total de voos.
+ * @return Rede (devolver com liberar_rede_consulta).
  */
-void inicializar_indices() {
-    indice_origem = criar_avl();
-    indice_destino = criar_avl();
-    indice_preco = criar_avl();
-    indice_assentos = criar_avl();
-    indice_duracao = criar_avl();
-    indice_paradas = criar_avl();
+const RedeRotas *rede_rotas_consulta(const IndicesVoos *indices, const Flight *voos, int n) {
+    if (indices->rotas) return indices->rotas;
+    entrar_fase(FASE_INDICES);
+    RedeRotas *rede = construir_rede_rotas(voos, n);
+    sair_fase();
+    return rede;
 }
 
 /**
- * Popula as árvores AVL com os voos.
+ * Devolve a rede obtida com rede_rotas_consulta, liberando a temporária.
+ */
+void liberar_rede_consulta(const IndicesVoos *indices, const RedeRotas *rede) {
+    if (rede != indices->rotas) liberar_rede_rotas((RedeRotas *)rede);
+}
+
+/**
+ * Popula um conjunto de seis árvores (na ordem de CampoIndice) com os voos.
+ * Os ids nas listas são as posições em `voos`. Árvores marcadas como
+ * ausentes (fora do plano de índices) ficam vazias.
+ * @param arvores Árvores de destino, uma por campo.
  * @param voos Vetor de voos.
  * @param n Quantidade total de voos.
  */
-void construir_indices(Flight *voos, int n) {
-    char chave[20];
+void construir_arvores_indices(AVLTree *arvores[], Flight *voos, int n) {
+    // Tabelas grandes: construção em lote, em paralelo por índice e por faixa de chaves
+    if (n >= LIMIAR_CONSTRUCAO_PARALELA) {
+        construir_indices_paralelo(arvores, voos, n, threads_indices > 0 ? threads_indices : processadores_disponiveis());
+    } else {
+        char chave[TAM_CHAVE_INDICE];
 
-    for (int i = 0; i < n; i++) {
-        indice_origem->raiz = inserir_avl(indice_origem->raiz, voos[i].origem, i);
-        indice_destino->raiz = inserir_avl(indice_destino->raiz, voos[i].destino, i);
+        for (int i = 0; i < n; i++) {
+            for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+                if (arvores[f]->ausente) continue;
+                formatar_chave_indice(&voos[i], (CampoIndice)f, chave);
+                arvores[f]->raiz = inserir_avl(arvores[f]->raiz, chave, i);
+            }
+        }
+    }
 
-        sprintf(chave, "%.2f", voos[i].preco);
-        indice_preco->raiz = inserir_avl(indice_preco->raiz, chave, i);
+    // Contagens e agregados de preço por subárvore (consultas COUNT/MIN/MAX/AVG)
+    for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+        calcular_agregados_avl(arvores[f]->raiz, voos);
+    }
+}
+
+/**
+ * Formata a chave de um voo para o índice do campo (mesmo formato da busca).
+ */
+void formatar_chave_indice(const Flight *voo, CampoIndice campo, char *chave) {
+    switch (campo) {
+        case CAMPO_ORIGEM: snprintf(chave, TAM_CHAVE_INDICE, "%s", voo->origem); break;
+        case CAMPO_DESTINO: snprintf(chave, TAM_CHAVE_INDICE, "%s", voo->destino); break;
+        case CAMPO_PRECO: {
+            // A partir dos centavos de preco_centavos, a mesma chave dos demais motores
+            int64_t centavos = preco_centavos(voo->preco);
+            int64_t absoluto = centavos < 0 ? -centavos : centavos;
+            snprintf(chave, TAM_CHAVE_INDICE, "%s%lld.%02lld", centavos < 0 ? "-" : "", (long long)(absoluto / 100),
+                     (long long)(absoluto % 100));
+            break;
+        }
+        case CAMPO_ASSENTOS: snprintf(chave, TAM_CHAVE_INDICE, "%d", voo->assentos); break;
+        case CAMPO_DURACAO: snprintf(chave, TAM_CHAVE_INDICE, "%d", voo->duracao); break;
+        case CAMPO_PARADAS: snprintf(chave, TAM_CHAVE_INDICE, "%d", voo->paradas); break;
+        default: chave[0] = '\0'; break;
+    }
+}
 
-        sprintf(chave, "%d", voos[i].assentos);
-        indice_assentos->raiz = inserir_avl(indice_assentos->raiz, chave, i);
+static int comparar_chaves(const void *a, const void *b) {
+    return strcmp((const char *)a, (const char *)b);
+}
 
-        sprintf(chave, "%d", voos[i].duracao);
-        indice_duracao->raiz = inserir_avl(indice_duracao->raiz, chave, i);
+static int comparar_pares(const void *a, const void *b) {
+    const ParChave *x = a, *y = b;
+    int c = strcmp(x->chave, y->chave);
+    if (c != 0) return c;
+    return (x->id > y->id) - (x->id < y->id);
+}
 
-        sprintf(chave, "%d", voos[i].paradas);
-        indice_paradas->raiz = inserir_avl(indice_paradas->raiz, chave, i);
+/**
+ * Faixa de uma chave: primeira faixa cujo divisor é maior que a chave.
+ */
+static int particao_da_chave(const ConstrucaoIndice *c, const char *chave) {
+    int ini = 0, fim = c->num_particoes - 1;
+    while (ini < fim) {
+        int meio = (ini + fim) / 2;
+        if (strcmp(chave, c->divisores[meio]) < 0) fim = meio;
+        else ini = meio + 1;
     }
+    return ini;
 }
 
 /**
- * Filtra os voos conforme a consulta usando AVL e árvore de expressões.
- * @param voos Vetor de voos.
- * @param n Quantidade total de voos.
- * @param consulta Ponteiro para a consulta a ser aplicada.
- * @param resultados Ponteiro para armazenar os voos filtrados.
- * @return Número de voos que passaram no filtro.
+ * Fase 1 (uma tarefa por índice): formata as chaves, escolhe os divisores por
+ * amostragem e distribui os ids entre as faixas.
  */
-int filtrar_voos(Flight *voos, int n, const Query *consulta, Flight **resultados) {
-    *resultados = (Flight *)malloc(n * sizeof(Flight));
-    if (*resultados == NULL) {
+static void tarefa_preparar_indice(void *arg) {
+    ConstrucaoIndice *c = arg;
+
+    for (int i = 0; i < c->n; i++) {
+        formatar_chave_indice(&c->voos[i], c->campo, c->chaves[i]);
+    }
+
+    // Divisores: quantis de uma amostra regular das chaves
+    int num_amostras = c->num_particoes * AMOSTRAS_POR_PARTICAO;
+    if (num_amostras > c->n) num_amostras = c->n;
+    char (*amostra)[TAM_CHAVE_INDICE] = malloc((num_amostras ? num_amostras : 1) * sizeof(*amostra));
+    if (!amostra) {
         fprintf(stderr, "Erro de alocação de memória.\n");
         exit(EXIT_FAILURE);
     }
+    for (int i = 0; i < num_amostras; i++) {
+        memcpy(amostra[i], c->chaves[(long)i * c->n / num_amostras], TAM_CHAVE_INDICE);
+    }
+    qsort(amostra, num_amostras, sizeof(*amostra), comparar_chaves);
+    for (int p = 1; p < c->num_particoes; p++) {
+        memcpy(c->divisores[p - 1], amostra[(long)p * num_amostras / c->num_particoes], TAM_CHAVE_INDICE);
+    }
+    free(amostra);
 
-    // Converte a string da consulta em árvore de expressão
+    // Distribuição estável (contagem) dos ids pelas faixas
+    int *faixa = malloc(c->n * sizeof(int));
+    if (!faixa) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(c->inicio_particao, 0, (c->num_particoes + 1) * sizeof(int));
+    for (int i = 0; i < c->n; i++) {
+        faixa[i] = particao_da_chave(c, c->chaves[i]);
+        c->inicio_particao[faixa[i] + 1]++;
+    }
+    for (int p = 0; p < c->num_particoes; p++) {
+        c->inicio_particao[p + 1] += c->inicio_particao[p];
+    }
+    int *pos = malloc(c->num_particoes * sizeof(int));
+    if (!pos) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(pos, c->inicio_particao, c->num_particoes * sizeof(int));
+    for (int i = 0; i < c->n; i++) {
+        c->ids[pos[faixa[i]]++] = i;
+    }
+    free(pos);
+    free(faixa);
+}
+
+/**
+ * Fase 2 (uma tarefa por faixa de cada índice): ordena os pares da faixa e
+ * agrupa as chaves iguais em nós.
+ */
+static void tarefa_construir_particao(void *arg) {
+    TarefaParticao *t = arg;
+    ConstrucaoIndice *c = t->construcao;
+    int inicio = c->inicio_particao[t->particao];
+    int total = c->inicio_particao[t->particao + 1] - inicio;
+
+    c->nos[t->particao] = NULL;
+    c->num_nos[t->particao] = 0;
+    if (total == 0) return;
+
+    ParChave *pares = malloc(total * sizeof(ParChave));
+    AVLNode **nos = malloc(total * sizeof(AVLNode *));
+    if (!pares || !nos) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < total; i++) {
+        pares[i].id = c->ids[inicio + i];
+        pares[i].chave = c->chaves[pares[i].id];
+    }
+    qsort(pares, total, sizeof(ParChave), comparar_pares);
+
+    int num_nos = 0;
+    for (int i = 0; i < total;) {
+        int j = i + 1;
+        while (j < total && strcmp(pares[j].chave, pares[i].chave) == 0) j++;
+
+        int *indices = malloc((j - i) * sizeof(int));
+        for (int k = i; k < j; k++) indices[k - i] = pares[k].id;
+        nos[num_nos++] = criar_no_avl(pares[i].chave, indices, j - i);
+        i = j;
+    }
+
+    free(pares);
+    c->nos[t->particao] = nos;
+    c->num_nos[t->particao] = num_nos;
+}
+
+/**
+ * Constrói os seis índices em lote: uma tarefa por índice e, dentro de cada
+ * índice, uma tarefa por faixa de chaves. As faixas são disjuntas e ordenadas,
+ * então os nós de todas são concatenados e montados numa AVL balanceada.
+ * @param arvores Árvores de destino, uma por campo (na ordem de CampoIndice).
+ * @param voos Vetor de voos.
+ * @param n Quantidade total de voos.
+ * @param num_threads Threads do pool.
+ */
+void construir_indices_paralelo(AVLTree *arvores[], Flight *voos, int n, int num_threads) {
+    int num_particoes = n / VOOS_POR_PARTICAO;
+    if (num_particoes > num_threads) num_particoes = num_threads;
+    if (num_particoes < 1) num_particoes = 1;
+
+    ThreadPool *pool = criar_pool(num_threads);
+    ConstrucaoIndice construcoes[NUM_CAMPOS_INDICE];
+
+    for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+        if (arvores[f]->ausente) continue;
+        ConstrucaoIndice *c = &construcoes[f];
+        c->arvore = arvores[f];
+        c->voos = voos;
+        c->n = n;
+        c->campo = (CampoIndice)f;
+        c->num_particoes = num_particoes;
+        c->chaves = malloc((size_t)n * sizeof(*c->chaves));
+        c->divisores = malloc(num_particoes * sizeof(*c->divisores));
+        c->ids = malloc((size_t)n * sizeof(int));
+        c->inicio_particao = malloc((num_particoes + 1) * sizeof(int));
+        c->nos = malloc(num_particoes * sizeof(AVLNode **));
+        c->num_nos = malloc(num_particoes * sizeof(int));
+        if (!c->chaves || !c->divisores || !c->ids || !c->inicio_particao || !c->nos || !c->num_nos) {
+            fprintf(stderr, "Erro de alocação de memória.\n");
+            exit(EXIT_FAILURE);
+        }
+        submeter_tarefa(pool, tarefa_preparar_indice, c);
+    }
+    aguardar_pool(pool);
+
+    TarefaParticao *tarefas = malloc(NUM_CAMPOS_INDICE * num_particoes * sizeof(TarefaParticao));
+    for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+        if (arvores[f]->ausente) continue;
+        for (int p = 0; p < num_particoes; p++) {
+            TarefaParticao *t = &tarefas[f * num_particoes + p];
+            t->construcao = &construcoes[f];
+            t->particao = p;
+            submeter_tarefa(pool, tarefa_construir_particao, t);
+        }
+    }
+    aguardar_pool(pool);
+    destruir_pool(pool);
+    free(tarefas);
+
+    // Costura: concatena as faixas na ordem e monta a árvore balanceada
+    for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+        if (arvores[f]->ausente) continue;
+        ConstrucaoIndice *c = &construcoes[f];
+        int total = 0;
+        for (int p = 0; p < num_particoes; p++) total += c->num_nos[p];
+
+        AVLNode **nos = malloc((total ? total : 1) * sizeof(AVLNode *));
+        int pos = 0;
+        for (int p = 0; p < num_particoes; p++) {
+            if (c->num_nos[p]) memcpy(nos + pos, c->nos[p], c->num_nos[p] * sizeof(AVLNode *));
+            pos += c->num_nos[p];
+            free(c->nos[p]);
+        }
+
+        liberar_avl(c->arvore->raiz);
+        c->arvore->raiz = construir_avl_balanceada(nos, 0, total - 1);
+
+        free(nos);
+        free(c->chaves);
+        free(c->divisores);
+        free(c->ids);
+        free(c->inicio_particao);
+        free(c->nos);
+        free(c->num_nos);
+    }
+}
+
+/**
+ * Comprime as listas de índices de todas as árvores (postings em blocos).
+ */
+void comprimir_indices(IndicesVoos *indices) {
+    for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+        comprimir_avl(indices->arvores[f]->raiz);
+    }
+}
+
+/**
+ * Atualiza o preço ou os assentos de um voo com os índices em uso.
+ *
+ * As árvores são alteradas numa versão privada (copy-on-write do caminho),
+ * publicada com uma única troca atômica da raiz. Para que cada versão só
+ * associe o voo a uma chave de acordo com a linha, a troca de chave é feita
+ * em três passos: o voo sai da chave antiga, a atualização espera as
+ * leituras que ainda podem encontrá-lo por ela, a linha é alterada e só
+ * então o voo entra na chave nova (durante a troca, as consultas por esse
+ * campo não o encontram). Os nós substituídos são aposentados e liberados
+ * pelo coletor de épocas quando nenhuma leitura puder mais alcançá-los.
+ * @param indices Índices da tabela.
+ * @param voos Vetor de voos.
+ * @param n Quantidade total de voos.
+ * @param id Posição do voo no vetor.
+ * @param campo "prc" ou "sea".
+ * @param valor Novo valor: preço real ou assentos inteiros, não negativos.
+ * @return 1 se o voo foi atualizado, 0 se o id, o campo ou o valor forem inválidos.
+ */
+int atualizar_voo(IndicesVoos *indices, Flight *voos, int n, int id, const char *campo, const char *valor) {
+    int indice_campo = campo_indice(campo);
+    if (id < 0 || id >= n || (indice_campo != CAMPO_PRECO && indice_campo != CAMPO_ASSENTOS)) {
+        return 0;
+    }
+
+    // O valor todo precisa ser um número não negativo ("abc" e "5x" são recusados)
+    char *fim;
+    float preco = 0;
+    long assentos = 0;
+    errno = 0;
+    if (indice_campo == CAMPO_PRECO) {
+        preco = strtof(valor, &fim);
+        if (fim == valor || *fim != '\0' || errno || !isfinite(preco) || preco < 0) return 0;
+    } else {
+        assentos = strtol(valor, &fim, 10);
+        if (fim == valor || *fim != '\0' || errno || assentos < 0 || assentos > INT_MAX) return 0;
+    }
+    AVLTree **arvores = indices->arvores;
+
+    pthread_mutex_lock(&indices->trava_escrita);
+
+    Flight atualizado = voos[id];
+    if (indice_campo == CAMPO_PRECO) atualizado.preco = preco;
+    else atualizado.assentos = (int)assentos;
+
+    char antiga[TAM_CHAVE_INDICE], nova[TAM_CHAVE_INDICE];
+    formatar_chave_indice(&voos[id], (CampoIndice)indice_campo, antiga);
+    formatar_chave_indice(&atualizado, (CampoIndice)indice_campo, nova);
+    float preco_antigo = voos[id].preco, preco_novo = atualizado.preco;
+    int troca_chave = !arvores[indice_campo]->ausente && strcmp(antiga, nova) != 0;
+
+    // Retira o voo da chave antiga e espera as leituras que ainda podem encontrá-lo por ela
+    if (troca_chave) {
+        AVLTree *arvore = arvores[indice_campo];
+        AVLNode *raiz = atomic_load_explicit(&arvore->raiz, memory_order_relaxed);
+        atomic_store_explicit(&arvore->raiz, remover_indice_avl_cow(raiz, antiga, id, preco_antigo, voos),
+                              memory_order_release);
+        esperar_leituras();
+    }
+
+    // Cada campo é escrito atomicamente; leitores veem o valor antigo ou o novo
+    if (indice_campo == CAMPO_PRECO) {
+        __atomic_store(&voos[id].preco, &preco, __ATOMIC_RELEASE);
+    } else {
+        __atomic_store_n(&voos[id].assentos, (int)assentos, __ATOMIC_RELEASE);
+    }
+
+    for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+        if (arvores[f]->ausente) continue;
+        AVLNode *raiz = atomic_load_explicit(&arvores[f]->raiz, memory_order_relaxed);
+        AVLNode *nova_raiz = raiz;
+
+        if (f == indice_campo && troca_chave) {
+            // A linha já tem o valor novo: os agregados do caminho usam o preço novo
+            nova_raiz = inserir_avl_cow(nova_raiz, nova, id, voos);
+        } else if (preco_novo != preco_antigo) {
+            // Nos demais, só os agregados de preço do caminho até o voo mudam
+            char chave[TAM_CHAVE_INDICE];
+            formatar_chave_indice(&voos[id], (CampoIndice)f, chave);
+            nova_raiz = atualizar_preco_avl_cow(nova_raiz, chave, preco_antigo, preco_novo, voos);
+        }
+
+        if (nova_raiz != raiz) atomic_store_explicit(&arvores[f]->raiz, nova_raiz, memory_order_release);
+    }
+
+    recolher_aposentados();
+    pthread_mutex_unlock(&indices->trava_escrita);
+    return 1;
+}
+
+/**
+ * Agrega os preços dos voos que atendem à consulta sem copiar os voos.
+ * Com um único predicado indexado (campo com árvore construída) a resposta
+ * vem dos agregados das subárvores do índice; conjunções avaliam a interseção
+ * de índices e somam os preços diretamente pelos ids.
+ * @param indices Índices da tabela.
+ * @param voos Vetor de voos.
+ * @param n Quantidade total de voos.
+ * @param consulta Consulta de agregação.
+ * @param agregado Saída.
+ */
+void agregar_voos(const IndicesVoos *indices, Flight *voos, int n, const Query *consulta, AgregadoPreco *agregado) {
+    AgregadoPreco vazio = AGREGADO_PRECO_VAZIO;
+    *agregado = vazio;
+
+    entrar_fase(FASE_PARSE);
     ExprNode *expressao = parse_expressao(consulta->expressao);
+    sair_fase();
+    if (!expressao) return;
 
-    // Busca os voos correspondentes nas árvores AVL
-    AVLNode *resultado_avl = avaliar_expressao(expressao);
+    FaixaPredicado predicado;
+    int indexado = expressao->operator != OP_AND && converter_faixa_predicado(expressao, &predicado) &&
+                   predicado.campo != CAMPO_PARTIDA && !indices->arvores[predicado.campo]->ausente;
 
-    // Coleta os voos filtrados conforme os índices obtidos na AVL
-    int count = 0;
-    if (resultado_avl) {
-        for (int i = 0; i < resultado_avl->num_indices; i++) {
-            (*resultados)[count++] = voos[resultado_avl->indices[i]];
+    entrar_epoca();
+    if (indexado) {
+        agregar_indice_avl(indices->arvores[predicado.campo], &predicado, agregado);
+    } else {
+        AVLNode *resultado_avl = avaliar_expressao(indices->arvores, voos, n, expressao);
+        if (resultado_avl) {
+            for (int i = 0; i < resultado_avl->num_indices; i++) {
+                acumular_preco(agregado, voos[resultado_avl->indices[i]].preco);
+            }
+            liberar_avl(resultado_avl);
+        }
+    }
+    sair_epoca();
+
+    liberar_expressao(expressao);
+}
+
+/**
+ * Custo estimado de avaliar as folhas pelos índices, em ids lidos das listas:
+ * a soma das contagens das folhas indexadas, lidas dos agregados das
+ * subárvores sem tocar nas listas (zero se alguma folha for vazia). Folhas
+ * da partida ou de campos sem árvore construída não contam. Sem folhas
+ * indexadas, todos os voos seriam lidos.
+ * @param indices Índices da tabela.
+ * @param n Quantidade total de voos.
+ * @param folhas Folhas da conjunção (converter_folhas_expressao).
+ * @param num Quantidade de folhas.
+ * @return Custo estimado.
+ */
+long estimar_custo_folhas(const IndicesVoos *indices, int n, const FaixaPredicado *folhas, int num) {
+    long custo = 0;
+    int indexadas = 0;
+    entrar_epoca();
+    for (int f = 0; f < num; f++) {
+        if (folhas[f].campo == CAMPO_PARTIDA || indices->arvores[folhas[f].campo]->ausente) continue;
+        AgregadoPreco contagem;
+        agregar_indice_avl(indices->arvores[folhas[f].campo], &folhas[f], &contagem);
+        indexadas++;
+        if (contagem.quantidade == 0) {
+            custo = 0;
+            break;
         }
+        custo += contagem.quantidade;
+    }
+    sair_epoca();
+    return indexadas == 0 ? n : custo;
+}
+
+/**
+ * Custo estimado de responder a consulta pelos índices, na escala de
+ * estimar_custo_folhas. Agregações de um único predicado indexado saem dos
+ * agregados das subárvores e custam 0; buscas de itinerários podem percorrer
+ * a rede inteira e custam `n`.
+ * @return Custo estimado (0 para consultas inválidas).
+ */
+long estimar_custo_consulta(const IndicesVoos *indices, int n, const Query *consulta) {
+    if (consulta->agregacao == CONSULTA_ITINERARIO) return n;
+
+    ExprNode *expressao = parse_expressao(consulta->expressao);
+    if (!expressao) return 0;
+    FaixaPredicado folhas[MAX_FOLHAS_EXPRESSAO];
+    int num = converter_folhas_expressao(expressao, folhas, MAX_FOLHAS_EXPRESSAO);
+    int unico = expressao->operator != OP_AND;
+    liberar_expressao(expressao);
+
+    if (num <= 0) return 0;
+    if (consulta->agregacao != AGREGACAO_NENHUMA && unico && folhas[0].campo != CAMPO_PARTIDA &&
+        !indices->arvores[folhas[0].campo]->ausente) {
+        return 0;
     }
+    return estimar_custo_folhas(indices, n, folhas, num);
+}
+
+/**
+ * Nome da agregação, ou NULL para listagem.
+ */
+const char *nome_agregacao(TipoAgregacao agregacao) {
+    switch (agregacao) {
+        case AGREGACAO_COUNT: return "COUNT";
+        case AGREGACAO_MIN: return "MIN";
+        case AGREGACAO_MAX: return "MAX";
+        case AGREGACAO_AVG: return "AVG";
+        case AGREGACAO_SUM: return "SUM";
+        default: return NULL;
+    }
+}
+
+/**
+ * Identifica a palavra-chave de uma agregação.
+ * @return O tipo, ou AGREGACAO_NENHUMA se a palavra não for reconhecida.
+ */
+static TipoAgregacao identificar_agregacao(const char *palavra) {
+    for (int t = AGREGACAO_COUNT; t <= AGREGACAO_SUM; t++) {
+        if (strcmp(palavra, nome_agregacao((TipoAgregacao)t)) == 0) return (TipoAgregacao)t;
+    }
+    return AGREGACAO_NENHUMA;
+}
+
+/**
+ * Preenche uma consulta de agregação a partir do restante da linha
+ * ("[prc] expressão"). Só preços são agregados; COUNT não tem campo.
+ */
+static int interpretar_agregacao(const char *palavra, const char *resto, Query *consulta) {
+    consulta->agregacao = identificar_agregacao(palavra);
+    consulta->max_voos = 0;
+    consulta->trigrama[0] = '\0';
+    if (consulta->agregacao == AGREGACAO_NENHUMA) return 0;
+
+    if (consulta->agregacao != AGREGACAO_COUNT) {
+        char campo[4];
+        int lidos = 0;
+        if (sscanf(resto, " %3s%n", campo, &lidos) != 1 || strcmp(campo, "prc") != 0) return 0;
+        resto += lidos;
+    }
+    return sscanf(resto, " %255[^\n]", consulta->expressao) == 1;
+}
+
+/**
+ * Preenche uma consulta de itinerários a partir do restante da linha
+ * ("max trigrama parâmetros"), validando os parâmetros.
+ */
+static int interpretar_consulta_itinerario(const char *resto, Query *consulta) {
+    ConsultaItinerario parametros;
+    consulta->agregacao = CONSULTA_ITINERARIO;
+    return sscanf(resto, "%d %3s %255[^\n]", &consulta->max_voos, consulta->trigrama, consulta->expressao) == 3 &&
+           interpretar_itinerario(consulta->expressao, &parametros);
+}
+
+/**
+ * Filtra os voos conforme a consulta usando AVL e árvore de expressões.
+ * @param indices Índices da tabela.
+ * @param voos Vetor de voos.
+ * @param n Quantidade total de voos.
+ * @param consulta Ponteiro para a consulta a ser aplicada.
+ * @param resultados Ponteiro para armazenar os ids (posições em `voos`) filtrados.
+ * @return Número de voos que passaram no filtro.
+ */
+int filtrar_voos(const IndicesVoos *indices, Flight *voos, int n, const Query *consulta, int **resultados) {
+    // Converte a string da consulta em árvore de expressão
+    entrar_fase(FASE_PARSE);
+    ExprNode *expressao = parse_expressao(consulta->expressao);
+    sair_fase();
+
+    int count = filtrar_voos_expressao(indices, voos, n, expressao, resultados);
 
     // Libera a memória da árvore de expressão
     liberar_expressao(expressao);
@@ -82,6 +652,66 @@ int filtrar_voos(Flight *voos, int n, const Query *consulta, Flight **resultados
     return count;
 }
 
+/**
+ * Filtra os voos a partir de uma árvore de expressão já construída. Só os
+ * ids são copiados; os voos são lidos do vetor base na ordenação e na saída.
+ * @param indices Índices da tabela.
+ * @param voos Vetor de voos.
+ * @param n Quantidade total de voos.
+ * @param expressao Árvore de expressão da consulta.
+ * @param resultados Ponteiro para armazenar os ids filtrados (liberar com free).
+ * @return Número de voos que passaram no filtro.
+ */
+int filtrar_voos_expressao(const IndicesVoos *indices, Flight *voos, int n, const ExprNode *expressao, int **resultados) {
+    // Leitura sem travas: os nós alcançados ficam vivos até sair_epoca()
+    entrar_epoca();
+
+    // Busca os voos correspondentes nas árvores AVL
+    AVLNode *resultado_avl = avaliar_expressao(indices->arvores, voos, n, expressao);
+
+    // Copia apenas os ids obtidos na AVL
+    int count = resultado_avl ? resultado_avl->num_indices : 0;
+    *resultados = (int *)malloc((count ? count : 1) * sizeof(int));
+    if (*resultados == NULL) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (resultado_avl) {
+        memcpy(*resultados, resultado_avl->indices, count * sizeof(int));
+        liberar_avl(resultado_avl);
+    }
+
+    sair_epoca();
+    return count;
+}
+
+/**
+ * Preenche uma listagem paginada a partir do restante da linha
+ * ("[cursor] max trigrama expressão"). O cursor é validado contra o trigrama
+ * e a expressão.
+ */
+static int interpretar_pagina(const char *resto, Query *consulta) {
+    char cursor[CURSOR_TAMANHO + 2] = "";
+    int lidos = 0;
+    consulta->paginada = 1;
+    if (sscanf(resto, " @%n", &lidos) == 0 && lidos > 0) {
+        if (sscanf(resto, " %42s%n", cursor, &lidos) != 1) return 0;
+        resto += lidos;
+    }
+    if (sscanf(resto, "%d %3s %255[^\n]", &consulta->max_voos, consulta->trigrama, consulta->expressao) != 3) return 0;
+    return cursor[0] == '\0' || decodificar_cursor(cursor, consulta);
+}
+
+/**
+ * Interpreta uma consulta que começa com palavra-chave: "itn", "page" ou
+ * uma agregação em maiúsculas.
+ */
+static int interpretar_palavra_chave(const char *palavra, const char *resto, Query *consulta) {
+    if (strcmp(palavra, "itn") == 0) return interpretar_consulta_itinerario(resto, consulta);
+    if (strcmp(palavra, "page") == 0) return interpretar_pagina(resto, consulta);
+    return interpretar_agregacao(palavra, resto, consulta);
+}
+
 /**
  * Lê uma consulta do arquivo de entrada.
  * @param arquivo Arquivo de entrada.
@@ -89,9 +719,47 @@ int filtrar_voos(Flight *voos, int n, const Query *consulta, Flight **resultados
  * @return 1 se a leitura for bem-sucedida, 0 caso contrário.
  */
 int carregar_consulta(FILE *arquivo, Query *consulta) {
+    consulta->agregacao = AGREGACAO_NENHUMA;
+    consulta->paginada = consulta->tem_cursor = 0;
+
+    // Agregações, itinerários e páginas começam com uma palavra-chave
+    char palavra[8];
+    if (fscanf(arquivo, " %7[A-Za-z]", palavra) == 1) {
+        char resto[300];
+        if (fscanf(arquivo, "%299[^\n]", resto) != 1 || !interpretar_palavra_chave(palavra, resto, consulta)) {
+            fprintf(stderr, "Erro ao ler a consulta.\n");
+            return 0;
+        }
+        return 1;
+    }
+
     if (fscanf(arquivo, "%d %3s %255[^\n]", &consulta->max_voos, consulta->trigrama, consulta->expressao) != 3) {
         fprintf(stderr, "Erro ao ler a consulta.\n");
         return 0;
     }
     return 1;
 }
+
+/**
+ * Interpreta uma consulta a partir de uma linha de texto já lida.
+ * @param linha Linha no formato "max trigrama expressão" (ou com palavra-chave).
+ * @param consulta Estrutura para armazenar a consulta lida.
+ * @return 1 se a linha for válida, 0 caso contrário.
+ */
+int interpretar_consulta(const char *linha, Query *consulta) {
+    consulta->agregacao = AGREGACAO_NENHUMA;
+    consulta->paginada = consulta->tem_cursor = 0;
+
+    char palavra[8];
+    int lidos = 0;
+    if (sscanf(linha, " %7[A-Za-z]%n", palavra, &lidos) == 1) {
+        char resto[300];
+        if (sscanf(linha + lidos, "%299[^\r\n]", resto) != 1) return 0;
+        return interpretar_palavra_chave(palavra, resto, consulta);
+    }
+
+    if (sscanf(linha, "%d %3s %255[^\r\n]", &consulta->max_voos, consulta->trigrama, consulta->expressao) != 3) {
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,94 @@
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "ring_buffer.h"
+
+#define RING_GIROS_ANTES_DE_CEDER 64  // Tentativas ativas antes de ceder a CPU
+
+/**
+ * Cria uma fila com capacidade arredondada para a próxima potência de 2.
+ */
+RingBuffer *criar_ring_buffer(size_t capacidade) {
+    size_t cap = 2;
+    while (cap < capacidade) cap <<= 1;
+
+    RingBuffer *fila = aligned_alloc(64, (sizeof(RingBuffer) + 63) / 64 * 64);
+    if (!fila) {
+        fprintf(stderr, "Erro ao alocar memória para a fila.\n");
+        exit(EXIT_FAILURE);
+    }
+    fila->itens = malloc(cap * sizeof(void *));
+    if (!fila->itens) {
+        fprintf(stderr, "Erro ao alocar memória para a fila.\n");
+        exit(EXIT_FAILURE);
+    }
+    fila->mascara = cap - 1;
+    atomic_init(&fila->cabeca, 0);
+    atomic_init(&fila->cauda, 0);
+    return fila;
+}
+
+/**
+ * Libera a fila.
+ */
+void liberar_ring_buffer(RingBuffer *fila) {
+    if (!fila) return;
+    free(fila->itens);
+    free(fila);
+}
+
+/**
+ * Tenta inserir um item (lado do produtor).
+ */
+int tentar_inserir_ring(RingBuffer *fila, void *item) {
+    size_t cauda = atomic_load_explicit(&fila->cauda, memory_order_relaxed);
+    size_t cabeca = atomic_load_explicit(&fila->cabeca, memory_order_acquire);
+
+    if (cauda - cabeca > fila->mascara) return 0;  // Cheia
+
+    fila->itens[cauda & fila->mascara] = item;
+    atomic_store_explicit(&fila->cauda, cauda + 1, memory_order_release);
+    return 1;
+}
+
+/**
+ * Tenta remover um item (lado do consumidor).
+ */
+int tentar_remover_ring(RingBuffer *fila, void **item) {
+    size_t cabeca = atomic_load_explicit(&fila->cabeca, memory_order_relaxed);
+    size_t cauda = atomic_load_explicit(&fila->cauda, memory_order_acquire);
+
+    if (cabeca == cauda) return 0;  // Vazia
+
+    *item = fila->itens[cabeca & fila->mascara];
+    atomic_store_explicit(&fila->cabeca, cabeca + 1, memory_order_release);
+    return 1;
+}
+
+/**
+ * Insere um item, aguardando enquanto a fila estiver cheia.
+ */
+void inserir_ring(RingBuffer *fila, void *item) {
+    int giros = 0;
+    while (!tentar_inserir_ring(fila, item)) {
+        if (++giros >= RING_GIROS_ANTES_DE_CEDER) {
+            sched_yield();
+            giros = 0;
+        }
+    }
+}
+
+/**
+ * Remove um item, aguardando enquanto a fila estiver vazia.
+ */
+void *remover_ring(RingBuffer *fila) {
+    void *item;
+    int giros = 0;
+    while (!tentar_remover_ring(fila, &item)) {
+        if (++giros >= RING_GIROS_ANTES_DE_CEDER) {
+            sched_yield();
+            giros = 0;
+        }
+    }
+    return item;
+}
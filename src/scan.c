@@ -0,0 +1,406 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "scan.h"
+#include "expr_parser.h"
+#include "sort.h"
+#include "cursor.h"
+
+#define MAX_PREDICADOS 32
+
+/**
+ * Predicado convertido para o intervalo fechado [min, max] de chaves do campo.
+ */
+typedef struct {
+    int campo;
+    int64_t min;
+    int64_t max;
+    uint64_t bit;  // Bit do aeroporto no filtro do bloco (só igualdade em org/dst)
+} PredicadoVarredura;
+
+/**
+ * Bit de um aeroporto no filtro de 64 bits dos blocos.
+ */
+static uint64_t bit_aeroporto(int64_t chave) {
+    return 1ull << (((uint64_t)chave * 0x9E3779B97F4A7C15ull) >> 58);
+}
+
+/**
+ * Interpreta o nome de um critério de agrupamento.
+ */
+int criterio_agrupamento(const char *nome) {
+    if (strcmp(nome, "route") == 0) return AGRUPAR_ROTA;
+    if (strcmp(nome, "date") == 0) return AGRUPAR_DATA;
+    return -1;
+}
+
+static int comparar_rota(const void *x, const void *y) {
+    const Flight *a = x, *b = y;
+    int c = strcmp(a->origem, b->origem);
+    if (c == 0) c = strcmp(a->destino, b->destino);
+    if (c == 0) c = (a->id > b->id) - (a->id < b->id);
+    return c;
+}
+
+static int comparar_data(const void *x, const void *y) {
+    const Flight *a = x, *b = y;
+    if (a->partida != b->partida) return a->partida > b->partida ? 1 : -1;
+    return (a->id > b->id) - (a->id < b->id);
+}
+
+/**
+ * Reordena os voos pelo critério, preservando o id de cada um.
+ */
+void agrupar_voos(Flight *voos, int n, CriterioAgrupamento criterio) {
+    if (criterio == AGRUPAR_ROTA) qsort(voos, n, sizeof(Flight), comparar_rota);
+    else if (criterio == AGRUPAR_DATA) qsort(voos, n, sizeof(Flight), comparar_data);
+}
+
+/**
+ * Constrói o mapa de zonas de um vetor de voos.
+ */
+MapaZonas *construir_mapa_zonas(const Flight *voos, int n) {
+    MapaZonas *mapa = calloc(1, sizeof(MapaZonas));
+    if (!mapa) {
+        fprintf(stderr, "Erro ao alocar memória para o mapa de zonas.\n");
+        exit(EXIT_FAILURE);
+    }
+    mapa->voos = voos;
+    mapa->n = n;
+    mapa->num_zonas = (n + ZONA_TAMANHO - 1) / ZONA_TAMANHO;
+    mapa->zonas = malloc((mapa->num_zonas > 0 ? mapa->num_zonas : 1) * sizeof(Zona));
+    if (!mapa->zonas) {
+        fprintf(stderr, "Erro ao alocar memória para o mapa de zonas.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int z = 0; z < mapa->num_zonas; z++) {
+        Zona *zona = &mapa->zonas[z];
+        for (int c = 0; c < NUM_CAMPOS_ZONA; c++) {
+            zona->min[c] = INT64_MAX;
+            zona->max[c] = INT64_MIN;
+        }
+        zona->origens = zona->destinos = 0;
+
+        int fim = (z + 1) * ZONA_TAMANHO < n ? (z + 1) * ZONA_TAMANHO : n;
+        for (int i = z * ZONA_TAMANHO; i < fim; i++) {
+            for (int c = 0; c < NUM_CAMPOS_ZONA; c++) {
+                int64_t chave = chave_voo(&voos[i], c);
+                if (chave < zona->min[c]) zona->min[c] = chave;
+                if (chave > zona->max[c]) zona->max[c] = chave;
+            }
+            zona->origens |= bit_aeroporto(chave_aeroporto(voos[i].origem));
+            zona->destinos |= bit_aeroporto(chave_aeroporto(voos[i].destino));
+        }
+    }
+    return mapa;
+}
+
+/**
+ * Libera o mapa de zonas.
+ */
+void liberar_mapa_zonas(MapaZonas *mapa) {
+    if (!mapa) return;
+    free(mapa->zonas);
+    free(mapa);
+}
+
+/**
+ * Copia o intervalo de uma folha e, na igualdade de aeroportos, calcula o bit
+ * do filtro dos blocos.
+ */
+static void preparar_predicado(const FaixaPredicado *faixa, PredicadoVarredura *p) {
+    p->campo = faixa->campo;
+    p->min = faixa->min;
+    p->max = faixa->max;
+    p->bit = 0;
+    if ((p->campo == CAMPO_ORIGEM || p->campo == CAMPO_DESTINO) && p->min == p->max) {
+        p->bit = bit_aeroporto(p->min);
+    }
+}
+
+/**
+ * Converte um predicado da expressão no intervalo fechado de chaves do campo
+ * e, na igualdade de aeroportos, no bit do filtro dos blocos.
+ * @return 1 se o campo é conhecido, 0 caso contrário.
+ */
+static int converter_predicado(const ExprNode *no, PredicadoVarredura *p) {
+    FaixaPredicado faixa;
+    if (!converter_faixa_predicado(no, &faixa)) return 0;
+    preparar_predicado(&faixa, p);
+    return 1;
+}
+
+/**
+ * Coleta os predicados folha de uma conjunção.
+ * @return 0 se algum campo for desconhecido.
+ */
+static int coletar_predicados(const ExprNode *no, PredicadoVarredura *predicados, int *num) {
+    if (!no) return 1;
+    if (no->operator == OP_AND) {
+        return coletar_predicados(no->left, predicados, num) &&
+               coletar_predicados(no->right, predicados, num);
+    }
+    if (*num >= MAX_PREDICADOS) return 1;
+    if (!converter_predicado(no, &predicados[*num])) {
+        fprintf(stderr, "Campo desconhecido na consulta: %s\n", no->field);
+        return 0;
+    }
+    (*num)++;
+    return 1;
+}
+
+/**
+ * Interpreta a expressão da consulta em predicados de varredura.
+ * @return 0 se a expressão for inválida ou vazia.
+ */
+static int preparar_predicados(const Query *consulta, PredicadoVarredura *predicados, int *num) {
+    ExprNode *expressao = parse_expressao(consulta->expressao);
+    *num = 0;
+    int valida = expressao && coletar_predicados(expressao, predicados, num) && *num > 0;
+    liberar_expressao(expressao);
+    return valida;
+}
+
+/**
+ * Verifica se algum voo do bloco pode satisfazer todos os predicados.
+ */
+static int zona_pode_satisfazer(const Zona *zona, const PredicadoVarredura *predicados, int num) {
+    for (int p = 0; p < num; p++) {
+        const PredicadoVarredura *pred = &predicados[p];
+        if (pred->max < zona->min[pred->campo] || pred->min > zona->max[pred->campo]) return 0;
+        if (pred->bit) {
+            uint64_t filtro = pred->campo == CAMPO_ORIGEM ? zona->origens : zona->destinos;
+            if (!(filtro & pred->bit)) return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Verifica todos os predicados num voo.
+ */
+static int voo_satisfaz(const Flight *voo, const PredicadoVarredura *predicados, int num) {
+    for (int p = 0; p < num; p++) {
+        int64_t chave = chave_voo(voo, predicados[p].campo);
+        if (chave < predicados[p].min || chave > predicados[p].max) return 0;
+    }
+    return 1;
+}
+
+/**
+ * Filtra os voos por varredura, pulando blocos pelos resumos.
+ */
+int filtrar_voos_varredura(const MapaZonas *mapa, const Query *consulta, int **resultados) {
+    int capacidade = 64, count = 0;
+    *resultados = malloc(capacidade * sizeof(int));
+    if (!*resultados) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    PredicadoVarredura predicados[MAX_PREDICADOS];
+    int num;
+    if (!preparar_predicados(consulta, predicados, &num)) return 0;
+
+    for (int z = 0; z < mapa->num_zonas; z++) {
+        if (!zona_pode_satisfazer(&mapa->zonas[z], predicados, num)) continue;
+
+        int fim = (z + 1) * ZONA_TAMANHO < mapa->n ? (z + 1) * ZONA_TAMANHO : mapa->n;
+        for (int i = z * ZONA_TAMANHO; i < fim; i++) {
+            if (!voo_satisfaz(&mapa->voos[i], predicados, num)) continue;
+            if (count == capacidade) {
+                capacidade *= 2;
+                *resultados = realloc(*resultados, capacidade * sizeof(int));
+                if (!*resultados) {
+                    fprintf(stderr, "Erro de alocação de memória.\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            (*resultados)[count++] = i;
+        }
+    }
+    return count;
+}
+
+/**
+ * Agrega os preços dos voos que atendem à consulta por varredura.
+ */
+void agregar_voos_varredura(const MapaZonas *mapa, const Query *consulta, AgregadoPreco *agregado) {
+    AgregadoPreco vazio = AGREGADO_PRECO_VAZIO;
+    *agregado = vazio;
+
+    PredicadoVarredura predicados[MAX_PREDICADOS];
+    int num;
+    if (!preparar_predicados(consulta, predicados, &num)) return;
+
+    for (int z = 0; z < mapa->num_zonas; z++) {
+        if (!zona_pode_satisfazer(&mapa->zonas[z], predicados, num)) continue;
+
+        int fim = (z + 1) * ZONA_TAMANHO < mapa->n ? (z + 1) * ZONA_TAMANHO : mapa->n;
+        for (int i = z * ZONA_TAMANHO; i < fim; i++) {
+            if (voo_satisfaz(&mapa->voos[i], predicados, num)) acumular_preco(agregado, mapa->voos[i].preco);
+        }
+    }
+}
+
+/**
+ * Quantidade de voos nos blocos que a varredura visitaria.
+ */
+long estimar_linhas_varredura(const MapaZonas *mapa, const FaixaPredicado *folhas, int num) {
+    PredicadoVarredura predicados[MAX_PREDICADOS];
+    if (num > MAX_PREDICADOS) num = MAX_PREDICADOS;
+    for (int p = 0; p < num; p++) preparar_predicado(&folhas[p], &predicados[p]);
+
+    long linhas = 0;
+    for (int z = 0; z < mapa->num_zonas; z++) {
+        if (!zona_pode_satisfazer(&mapa->zonas[z], predicados, num)) continue;
+        linhas += z == mapa->num_zonas - 1 ? mapa->n - z * ZONA_TAMANHO : ZONA_TAMANHO;
+    }
+    return linhas;
+}
+
+/**
+ * Estado de uma consulta dentro de um lote: predicados, heap limitado aos
+ * limite_pagina() melhores (a raiz é o pior retido) ou agregado.
+ */
+typedef struct {
+    const Query *consulta;
+    PredicadoVarredura predicados[MAX_PREDICADOS];
+    int num_predicados;
+    int valida;
+    int *heap;              // Posições dos voos retidos
+    int tamanho;
+    int capacidade;
+    AgregadoPreco agregado;
+} ConsultaLote;
+
+/**
+ * Ordem total do heap: critério do trigrama e, em empate, o id do voo.
+ */
+static int comparar_lote(const Flight *voos, int a, int b, const char *trigrama) {
+    int c = comparar_voos(&voos[a], &voos[b], trigrama);
+    if (c != 0) return c;
+    return (voos[a].id > voos[b].id) - (voos[a].id < voos[b].id);
+}
+
+static void descer_heap_lote(const Flight *voos, ConsultaLote *q, int i, int tamanho) {
+    while (1) {
+        int maior = i, esq = 2 * i + 1, dir = 2 * i + 2;
+        if (esq < tamanho && comparar_lote(voos, q->heap[esq], q->heap[maior], q->consulta->trigrama) > 0) maior = esq;
+        if (dir < tamanho && comparar_lote(voos, q->heap[dir], q->heap[maior], q->consulta->trigrama) > 0) maior = dir;
+        if (maior == i) return;
+        int t = q->heap[i]; q->heap[i] = q->heap[maior]; q->heap[maior] = t;
+        i = maior;
+    }
+}
+
+/**
+ * Oferece um voo ao heap da consulta; ele só entra se for melhor que o pior retido.
+ */
+static void oferecer_lote(const Flight *voos, ConsultaLote *q, int pos) {
+    if (q->tamanho < q->capacidade) {
+        int j = q->tamanho++;
+        q->heap[j] = pos;
+        while (j > 0 && comparar_lote(voos, q->heap[(j - 1) / 2], q->heap[j], q->consulta->trigrama) < 0) {
+            int t = q->heap[j]; q->heap[j] = q->heap[(j - 1) / 2]; q->heap[(j - 1) / 2] = t;
+            j = (j - 1) / 2;
+        }
+    } else if (q->capacidade > 0 && comparar_lote(voos, pos, q->heap[0], q->consulta->trigrama) < 0) {
+        q->heap[0] = pos;
+        descer_heap_lote(voos, q, 0, q->tamanho);
+    }
+}
+
+/**
+ * Responde um lote de consultas numa única passagem pelos voos.
+ */
+void responder_lote_varredura(const MapaZonas *mapa, const Query *consultas, int num_consultas, Saida *saida) {
+    ConsultaLote *lote = calloc(num_consultas > 0 ? num_consultas : 1, sizeof(ConsultaLote));
+    int *ativas = malloc((num_consultas > 0 ? num_consultas : 1) * sizeof(int));
+    int64_t (*chaves)[NUM_CAMPOS_ZONA] = malloc(ZONA_TAMANHO * sizeof(*chaves));
+    if (!lote || !ativas || !chaves) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int q = 0; q < num_consultas; q++) {
+        ConsultaLote *c = &lote[q];
+        AgregadoPreco vazio = AGREGADO_PRECO_VAZIO;
+        c->consulta = &consultas[q];
+        c->agregado = vazio;
+        c->valida = c->consulta->agregacao != CONSULTA_ITINERARIO &&
+                    preparar_predicados(c->consulta, c->predicados, &c->num_predicados);
+        if (c->consulta->agregacao == AGREGACAO_NENHUMA) {
+            c->capacidade = limite_pagina(c->consulta);
+            if (c->capacidade > mapa->n) c->capacidade = mapa->n;
+            c->heap = malloc((c->capacidade > 0 ? c->capacidade : 1) * sizeof(int));
+            if (!c->heap) {
+                fprintf(stderr, "Erro de alocação de memória.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    for (int z = 0; z < mapa->num_zonas; z++) {
+        // Consultas que podem ter resultados no bloco
+        int num_ativas = 0;
+        for (int q = 0; q < num_consultas; q++) {
+            ConsultaLote *c = &lote[q];
+            if (!c->valida || (c->consulta->agregacao == AGREGACAO_NENHUMA && c->capacidade == 0)) continue;
+            if (zona_pode_satisfazer(&mapa->zonas[z], c->predicados, c->num_predicados)) ativas[num_ativas++] = q;
+        }
+        if (num_ativas == 0) continue;
+
+        // As chaves de cada voo do bloco são calculadas uma vez para todas as consultas
+        int inicio = z * ZONA_TAMANHO;
+        int fim = inicio + ZONA_TAMANHO < mapa->n ? inicio + ZONA_TAMANHO : mapa->n;
+        for (int i = inicio; i < fim; i++) {
+            for (int f = 0; f < NUM_CAMPOS_ZONA; f++) chaves[i - inicio][f] = chave_voo(&mapa->voos[i], f);
+        }
+
+        for (int i = inicio; i < fim; i++) {
+            const int64_t *chave = chaves[i - inicio];
+            for (int a = 0; a < num_ativas; a++) {
+                ConsultaLote *c = &lote[ativas[a]];
+                int passa = 1;
+                for (int p = 0; p < c->num_predicados && passa; p++) {
+                    int64_t k = chave[c->predicados[p].campo];
+                    passa = k >= c->predicados[p].min && k <= c->predicados[p].max;
+                }
+                if (!passa) continue;
+                if (c->consulta->agregacao != AGREGACAO_NENHUMA) acumular_preco(&c->agregado, mapa->voos[i].preco);
+                else if (depois_do_cursor(c->consulta, &mapa->voos[i])) oferecer_lote(mapa->voos, c, i);
+            }
+        }
+    }
+
+    // Saída na ordem das consultas
+    for (int q = 0; q < num_consultas; q++) {
+        ConsultaLote *c = &lote[q];
+        imprimir_consulta(saida, c->consulta);
+        if (c->consulta->agregacao == CONSULTA_ITINERARIO) {
+            fprintf(stderr, "Consultas itn não são suportadas na varredura compartilhada (--batch).\n");
+            continue;
+        }
+        if (c->consulta->agregacao != AGREGACAO_NENHUMA) {
+            imprimir_agregacao(saida, c->consulta, &c->agregado);
+            continue;
+        }
+
+        // HeapSort: retira o pior para o fim até esvaziar
+        for (int fim = c->tamanho - 1; fim > 0; fim--) {
+            int t = c->heap[0]; c->heap[0] = c->heap[fim]; c->heap[fim] = t;
+            descer_heap_lote(mapa->voos, c, 0, fim);
+        }
+        int impressos = c->tamanho < c->consulta->max_voos ? c->tamanho : c->consulta->max_voos;
+        for (int j = 0; j < impressos; j++) imprimir_voo(saida, &mapa->voos[c->heap[j]]);
+        imprimir_cursor(saida, c->consulta, impressos > 0 ? &mapa->voos[c->heap[impressos - 1]] : NULL,
+                        c->tamanho > impressos);
+        free(c->heap);
+    }
+
+    free(chaves);
+    free(ativas);
+    free(lote);
+}
@@ -0,0 +1,585 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "server.h"
+#include "sort.h"
+#include "itinerary.h"
+#include "cursor.h"
+#include "deadline.h"
+#include "standing.h"
+
+/**
+ * Saída de uma conexão. Só a thread da conexão escreve no descritor: as
+ * diferenças das consultas permanentes, montadas por quem aplicou a
+ * alteração com as consultas travadas, ficam em `pendentes` e a thread é
+ * acordada pelo pipe `aviso`, então um cliente lento não segura as
+ * alterações dos outros.
+ */
+typedef struct {
+    int fd;
+    Saida *envio;           // Quadros a escrever (só a thread da conexão usa)
+    pthread_mutex_t trava;  // Protege `pendentes` e `encerrada`
+    Saida *pendentes;       // Quadros das consultas permanentes, em ordem
+    int encerrada;          // 1 se as pendências transbordaram ou a escrita falhou
+    int aviso[2];
+} Conexao;
+
+/**
+ * Leitor de linhas sobre um descritor, com buffer próprio. Com uma conexão,
+ * envia os quadros pendentes dela enquanto espera a entrada.
+ */
+typedef struct {
+    int fd;
+    Conexao *conexao;
+    char buffer[4096];
+    size_t inicio;
+    size_t fim;
+} LeitorLinhas;
+
+/**
+ * Argumentos repassados à thread de cada cliente. Os clientes em andamento
+ * ficam numa lista para o encerramento do servidor.
+ */
+typedef struct ArgsCliente {
+    int fd;
+    IndicesVoos *indices;
+    Flight *voos;
+    int n;
+    CapturaConsultas *captura;
+    const LimitesServidor *limites;
+    ConsultasPermanentes *permanentes;
+    struct ArgsCliente *ant;
+    struct ArgsCliente *prox;
+} ArgsCliente;
+
+// Vagas das consultas caras, compartilhadas por todos os clientes
+static pthread_mutex_t trava_admissao = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t vaga_admissao;
+static pthread_once_t admissao_iniciada = PTHREAD_ONCE_INIT;
+static int caras_em_andamento = 0;
+
+// Clientes do socket em andamento; o servidor só libera o que eles usam quando a lista esvazia
+static pthread_mutex_t trava_clientes = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cliente_encerrado = PTHREAD_COND_INITIALIZER;
+static ArgsCliente *clientes_ativos = NULL;
+static int num_clientes = 0;
+
+// Sinalizado por SIGINT/SIGTERM para encerrar o laço de accept()
+static volatile sig_atomic_t encerrar_servidor = 0;
+
+static void tratar_sinal(int sinal) {
+    (void)sinal;
+    encerrar_servidor = 1;
+}
+
+static int conexao_ativa(Conexao *conexao) {
+    pthread_mutex_lock(&conexao->trava);
+    int ativa = !conexao->encerrada;
+    pthread_mutex_unlock(&conexao->trava);
+    return ativa;
+}
+
+/**
+ * Escreve os quadros pendentes e depois o cabeçalho do quadro seguido do
+ * payload (nada além das pendências sem cabeçalho): as diferenças geradas
+ * antes de uma resposta chegam antes dela. Uma escrita que falha encerra a
+ * conexão em vez do processo.
+ * @return 1 se a conexão continua ativa.
+ */
+static int enviar_quadro(Conexao *conexao, const char *cabecalho, const Saida *payload) {
+    Saida *envio = conexao->envio;
+    pthread_mutex_lock(&conexao->trava);
+    escrever_saida(envio, conexao->pendentes->dados, conexao->pendentes->tamanho);
+    conexao->pendentes->tamanho = 0;
+    pthread_mutex_unlock(&conexao->trava);
+    if (cabecalho) {
+        escrever_saida(envio, cabecalho, strlen(cabecalho));
+        escrever_saida(envio, payload->dados, payload->tamanho);
+    }
+
+    size_t enviado = 0;
+    while (enviado < envio->tamanho) {
+        ssize_t r = write(conexao->fd, envio->dados + enviado, envio->tamanho - enviado);
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0) {
+            pthread_mutex_lock(&conexao->trava);
+            conexao->encerrada = 1;
+            pthread_mutex_unlock(&conexao->trava);
+            break;
+        }
+        enviado += (size_t)r;
+    }
+    envio->tamanho = 0;
+    return conexao_ativa(conexao);
+}
+
+/**
+ * Espera a entrada ficar legível, enviando os quadros pendentes da conexão a
+ * cada aviso.
+ * @return 0 se a conexão foi encerrada.
+ */
+static int esperar_entrada(LeitorLinhas *leitor) {
+    Conexao *conexao = leitor->conexao;
+    struct pollfd fds[2] = {
+        { .fd = leitor->fd, .events = POLLIN },
+        { .fd = conexao->aviso[0], .events = POLLIN },
+    };
+    while (1) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            return 1;  // O read() seguinte informa o erro
+        }
+        if (fds[1].revents) {
+            char avisos[64];
+            while (read(conexao->aviso[0], avisos, sizeof(avisos)) > 0) {}
+            if (!enviar_quadro(conexao, NULL, NULL)) return 0;
+        }
+        if (fds[0].revents) return 1;
+    }
+}
+
+/**
+ * Lê uma linha (sem o '\n'). Linhas maiores que o destino são truncadas.
+ * @return Tamanho da linha, ou -1 no fim da entrada.
+ */
+static int ler_linha(LeitorLinhas *leitor, char *linha, size_t max) {
+    size_t len = 0;
+    int leu_algo = 0;
+
+    while (1) {
+        if (leitor->inicio == leitor->fim) {
+            if (leitor->conexao && !esperar_entrada(leitor)) break;
+            ssize_t r = read(leitor->fd, leitor->buffer, sizeof(leitor->buffer));
+            if (r < 0 && errno == EINTR) continue;
+            if (r <= 0) break;
+            leitor->inicio = 0;
+            leitor->fim = (size_t)r;
+        }
+        leu_algo = 1;
+
+        char c = leitor->buffer[leitor->inicio++];
+        if (c == '\n') {
+            linha[len] = '\0';
+            return (int)len;
+        }
+        if (len + 1 < max) linha[len++] = c;
+    }
+
+    if (!leu_algo) return -1;
+    linha[len] = '\0';
+    return (int)len;
+}
+
+/**
+ * Executa uma consulta sobre os índices e escreve a saída (linha da consulta + voos).
+ */
+static int responder_consulta(Saida *resposta, const IndicesVoos *indices, Flight *voos, int n, const Query *consulta) {
+    if (consulta->agregacao == CONSULTA_ITINERARIO) {
+        const RedeRotas *rede = rede_rotas_consulta(indices, voos, n);
+        int linhas = responder_itinerarios(resposta, rede, voos, consulta);
+        liberar_rede_consulta(indices, rede);
+        return linhas;
+    }
+    if (consulta->agregacao != AGREGACAO_NENHUMA) {
+        AgregadoPreco agregado;
+        agregar_voos(indices, voos, n, consulta, &agregado);
+        imprimir_consulta(resposta, consulta);
+        imprimir_agregacao(resposta, consulta, &agregado);
+        return 2;
+    }
+
+    int *ids_filtrados;
+    int num_filtrados = filtrar_voos(indices, voos, n, consulta, &ids_filtrados);
+    num_filtrados = aplicar_cursor(consulta, voos, ids_filtrados, num_filtrados);
+    ordenar_voos(voos, ids_filtrados, num_filtrados, consulta->trigrama, consulta->max_voos);
+
+    imprimir_consulta(resposta, consulta);
+    int linhas = 1;
+    for (int j = 0; j < consulta->max_voos && j < num_filtrados; j++) {
+        imprimir_voo(resposta, &voos[ids_filtrados[j]]);
+        linhas++;
+    }
+    if (consulta->paginada) {
+        int impressos = linhas - 1;
+        imprimir_cursor(resposta, consulta, impressos > 0 ? &voos[ids_filtrados[impressos - 1]] : NULL,
+                        num_filtrados > impressos);
+        linhas++;
+    }
+
+    free(ids_filtrados);
+    return linhas;
+}
+
+/**
+ * Executa a consulta numa única leitura, da busca nos índices à impressão dos
+ * voos: uma atualização concorrente só altera a linha de um voo depois que
+ * nenhuma leitura em andamento pode encontrá-lo pela chave antiga.
+ */
+int responder_consulta_indices(Saida *resposta, const IndicesVoos *indices, Flight *voos, int n, const Query *consulta) {
+    entrar_epoca();
+    int linhas = responder_consulta(resposta, indices, voos, n, consulta);
+    sair_epoca();
+    return linhas;
+}
+
+/**
+ * Cria a condição das vagas sobre o relógio monotônico (o de relogio_ns).
+ */
+static void iniciar_admissao() {
+    pthread_condattr_t atributos;
+    pthread_condattr_init(&atributos);
+    pthread_condattr_setclock(&atributos, CLOCK_MONOTONIC);
+    pthread_cond_init(&vaga_admissao, &atributos);
+    pthread_condattr_destroy(&atributos);
+}
+
+/**
+ * Espera uma vaga para uma consulta cara até o instante limite.
+ * @param limite Instante limite em relogio_ns (0 = espera sem prazo).
+ * @return 1 se a consulta foi admitida, 0 se o prazo acabou na espera.
+ */
+static int admitir_consulta_cara(int max_caras, uint64_t limite) {
+    pthread_once(&admissao_iniciada, iniciar_admissao);
+    struct timespec ts = { .tv_sec = (time_t)(limite / 1000000000ULL), .tv_nsec = (long)(limite % 1000000000ULL) };
+
+    pthread_mutex_lock(&trava_admissao);
+    int admitida = 1;
+    while (caras_em_andamento >= max_caras) {
+        if (!limite) {
+            pthread_cond_wait(&vaga_admissao, &trava_admissao);
+        } else if (pthread_cond_timedwait(&vaga_admissao, &trava_admissao, &ts) == ETIMEDOUT &&
+                   caras_em_andamento >= max_caras) {
+            admitida = 0;
+            break;
+        }
+    }
+    if (admitida) caras_em_andamento++;
+    pthread_mutex_unlock(&trava_admissao);
+    return admitida;
+}
+
+/**
+ * Devolve a vaga de uma consulta cara.
+ */
+static void liberar_vaga_cara() {
+    pthread_mutex_lock(&trava_admissao);
+    caras_em_andamento--;
+    pthread_cond_signal(&vaga_admissao);
+    pthread_mutex_unlock(&trava_admissao);
+}
+
+/**
+ * Responde uma consulta dentro dos limites: uma consulta cara espera uma vaga
+ * e a avaliação é interrompida quando o prazo acaba.
+ * @param chegada Instante de chegada (relogio_ns), início do prazo.
+ * @return Linhas escritas, ou -1 se o prazo acabou (a resposta está incompleta).
+ */
+static int responder_no_prazo(Saida *resposta, const IndicesVoos *indices, Flight *voos, int n,
+                              const Query *consulta, const LimitesServidor *limites, uint64_t chegada) {
+    if (!limites) return responder_consulta_indices(resposta, indices, voos, n, consulta);
+
+    uint64_t limite = limites->prazo_ns ? chegada + limites->prazo_ns : 0;
+    int cara = limites->max_caras > 0 && estimar_custo_consulta(indices, n, consulta) >= limites->custo_caro;
+    if (cara && !admitir_consulta_cara(limites->max_caras, limite)) return -1;
+
+    iniciar_prazo(limite);
+    int linhas = responder_consulta_indices(resposta, indices, voos, n, consulta);
+    if (encerrar_prazo()) linhas = -1;
+    if (cara) liberar_vaga_cara();
+    return linhas;
+}
+
+/**
+ * Entrega o resultado inicial (quadro OK) ou uma diferença (quadro DIFF) de
+ * uma consulta permanente à conexão dona. É chamada com as consultas
+ * travadas, então só enfileira o quadro e acorda a thread da conexão; uma
+ * conexão com mais de SERVIDOR_MAX_PENDENTES bytes à espera é encerrada.
+ */
+static void entregar_permanente(void *dono, int id, TipoEntrega tipo, int linhas, const Saida *saida) {
+    Conexao *conexao = dono;
+    char cabecalho[64];
+    if (tipo == ENTREGA_INICIAL) {
+        snprintf(cabecalho, sizeof(cabecalho), "OK %d %zu\n", linhas, saida->tamanho);
+    } else {
+        snprintf(cabecalho, sizeof(cabecalho), "DIFF %d %d %zu\n", id, linhas, saida->tamanho);
+    }
+
+    pthread_mutex_lock(&conexao->trava);
+    if (!conexao->encerrada) {
+        Saida *pendentes = conexao->pendentes;
+        int avisar = pendentes->tamanho == 0;
+        if (pendentes->tamanho + strlen(cabecalho) + saida->tamanho > SERVIDOR_MAX_PENDENTES) {
+            // O cliente não lê as diferenças: a escrita bloqueada na sua thread falha e ela encerra
+            conexao->encerrada = 1;
+            pendentes->tamanho = 0;
+            shutdown(conexao->fd, SHUT_RDWR);
+            avisar = 1;
+        } else {
+            escrever_saida(pendentes, cabecalho, strlen(cabecalho));
+            escrever_saida(pendentes, saida->dados, saida->tamanho);
+        }
+        if (avisar) {
+            // Com o pipe cheio a thread já tem um aviso por ler
+            ssize_t r = write(conexao->aviso[1], "", 1);
+            (void)r;
+        }
+    }
+    pthread_mutex_unlock(&conexao->trava);
+}
+
+/**
+ * Atende consultas de uma conexão até o fim da entrada.
+ */
+void atender_conexao(int fd_entrada, int fd_saida, IndicesVoos *indices, Flight *voos, int n,
+                     CapturaConsultas *captura, const LimitesServidor *limites, ConsultasPermanentes *permanentes) {
+    Conexao conexao = { .fd = fd_saida };
+    if (pipe(conexao.aviso) < 0) {
+        perror("pipe");
+        return;
+    }
+    fcntl(conexao.aviso[0], F_SETFL, O_NONBLOCK);
+    fcntl(conexao.aviso[1], F_SETFL, O_NONBLOCK);
+    pthread_mutex_init(&conexao.trava, NULL);
+    conexao.envio = criar_saida(-1, 64 * 1024);
+    conexao.pendentes = criar_saida(-1, 4096);
+    LeitorLinhas leitor = { .fd = fd_entrada, .conexao = &conexao, .inicio = 0, .fim = 0 };
+    Saida *resposta = criar_saida(-1, 64 * 1024);
+    char linha[SERVIDOR_MAX_LINHA];
+    char cabecalho[64];
+
+    while (conexao_ativa(&conexao) && ler_linha(&leitor, linha, sizeof(linha)) >= 0) {
+        // Ignora linhas vazias (ex: keep-alive de clientes interativos)
+        if (linha[0] == '\0' || linha[0] == '\r') continue;
+
+        resposta->tamanho = 0;
+        Query consulta;
+        int id;
+        char campo[4], valor[32];
+        if (strncmp(linha, "upd ", 4) == 0) {
+            // Atualização: "upd <id> <prc|sea> <valor>" (não bloqueia as consultas em andamento)
+            if (sscanf(linha + 4, "%d %3s %31s", &id, campo, valor) == 3 &&
+                atualizar_voo_permanentes(permanentes, id, campo, valor)) {
+                snprintf(cabecalho, sizeof(cabecalho), "OK 0 0\n");
+            } else {
+                const char *msg = "atualizacao invalida\n";
+                escrever_saida(resposta, msg, strlen(msg));
+                snprintf(cabecalho, sizeof(cabecalho), "ERR %zu\n", resposta->tamanho);
+            }
+        } else if (strncmp(linha, "watch ", 6) == 0) {
+            // Consulta permanente: o quadro OK do resultado inicial é enfileirado no registro
+            if (interpretar_consulta(linha + 6, &consulta) &&
+                registrar_permanente(permanentes, &consulta, &conexao) >= 0) {
+                enviar_quadro(&conexao, NULL, NULL);
+                continue;
+            }
+            const char *msg = "consulta permanente invalida\n";
+            escrever_saida(resposta, msg, strlen(msg));
+            snprintf(cabecalho, sizeof(cabecalho), "ERR %zu\n", resposta->tamanho);
+        } else if (strncmp(linha, "unwatch ", 8) == 0) {
+            if (sscanf(linha + 8, "%d", &id) == 1 && remover_permanente(permanentes, id, &conexao)) {
+                snprintf(cabecalho, sizeof(cabecalho), "OK 0 0\n");
+            } else {
+                const char *msg = "consulta permanente inexistente\n";
+                escrever_saida(resposta, msg, strlen(msg));
+                snprintf(cabecalho, sizeof(cabecalho), "ERR %zu\n", resposta->tamanho);
+            }
+        } else if (!interpretar_consulta(linha, &consulta)) {
+            const char *msg = "consulta invalida\n";
+            escrever_saida(resposta, msg, strlen(msg));
+            snprintf(cabecalho, sizeof(cabecalho), "ERR %zu\n", resposta->tamanho);
+        } else {
+            uint64_t chegada = captura || limites ? relogio_ns() : 0;
+            int linhas = responder_no_prazo(resposta, indices, voos, n, &consulta, limites, chegada);
+            if (captura) registrar_consulta(captura, &consulta, chegada, relogio_ns());
+            if (linhas < 0) {
+                // Prazo esgotado: descarta o resultado incompleto
+                resposta->tamanho = 0;
+                imprimir_consulta(resposta, &consulta);
+                snprintf(cabecalho, sizeof(cabecalho), "TIMEOUT 1 %zu\n", resposta->tamanho);
+            } else {
+                snprintf(cabecalho, sizeof(cabecalho), "OK %d %zu\n", linhas, resposta->tamanho);
+            }
+        }
+        enviar_quadro(&conexao, cabecalho, resposta);
+    }
+
+    // Depois disto nenhuma diferença é entregue a esta conexão
+    remover_permanentes_do_dono(permanentes, &conexao);
+    liberar_saida(resposta);
+    liberar_saida(conexao.envio);
+    liberar_saida(conexao.pendentes);
+    close(conexao.aviso[0]);
+    close(conexao.aviso[1]);
+    pthread_mutex_destroy(&conexao.trava);
+}
+
+/**
+ * Thread de atendimento de um cliente do socket. Sai da lista de clientes
+ * antes de fechar o descritor, então o encerramento nunca o vê reaproveitado.
+ */
+static void *thread_cliente(void *arg) {
+    ArgsCliente *args = arg;
+    atender_conexao(args->fd, args->fd, args->indices, args->voos, args->n, args->captura, args->limites,
+                    args->permanentes);
+
+    pthread_mutex_lock(&trava_clientes);
+    if (args->ant) args->ant->prox = args->prox;
+    else clientes_ativos = args->prox;
+    if (args->prox) args->prox->ant = args->ant;
+    num_clientes--;
+    pthread_cond_signal(&cliente_encerrado);
+    pthread_mutex_unlock(&trava_clientes);
+
+    close(args->fd);
+    free(args);
+    return NULL;
+}
+
+/**
+ * Espera até haver menos de SERVIDOR_MAX_CONEXOES clientes. A espera acorda
+ * periodicamente para o laço de accept() ver o sinal de encerramento.
+ * @return 1 se há vaga, 0 se o prazo da espera acabou sem vaga.
+ */
+static int esperar_vaga_cliente() {
+    pthread_mutex_lock(&trava_clientes);
+    if (num_clientes >= SERVIDOR_MAX_CONEXOES) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += 100000000L;
+        if (ts.tv_nsec >= 1000000000L) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&cliente_encerrado, &trava_clientes, &ts);
+    }
+    int vaga = num_clientes < SERVIDOR_MAX_CONEXOES;
+    pthread_mutex_unlock(&trava_clientes);
+    return vaga;
+}
+
+/**
+ * Encerra as conexões em andamento e espera as suas threads terminarem: o
+ * shutdown() faz a leitura bloqueada de cada cliente ver o fim da entrada
+ * (e uma escrita pendente falhar), então a consulta em curso termina e a
+ * thread sai. Depois disto ninguém mais usa os índices, os voos ou as
+ * consultas permanentes.
+ */
+static void encerrar_clientes() {
+    pthread_mutex_lock(&trava_clientes);
+    for (ArgsCliente *c = clientes_ativos; c; c = c->prox) shutdown(c->fd, SHUT_RDWR);
+    while (clientes_ativos) pthread_cond_wait(&cliente_encerrado, &trava_clientes);
+    pthread_mutex_unlock(&trava_clientes);
+}
+
+/**
+ * Executa o servidor sobre a entrada padrão ou um socket Unix.
+ */
+int executar_servidor(const char *caminho, IndicesVoos *indices, Flight *voos, int n, CapturaConsultas *captura,
+                      const LimitesServidor *limites) {
+    // Clientes que desconectam no meio de uma resposta não devem derrubar o processo
+    signal(SIGPIPE, SIG_IGN);
+    ConsultasPermanentes *permanentes = criar_permanentes(indices, voos, n, entregar_permanente);
+
+    if (strcmp(caminho, "-") == 0) {
+        atender_conexao(STDIN_FILENO, STDOUT_FILENO, indices, voos, n, captura, limites, permanentes);
+        liberar_permanentes(permanentes);
+        return EXIT_SUCCESS;
+    }
+
+    struct sockaddr_un endereco;
+    if (strlen(caminho) >= sizeof(endereco.sun_path)) {
+        fprintf(stderr, "Caminho de socket muito longo: %s\n", caminho);
+        liberar_permanentes(permanentes);
+        return EXIT_FAILURE;
+    }
+
+    int fd_servidor = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_servidor < 0) {
+        perror("socket");
+        liberar_permanentes(permanentes);
+        return EXIT_FAILURE;
+    }
+
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    strcpy(endereco.sun_path, caminho);
+    unlink(caminho);
+
+    if (bind(fd_servidor, (struct sockaddr *)&endereco, sizeof(endereco)) < 0 ||
+        listen(fd_servidor, SERVIDOR_FILA) < 0) {
+        perror("bind/listen");
+        close(fd_servidor);
+        liberar_permanentes(permanentes);
+        return EXIT_FAILURE;
+    }
+
+    // Sem SA_RESTART: accept() retorna EINTR e o laço pode encerrar
+    struct sigaction acao;
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = tratar_sinal;
+    sigaction(SIGINT, &acao, NULL);
+    sigaction(SIGTERM, &acao, NULL);
+
+    fprintf(stderr, "Servidor pronto em %s (%d voos).\n", caminho, n);
+
+    while (!encerrar_servidor) {
+        // Cada cliente ocupa um slot de época: no limite, as novas conexões esperam na fila do listen()
+        if (!esperar_vaga_cliente()) continue;
+
+        int fd_cliente = accept(fd_servidor, NULL, NULL);
+        if (fd_cliente < 0) {
+            if (errno == EINTR) continue;
+            perror("accept");
+            break;
+        }
+
+        ArgsCliente *args = malloc(sizeof(ArgsCliente));
+        if (!args) {
+            fprintf(stderr, "Erro ao alocar memória para o cliente.\n");
+            close(fd_cliente);
+            continue;
+        }
+        args->fd = fd_cliente;
+        args->indices = indices;
+        args->voos = voos;
+        args->n = n;
+        args->captura = captura;
+        args->limites = limites;
+        args->permanentes = permanentes;
+        args->ant = NULL;
+
+        // Entra na lista antes de a thread existir: ela pode terminar antes de pthread_create retornar
+        pthread_mutex_lock(&trava_clientes);
+        args->prox = clientes_ativos;
+        if (clientes_ativos) clientes_ativos->ant = args;
+        clientes_ativos = args;
+        num_clientes++;
+        pthread_mutex_unlock(&trava_clientes);
+
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, thread_cliente, args) != 0) {
+            fprintf(stderr, "Erro ao criar thread para o cliente.\n");
+            pthread_mutex_lock(&trava_clientes);
+            clientes_ativos = args->prox;
+            if (args->prox) args->prox->ant = NULL;
+            num_clientes--;
+            pthread_mutex_unlock(&trava_clientes);
+            close(fd_cliente);
+            free(args);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+
+    close(fd_servidor);
+    unlink(caminho);
+    encerrar_clientes();
+    liberar_permanentes(permanentes);
+    return EXIT_SUCCESS;
+}
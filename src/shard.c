@@ -0,0 +1,313 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "shard.h"
+#include "sort.h"
+#include "cursor.h"
+
+/**
+ * Estado de uma fatia durante a execução de uma consulta.
+ */
+typedef struct {
+    Fatia *fatia;
+    const ExprNode *expressao; // Expressão da consulta
+    FaixaPredicado predicado;  // Predicado único de uma agregação pelos índices
+    AVLNode *acumulado;        // Ids locais que satisfazem a expressão
+    const Query *consulta;
+    const Flight **melhores;   // Top-K local, em ordem
+    int num_melhores;
+    AgregadoPreco agregado;    // Resultado local de uma agregação
+} EstadoFatia;
+
+/**
+ * Avalia a expressão completa nos índices da fatia.
+ */
+static void tarefa_avaliar(void *arg) {
+    EstadoFatia *e = arg;
+    e->acumulado = avaliar_expressao(e->fatia->arvores, e->fatia->voos, e->fatia->n, e->expressao);
+}
+
+/**
+ * Desce o elemento `i` no heap de máximo (o pior dos selecionados fica na raiz).
+ */
+static void descer_heap(const Flight **heap, int n, int i, const char *trigrama) {
+    while (1) {
+        int maior = i, esq = 2 * i + 1, dir = 2 * i + 2;
+        if (esq < n && comparar_voos_id(heap[esq], heap[maior], trigrama) > 0) maior = esq;
+        if (dir < n && comparar_voos_id(heap[dir], heap[maior], trigrama) > 0) maior = dir;
+        if (maior == i) return;
+        const Flight *t = heap[i]; heap[i] = heap[maior]; heap[maior] = t;
+        i = maior;
+    }
+}
+
+/**
+ * Etapa final: seleciona os `max_voos` melhores voos da fatia (posteriores
+ * ao cursor, numa página) com um heap limitado e os deixa em ordem crescente.
+ */
+static void tarefa_selecionar(void *arg) {
+    EstadoFatia *e = arg;
+    const char *trigrama = e->consulta->trigrama;
+    int k = limite_pagina(e->consulta);
+
+    e->melhores = NULL;
+    e->num_melhores = 0;
+    if (!e->acumulado) return;
+    if (k <= 0) {
+        liberar_avl(e->acumulado);
+        e->acumulado = NULL;
+        return;
+    }
+
+    int n = e->acumulado->num_indices;
+    int *ids = malloc(n * sizeof(int));
+    e->melhores = malloc((k < n ? k : n) * sizeof(Flight *));
+    if (!ids || !e->melhores) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        exit(EXIT_FAILURE);
+    }
+    extrair_indices_no(e->acumulado, ids);
+
+    const Flight **heap = e->melhores;
+    int tamanho = 0;
+    for (int i = 0; i < n; i++) {
+        const Flight *voo = &e->fatia->voos[ids[i]];
+        if (!depois_do_cursor(e->consulta, voo)) continue;
+        if (tamanho < k) {
+            // Sobe o novo elemento
+            int j = tamanho++;
+            heap[j] = voo;
+            while (j > 0 && comparar_voos_id(heap[(j - 1) / 2], heap[j], trigrama) < 0) {
+                const Flight *t = heap[j]; heap[j] = heap[(j - 1) / 2]; heap[(j - 1) / 2] = t;
+                j = (j - 1) / 2;
+            }
+        } else if (comparar_voos_id(voo, heap[0], trigrama) < 0) {
+            heap[0] = voo;
+            descer_heap(heap, tamanho, 0, trigrama);
+        }
+    }
+    free(ids);
+
+    // Heapsort: retira o maior para o fim até esvaziar
+    for (int fim = tamanho - 1; fim > 0; fim--) {
+        const Flight *t = heap[0]; heap[0] = heap[fim]; heap[fim] = t;
+        descer_heap(heap, fim, 0, trigrama);
+    }
+    e->num_melhores = tamanho;
+
+    liberar_avl(e->acumulado);
+    e->acumulado = NULL;
+}
+
+/**
+ * Etapa final de uma agregação: soma os preços dos ids acumulados da fatia.
+ */
+static void tarefa_agregar(void *arg) {
+    EstadoFatia *e = arg;
+    AgregadoPreco vazio = AGREGADO_PRECO_VAZIO;
+    e->agregado = vazio;
+    if (!e->acumulado) return;
+
+    int n = e->acumulado->num_indices;
+    int *ids = malloc(n * sizeof(int));
+    if (!ids) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        exit(EXIT_FAILURE);
+    }
+    extrair_indices_no(e->acumulado, ids);
+    for (int i = 0; i < n; i++) {
+        acumular_preco(&e->agregado, e->fatia->voos[ids[i]].preco);
+    }
+    free(ids);
+
+    liberar_avl(e->acumulado);
+    e->acumulado = NULL;
+}
+
+/**
+ * Agregação de um único predicado pelos agregados das subárvores da fatia.
+ */
+static void tarefa_agregar_indice(void *arg) {
+    EstadoFatia *e = arg;
+    agregar_indice_avl(e->fatia->arvores[e->predicado.campo], &e->predicado, &e->agregado);
+}
+
+/**
+ * Executa uma tarefa em todas as fatias e aguarda o término.
+ */
+static void executar_em_fatias(ConjuntoFatias *conjunto, EstadoFatia *estados, void (*tarefa)(void *)) {
+    if (conjunto->num_fatias == 1) {
+        tarefa(&estados[0]);
+        return;
+    }
+    for (int s = 0; s < conjunto->num_fatias; s++) {
+        submeter_tarefa(conjunto->pool, tarefa, &estados[s]);
+    }
+    aguardar_pool(conjunto->pool);
+}
+
+/**
+ * Particiona os voos em fatias de ids contíguos e constrói os índices de cada uma.
+ */
+ConjuntoFatias *criar_fatias(Flight *voos, int n, int num_fatias, int num_threads) {
+    if (num_fatias < 1) num_fatias = 1;
+    if (num_fatias > n && n > 0) num_fatias = n;
+
+    ConjuntoFatias *conjunto = malloc(sizeof(ConjuntoFatias));
+    if (!conjunto) {
+        fprintf(stderr, "Erro ao alocar memória para as fatias.\n");
+        exit(EXIT_FAILURE);
+    }
+    conjunto->num_fatias = num_fatias;
+    conjunto->fatias = calloc(num_fatias, sizeof(Fatia));
+    if (!conjunto->fatias) {
+        fprintf(stderr, "Erro ao alocar memória para as fatias.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Cada fatia é construída com todas as threads (construção em lote já é paralela)
+    for (int s = 0; s < num_fatias; s++) {
+        Fatia *fatia = &conjunto->fatias[s];
+        int inicio = (int)((long)n * s / num_fatias);
+        int fim = (int)((long)n * (s + 1) / num_fatias);
+        fatia->voos = voos + inicio;
+        fatia->n = fim - inicio;
+        for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+            fatia->arvores[f] = criar_avl();
+        }
+        construir_arvores_indices(fatia->arvores, fatia->voos, fatia->n);
+    }
+
+    conjunto->pool = criar_pool(num_threads);
+    return conjunto;
+}
+
+/**
+ * Comprime as listas de índices de todas as fatias.
+ */
+void comprimir_fatias(ConjuntoFatias *conjunto) {
+    for (int s = 0; s < conjunto->num_fatias; s++) {
+        for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+            comprimir_avl(conjunto->fatias[s].arvores[f]->raiz);
+        }
+    }
+}
+
+/**
+ * Libera as fatias, seus índices e o pool.
+ */
+void liberar_fatias(ConjuntoFatias *conjunto) {
+    if (!conjunto) return;
+    destruir_pool(conjunto->pool);
+    for (int s = 0; s < conjunto->num_fatias; s++) {
+        for (int f = 0; f < NUM_CAMPOS_INDICE; f++) {
+            liberar_avl(conjunto->fatias[s].arvores[f]->raiz);
+            free(conjunto->fatias[s].arvores[f]);
+        }
+    }
+    free(conjunto->fatias);
+    free(conjunto);
+}
+
+/**
+ * Avalia a expressão da consulta em todas as fatias, deixando em cada estado
+ * o acumulado de ids locais. Como uma folha sem resultados esvazia a
+ * conjunção, cada fatia avalia a expressão inteira sem depender das outras.
+ */
+static EstadoFatia *avaliar_em_fatias(ConjuntoFatias *conjunto, const Query *consulta) {
+    int num_fatias = conjunto->num_fatias;
+    EstadoFatia *estados = calloc(num_fatias, sizeof(EstadoFatia));
+    if (!estados) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    ExprNode *expressao = parse_expressao(consulta->expressao);
+    for (int s = 0; s < num_fatias; s++) {
+        estados[s].fatia = &conjunto->fatias[s];
+        estados[s].consulta = consulta;
+        estados[s].expressao = expressao;
+    }
+    if (expressao) executar_em_fatias(conjunto, estados, tarefa_avaliar);
+    liberar_expressao(expressao);
+    return estados;
+}
+
+/**
+ * Responde uma consulta espalhando-a pelas fatias.
+ */
+int responder_consulta_fatias(ConjuntoFatias *conjunto, const Query *consulta, const Flight ***resultados) {
+    int num_fatias = conjunto->num_fatias;
+    EstadoFatia *estados = avaliar_em_fatias(conjunto, consulta);
+
+    executar_em_fatias(conjunto, estados, tarefa_selecionar);
+
+    // Intercalação k-way dos parciais já ordenados
+    int k = limite_pagina(consulta);
+    *resultados = malloc((k ? k : 1) * sizeof(Flight *));
+    int *posicao = calloc(num_fatias, sizeof(int));
+    if (!*resultados || !posicao) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int count = 0;
+    while (count < k) {
+        int escolhida = -1;
+        for (int s = 0; s < num_fatias; s++) {
+            if (posicao[s] >= estados[s].num_melhores) continue;
+            if (escolhida < 0 ||
+                comparar_voos_id(estados[s].melhores[posicao[s]],
+                                estados[escolhida].melhores[posicao[escolhida]],
+                                consulta->trigrama) < 0) {
+                escolhida = s;
+            }
+        }
+        if (escolhida < 0) break;
+        (*resultados)[count++] = estados[escolhida].melhores[posicao[escolhida]++];
+    }
+
+    for (int s = 0; s < num_fatias; s++) free(estados[s].melhores);
+    free(posicao);
+    free(estados);
+    return count;
+}
+
+/**
+ * Agrega os preços dos voos que atendem à consulta em todas as fatias.
+ */
+void agregar_consulta_fatias(ConjuntoFatias *conjunto, const Query *consulta, AgregadoPreco *agregado) {
+    AgregadoPreco vazio = AGREGADO_PRECO_VAZIO;
+    *agregado = vazio;
+
+    ExprNode *expressao = parse_expressao(consulta->expressao);
+    if (!expressao) return;
+
+    FaixaPredicado predicado;
+    int indexado = expressao->operator != OP_AND && converter_faixa_predicado(expressao, &predicado) &&
+                   predicado.campo != CAMPO_PARTIDA;
+
+    EstadoFatia *estados;
+    if (indexado) {
+        // Predicado único indexado: cada fatia responde pelos agregados das subárvores
+        estados = calloc(conjunto->num_fatias, sizeof(EstadoFatia));
+        if (!estados) {
+            fprintf(stderr, "Erro de alocação de memória.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (int s = 0; s < conjunto->num_fatias; s++) {
+            estados[s].fatia = &conjunto->fatias[s];
+            estados[s].predicado = predicado;
+        }
+        executar_em_fatias(conjunto, estados, tarefa_agregar_indice);
+    } else {
+        estados = avaliar_em_fatias(conjunto, consulta);
+        executar_em_fatias(conjunto, estados, tarefa_agregar);
+    }
+
+    for (int s = 0; s < conjunto->num_fatias; s++) {
+        combinar_agregados(agregado, &estados[s].agregado);
+    }
+    free(estados);
+    liberar_expressao(expressao);
+}
@@ -1,4 +1,5 @@
 #include "sort.h"
+#include "deadline.h"
 
 /**
  * Compara dois voos com base nos critérios do trigrama.
@@ -28,64 +29,168 @@ int comparar_voos(const Flight *a, const Flight *b, const char *trigrama) {
 }
 
 /**
- * Particiona o vetor de voos para o QuickSort.
- * @param voos Vetor de voos.
- * @param baixo Índice inferior.
- * @param alto Índice superior.
+ * Compara dois voos pelo trigrama e, em caso de empate, pela posição na entrada.
+ * @param a Ponteiro para o primeiro voo.
+ * @param b Ponteiro para o segundo voo.
  * @param trigrama Critério de ordenação.
- * @return Índice do pivô após a partição.
+ * @return Valor negativo se a < b, positivo se a > b (nunca 0 para voos distintos).
+ */
+int comparar_voos_id(const Flight *a, const Flight *b, const char *trigrama) {
+    int c = comparar_voos(a, b, trigrama);
+    if (c != 0) return c;
+    return (a->id > b->id) - (a->id < b->id);
+}
+
+#define LIMIAR_INSERCAO 16   // Segmentos menores são ordenados por inserção
+#define LIMIAR_NINTHER 128   // A partir daqui o pivô é a mediana de três medianas
+
+/**
+ * Chave da ordenação de duas posições: o trigrama dos voos correspondentes
+ * e, no empate, o id (ordem de entrada, que difere da posição se os voos
+ * foram reagrupados). Com o id na chave, a ordem não depende de como a
+ * partição deixou os empates, e a inserção e o HeapSort chegam à mesma
+ * ordem que as fatias, o LSM e a varredura em lote.
  */
-int particionar(Flight *voos, int baixo, int alto, const char *trigrama) {
-    Flight pivo = voos[alto]; // Escolher o último elemento como pivô
-    int i = baixo - 1;
-
-    for (int j = baixo; j < alto; j++) {
-        if (comparar_voos(&voos[j], &pivo, trigrama) < 0) {
-            i++;
-            Flight temp = voos[i];
-            voos[i] = voos[j];
-            voos[j] = temp;
+static inline int comparar_chave(const Flight *voos, int a, int b, const char *trigrama) {
+    return comparar_voos_id(&voos[a], &voos[b], trigrama);
+}
+
+static inline void trocar(int *a, int *b) {
+    int temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+/**
+ * Ordenação por inserção para segmentos pequenos.
+ */
+static void ordenar_insercao(const Flight *voos, int *ids, int n, const char *trigrama) {
+    for (int i = 1; i < n; i++) {
+        int atual = ids[i];
+        int j = i - 1;
+        while (j >= 0 && comparar_chave(voos, ids[j], atual, trigrama) > 0) {
+            ids[j + 1] = ids[j];
+            j--;
         }
+        ids[j + 1] = atual;
+    }
+}
+
+/**
+ * Desce o elemento `i` no heap de máximo formado por ids[0..n).
+ */
+static void descer_heap(const Flight *voos, int *ids, int n, int i, const char *trigrama) {
+    while (1) {
+        int maior = i, esq = 2 * i + 1, dir = 2 * i + 2;
+        if (esq < n && comparar_chave(voos, ids[esq], ids[maior], trigrama) > 0) maior = esq;
+        if (dir < n && comparar_chave(voos, ids[dir], ids[maior], trigrama) > 0) maior = dir;
+        if (maior == i) return;
+        trocar(&ids[i], &ids[maior]);
+        i = maior;
+    }
+}
+
+/**
+ * HeapSort: alternativa O(n log n) quando a recursão passa do limite.
+ */
+static void ordenar_heap(const Flight *voos, int *ids, int n, const char *trigrama) {
+    for (int i = n / 2 - 1; i >= 0; i--) descer_heap(voos, ids, n, i, trigrama);
+    for (int fim = n - 1; fim > 0; fim--) {
+        trocar(&ids[0], &ids[fim]);
+        descer_heap(voos, ids, fim, 0, trigrama);
     }
+}
 
-    Flight temp = voos[i + 1];
-    voos[i + 1] = voos[alto];
-    voos[alto] = temp;
+/**
+ * Posição da mediana entre três posições.
+ */
+static int mediana_tres(const Flight *voos, const int *ids, int a, int b, int c, const char *trigrama) {
+    if (comparar_chave(voos, ids[a], ids[b], trigrama) < 0) {
+        if (comparar_chave(voos, ids[b], ids[c], trigrama) < 0) return b;
+        return comparar_chave(voos, ids[a], ids[c], trigrama) < 0 ? c : a;
+    }
+    if (comparar_chave(voos, ids[a], ids[c], trigrama) < 0) return a;
+    return comparar_chave(voos, ids[b], ids[c], trigrama) < 0 ? c : b;
+}
 
-    return i + 1;
+/**
+ * Escolhe o pivô: mediana de três (início, meio, fim) ou, em segmentos
+ * grandes, a mediana das medianas de três trios espaçados (ninther).
+ */
+static int escolher_pivo(const Flight *voos, const int *ids, int n, const char *trigrama) {
+    int meio = n / 2;
+    if (n < LIMIAR_NINTHER) return mediana_tres(voos, ids, 0, meio, n - 1, trigrama);
+
+    int passo = n / 8;
+    int a = mediana_tres(voos, ids, 0, passo, 2 * passo, trigrama);
+    int b = mediana_tres(voos, ids, meio - passo, meio, meio + passo, trigrama);
+    int c = mediana_tres(voos, ids, n - 1 - 2 * passo, n - 1 - passo, n - 1, trigrama);
+    return mediana_tres(voos, ids, a, b, c, trigrama);
 }
 
 /**
- * Implementação do QuickSort para ordenar os voos.
- * @param voos Vetor de voos.
- * @param baixo Índice inferior.
- * @param alto Índice superior.
- * @param trigrama Critério de ordenação.
+ * Introsort com partição em três vias (menores | iguais | maiores ao pivô).
+ * Só os segmentos que começam antes de `limite` são ordenados, pois as
+ * posições seguintes não chegam à saída.
+ * @param voos Vetor base de voos (lido pelos comparadores).
+ * @param ids Segmento de ids a ordenar.
+ * @param n Tamanho do segmento.
+ * @param trigrama Critério (empates pelo id).
+ * @param profundidade Partições restantes antes de recorrer ao HeapSort.
+ * @param limite Quantidade de posições iniciais do segmento que precisam ficar ordenadas.
  */
-void quick_sort_voos(Flight *voos, int baixo, int alto, const char *trigrama) {
-    if (baixo < alto) {
-        int pi = particionar(voos, baixo, alto, trigrama);
+static void introsort(const Flight *voos, int *ids, int n, const char *trigrama, int profundidade, int limite) {
+    while (n > LIMIAR_INSERCAO && limite > 0) {
+        // Ordenação interrompida: o resultado será descartado
+        if (verificar_prazo()) return;
+        if (profundidade-- == 0) {
+            ordenar_heap(voos, ids, n, trigrama);
+            return;
+        }
+
+        trocar(&ids[0], &ids[escolher_pivo(voos, ids, n, trigrama)]);
+        int pivo = ids[0];
 
-        quick_sort_voos(voos, baixo, pi - 1, trigrama);
-        quick_sort_voos(voos, pi + 1, alto, trigrama);
+        // Partição de Dijkstra: [0,lt) < pivô, [lt,i) == pivô, (gt,n) > pivô
+        int lt = 0, i = 1, gt = n - 1;
+        while (i <= gt) {
+            int c = comparar_chave(voos, ids[i], pivo, trigrama);
+            if (c < 0) trocar(&ids[lt++], &ids[i++]);
+            else if (c > 0) trocar(&ids[i], &ids[gt--]);
+            else i++;
+        }
+
+        // Recursão no lado menor e laço no maior: pilha O(log n)
+        int n_menor = lt, n_maior = n - i;
+        if (n_menor < n_maior) {
+            introsort(voos, ids, n_menor, trigrama, profundidade, limite);
+            ids += i;
+            n = n_maior;
+            limite -= i;
+        } else {
+            if (i < limite) introsort(voos, ids + i, n_maior, trigrama, profundidade, limite - i);
+            n = n_menor;
+        }
     }
+    if (limite > 0) ordenar_insercao(voos, ids, n, trigrama);
 }
 
 /**
- * Ordena os voos com base no critério do trigrama da consulta e seleciona os primeiros `n`.
- * @param voos Vetor de voos a serem ordenados.
- * @param total_voos Número total de voos no vetor.
+ * Ordena ids de voos com base no critério do trigrama da consulta; os campos
+ * são lidos do vetor base, sem copiar os voos. Empates no trigrama são
+ * decididos pelo id do voo (ordem de entrada).
+ * @param voos Vetor base de voos.
+ * @param ids Ids (posições em `voos`) a serem ordenados.
+ * @param total_voos Número de ids.
  * @param trigrama String de três caracteres indicando a ordem dos critérios.
  * @param max_resultados Número máximo de voos a serem considerados após a ordenação.
  */
-void ordenar_voos(Flight *voos, int total_voos, const char *trigrama, int max_resultados) {
-    if (!voos || total_voos <= 1) return;
+void ordenar_voos(const Flight *voos, int *ids, int total_voos, const char *trigrama, int max_resultados) {
+    if (!ids || total_voos <= 1 || max_resultados <= 0) return;
 
-    // 🔍 Ordena todos os voos antes de aplicar a limitação
-    quick_sort_voos(voos, 0, total_voos - 1, trigrama);
+    int profundidade = 0;
+    for (int n = total_voos; n > 1; n >>= 1) profundidade += 2;
 
-    // 🔍 Agora, apenas mantém os primeiros `max_resultados`
-    if (total_voos > max_resultados) {
-        total_voos = max_resultados;
-    }
+    // Só as primeiras `max_resultados` posições precisam sair ordenadas
+    introsort(voos, ids, total_voos, trigrama, profundidade, max_resultados);
 }
@@ -0,0 +1,459 @@
+#include <pthread.h>
+#include "standing.h"
+#include "sort.h"
+
+#define BALDE_GERAL -1  // Consultas sem igualdade de aeroporto
+
+/**
+ * Uma consulta permanente.
+ */
+typedef struct {
+    int id;
+    void *dono;
+    Query consulta;
+    FaixaPredicado folhas[MAX_FOLHAS_EXPRESSAO];
+    int num_folhas;
+    int64_t rota;        // Chave do balde (BALDE_GERAL sem aeroporto fixo)
+    int *melhores;       // Ids dos melhores voos, em ordem
+    int num_melhores;
+    int capacidade;      // PERMANENTE_FOLGA × max_voos
+    int completo;        // 1 se `melhores` contém todos os voos que atendem
+} ConsultaPermanente;
+
+/**
+ * Consultas de um aeroporto (ou as sem aeroporto fixo).
+ */
+typedef struct {
+    int64_t rota;        // Campo e aeroporto; -2 = balde livre na tabela
+    ConsultaPermanente **consultas;
+    int num;
+    int capacidade;
+} Balde;
+
+struct ConsultasPermanentes {
+    IndicesVoos *indices;
+    Flight *voos;
+    int n;
+    EntregarPermanente entregar;
+    pthread_mutex_t trava;
+
+    ConsultaPermanente **por_id;  // NULL nas removidas
+    int num_ids;
+    int capacidade_ids;
+
+    Balde *baldes;                // Tabela de endereçamento aberto por rota
+    int num_baldes;               // Potência de 2
+    int baldes_usados;
+    Balde geral;
+
+    Saida *saida;                 // Texto da entrega em montagem
+    int *anteriores;              // Resultado antes da alteração
+    int *antes;                   // Cópias ordenadas por id para as diferenças
+    int *depois;
+    int capacidade_rascunho;
+};
+
+static void *alocar(size_t tamanho) {
+    void *p = malloc(tamanho ? tamanho : 1);
+    if (!p) {
+        fprintf(stderr, "Erro ao alocar memória para as consultas permanentes.\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+/**
+ * Chave do balde de uma igualdade de aeroporto.
+ */
+static int64_t chave_rota(int campo, int64_t aeroporto) {
+    return ((int64_t)campo << 32) | aeroporto;
+}
+
+static unsigned posicao_rota(int64_t rota, int num_baldes) {
+    return (unsigned)(((uint64_t)rota * 0x9E3779B97F4A7C15ULL) >> 40) & (unsigned)(num_baldes - 1);
+}
+
+/**
+ * Encontra o balde da rota (NULL se não existe e `criar` é 0).
+ */
+static Balde *buscar_balde(ConsultasPermanentes *c, int64_t rota, int criar) {
+    if (rota == BALDE_GERAL) return &c->geral;
+
+    if (criar && 2 * (c->baldes_usados + 1) > c->num_baldes) {
+        // Dobra a tabela e reposiciona os baldes
+        Balde *antigos = c->baldes;
+        int num_antigos = c->num_baldes;
+        c->num_baldes *= 2;
+        c->baldes = alocar(c->num_baldes * sizeof(Balde));
+        for (int b = 0; b < c->num_baldes; b++) c->baldes[b].rota = -2;
+        for (int b = 0; b < num_antigos; b++) {
+            if (antigos[b].rota == -2) continue;
+            unsigned p = posicao_rota(antigos[b].rota, c->num_baldes);
+            while (c->baldes[p].rota != -2) p = (p + 1) & (unsigned)(c->num_baldes - 1);
+            c->baldes[p] = antigos[b];
+        }
+        free(antigos);
+    }
+
+    unsigned p = posicao_rota(rota, c->num_baldes);
+    while (c->baldes[p].rota != -2) {
+        if (c->baldes[p].rota == rota) return &c->baldes[p];
+        p = (p + 1) & (unsigned)(c->num_baldes - 1);
+    }
+    if (!criar) return NULL;
+
+    Balde *balde = &c->baldes[p];
+    balde->rota = rota;
+    balde->consultas = NULL;
+    balde->num = balde->capacidade = 0;
+    c->baldes_usados++;
+    return balde;
+}
+
+static void adicionar_no_balde(Balde *balde, ConsultaPermanente *q) {
+    if (balde->num == balde->capacidade) {
+        balde->capacidade = balde->capacidade ? balde->capacidade * 2 : 4;
+        balde->consultas = realloc(balde->consultas, balde->capacidade * sizeof(ConsultaPermanente *));
+        if (!balde->consultas) {
+            fprintf(stderr, "Erro ao alocar memória para as consultas permanentes.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    balde->consultas[balde->num++] = q;
+}
+
+static void retirar_do_balde(Balde *balde, const ConsultaPermanente *q) {
+    for (int i = 0; i < balde->num; i++) {
+        if (balde->consultas[i] == q) {
+            balde->consultas[i] = balde->consultas[--balde->num];
+            return;
+        }
+    }
+}
+
+/**
+ * Cria o conjunto de consultas permanentes de uma tabela.
+ */
+ConsultasPermanentes *criar_permanentes(IndicesVoos *indices, Flight *voos, int n, EntregarPermanente entregar) {
+    ConsultasPermanentes *c = alocar(sizeof(ConsultasPermanentes));
+    memset(c, 0, sizeof(*c));
+    c->indices = indices;
+    c->voos = voos;
+    c->n = n;
+    c->entregar = entregar;
+    pthread_mutex_init(&c->trava, NULL);
+
+    c->num_baldes = PERMANENTES_BALDES_INICIAIS;
+    c->baldes = alocar(c->num_baldes * sizeof(Balde));
+    for (int b = 0; b < c->num_baldes; b++) c->baldes[b].rota = -2;
+    c->geral.rota = BALDE_GERAL;
+    c->saida = criar_saida(-1, 4096);
+    return c;
+}
+
+static void liberar_consulta(ConsultaPermanente *q) {
+    free(q->melhores);
+    free(q);
+}
+
+/**
+ * Libera o conjunto e todas as consultas registradas.
+ */
+void liberar_permanentes(ConsultasPermanentes *c) {
+    if (!c) return;
+    for (int i = 0; i < c->num_ids; i++) {
+        if (c->por_id[i]) liberar_consulta(c->por_id[i]);
+    }
+    for (int b = 0; b < c->num_baldes; b++) {
+        if (c->baldes[b].rota != -2) free(c->baldes[b].consultas);
+    }
+    free(c->geral.consultas);
+    free(c->baldes);
+    free(c->por_id);
+    free(c->anteriores);
+    free(c->antes);
+    free(c->depois);
+    liberar_saida(c->saida);
+    pthread_mutex_destroy(&c->trava);
+    free(c);
+}
+
+/**
+ * Verifica se o voo atende a todas as folhas da consulta.
+ */
+static int voo_atende(const ConsultaPermanente *q, const Flight *voo) {
+    for (int f = 0; f < q->num_folhas; f++) {
+        int64_t chave = chave_voo(voo, q->folhas[f].campo);
+        if (chave < q->folhas[f].min || chave > q->folhas[f].max) return 0;
+    }
+    return 1;
+}
+
+/**
+ * Reexecuta a consulta nos índices e guarda os seus melhores voos.
+ */
+static void recompor_melhores(ConsultasPermanentes *c, ConsultaPermanente *q) {
+    int *ids;
+    int num = filtrar_voos(c->indices, c->voos, c->n, &q->consulta, &ids);
+    ordenar_voos(c->voos, ids, num, q->consulta.trigrama, q->capacidade);
+    q->num_melhores = num < q->capacidade ? num : q->capacidade;
+    memcpy(q->melhores, ids, q->num_melhores * sizeof(int));
+    q->completo = num <= q->capacidade;
+    free(ids);
+}
+
+/**
+ * Posição em que o voo entra entre os melhores (busca binária).
+ */
+static int posicao_insercao(const ConsultasPermanentes *c, const ConsultaPermanente *q, const Flight *voo) {
+    int ini = 0, fim = q->num_melhores;
+    while (ini < fim) {
+        int meio = ini + (fim - ini) / 2;
+        if (comparar_voos_id(&c->voos[q->melhores[meio]], voo, q->consulta.trigrama) < 0) ini = meio + 1;
+        else fim = meio;
+    }
+    return ini;
+}
+
+static int comparar_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static int contem_id(const int *ordenados, int n, int id) {
+    return bsearch(&id, ordenados, n, sizeof(int), comparar_int) != NULL;
+}
+
+/**
+ * Garante o rascunho das diferenças para resultados de até `n` voos.
+ */
+static void reservar_rascunho(ConsultasPermanentes *c, int n) {
+    if (n <= c->capacidade_rascunho) return;
+    free(c->anteriores);
+    free(c->antes);
+    free(c->depois);
+    c->anteriores = alocar(n * sizeof(int));
+    c->antes = alocar(n * sizeof(int));
+    c->depois = alocar(n * sizeof(int));
+    c->capacidade_rascunho = n;
+}
+
+/**
+ * Escreve a linha "+ <posição> <id> <voo>" de um voo que entra no resultado.
+ */
+static void escrever_entrada(Saida *saida, int posicao, int id, const Flight *voo) {
+    char texto[32];
+    int tamanho = snprintf(texto, sizeof(texto), "+ %d %d ", posicao, id);
+    escrever_saida(saida, texto, (size_t)tamanho);
+    imprimir_voo(saida, voo);
+}
+
+/**
+ * Compara o resultado anterior com o atual e entrega as linhas "-" e "+".
+ * @param anteriores Os `max_voos` primeiros antes da alteração.
+ * @param alterado Id do voo alterado (sai e entra se continuar no resultado).
+ */
+static void entregar_diferenca(ConsultasPermanentes *c, const ConsultaPermanente *q, const int *anteriores,
+                               int num_anteriores, int alterado) {
+    int k = q->consulta.max_voos;
+    int num_atuais = q->num_melhores < k ? q->num_melhores : k;
+    const int *atuais = q->melhores;
+
+    // Cópias ordenadas por id para os testes de pertinência
+    int *antes = c->antes, *depois = c->depois;
+    memcpy(antes, anteriores, num_anteriores * sizeof(int));
+    memcpy(depois, atuais, num_atuais * sizeof(int));
+    qsort(antes, num_anteriores, sizeof(int), comparar_int);
+    qsort(depois, num_atuais, sizeof(int), comparar_int);
+
+    Saida *saida = c->saida;
+    saida->tamanho = 0;
+    int linhas = 0;
+    char texto[48];
+    for (int i = 0; i < num_anteriores; i++) {
+        int id = anteriores[i];
+        if (id != alterado && contem_id(depois, num_atuais, id)) continue;
+        int tamanho = snprintf(texto, sizeof(texto), "- %d\n", id);
+        escrever_saida(saida, texto, (size_t)tamanho);
+        linhas++;
+    }
+    for (int p = 0; p < num_atuais; p++) {
+        int id = atuais[p];
+        if (id != alterado && contem_id(antes, num_anteriores, id)) continue;
+        escrever_entrada(saida, p, id, &c->voos[id]);
+        linhas++;
+    }
+    if (linhas > 0) c->entregar(q->dono, q->id, ENTREGA_DIFERENCA, linhas, saida);
+}
+
+/**
+ * Mantém uma consulta depois da alteração de um voo.
+ */
+static void manter_consulta(ConsultasPermanentes *c, ConsultaPermanente *q, int id) {
+    int k = q->consulta.max_voos;
+    if (k <= 0) return;
+
+    const Flight *voo = &c->voos[id];
+    int posicao = -1;
+    for (int i = 0; i < q->num_melhores; i++) {
+        if (q->melhores[i] == id) {
+            posicao = i;
+            break;
+        }
+    }
+    int atende = voo_atende(q, voo);
+    if (posicao < 0 && !atende) return;
+
+    // Um voo pior que todos os guardados não muda os melhores (os não guardados são piores que eles)
+    if (posicao < 0 && !q->completo &&
+        comparar_voos_id(voo, &c->voos[q->melhores[q->num_melhores - 1]], q->consulta.trigrama) > 0) {
+        return;
+    }
+
+    int num_anteriores = q->num_melhores < k ? q->num_melhores : k;
+    reservar_rascunho(c, q->capacidade);
+    memcpy(c->anteriores, q->melhores, num_anteriores * sizeof(int));
+
+    if (posicao >= 0) {
+        memmove(&q->melhores[posicao], &q->melhores[posicao + 1], (q->num_melhores - posicao - 1) * sizeof(int));
+        q->num_melhores--;
+    }
+    if (atende && (q->completo || (q->num_melhores > 0 && comparar_voos_id(
+                       voo, &c->voos[q->melhores[q->num_melhores - 1]], q->consulta.trigrama) < 0))) {
+        if (q->num_melhores == q->capacidade) {
+            // O último sai da folga: os voos depois dele deixam de ser conhecidos
+            q->num_melhores--;
+            q->completo = 0;
+        }
+        int p = posicao_insercao(c, q, voo);
+        memmove(&q->melhores[p + 1], &q->melhores[p], (q->num_melhores - p) * sizeof(int));
+        q->melhores[p] = id;
+        q->num_melhores++;
+    }
+    if (!q->completo && q->num_melhores < k) recompor_melhores(c, q);
+
+    entregar_diferenca(c, q, c->anteriores, num_anteriores, id);
+}
+
+/**
+ * Mantém as consultas que o voo pode afetar: as da sua origem, do seu
+ * destino e as sem aeroporto fixo.
+ */
+static void processar_voo(ConsultasPermanentes *c, int id) {
+    if (id < 0 || id >= c->n) return;
+    const Flight *voo = &c->voos[id];
+    Balde *baldes[3] = {
+        buscar_balde(c, chave_rota(CAMPO_ORIGEM, chave_aeroporto(voo->origem)), 0),
+        buscar_balde(c, chave_rota(CAMPO_DESTINO, chave_aeroporto(voo->destino)), 0),
+        &c->geral,
+    };
+    for (int b = 0; b < 3; b++) {
+        if (!baldes[b]) continue;
+        for (int i = 0; i < baldes[b]->num; i++) manter_consulta(c, baldes[b]->consultas[i], id);
+    }
+}
+
+/**
+ * Registra uma listagem e entrega o resultado inicial.
+ */
+int registrar_permanente(ConsultasPermanentes *c, const Query *consulta, void *dono) {
+    if (consulta->agregacao != AGREGACAO_NENHUMA || consulta->paginada) return -1;
+
+    ConsultaPermanente *q = alocar(sizeof(ConsultaPermanente));
+    q->consulta = *consulta;
+    q->dono = dono;
+    ExprNode *expressao = parse_expressao(consulta->expressao);
+    q->num_folhas = expressao ? converter_folhas_expressao(expressao, q->folhas, MAX_FOLHAS_EXPRESSAO) : -1;
+    liberar_expressao(expressao);
+    if (q->num_folhas <= 0) {
+        free(q);
+        return -1;
+    }
+
+    // Igualdade de origem (ou de destino) escolhe o balde
+    q->rota = BALDE_GERAL;
+    for (int campo = CAMPO_ORIGEM; campo <= CAMPO_DESTINO && q->rota == BALDE_GERAL; campo++) {
+        for (int f = 0; f < q->num_folhas; f++) {
+            if (q->folhas[f].campo == campo && q->folhas[f].min == q->folhas[f].max) {
+                q->rota = chave_rota(campo, q->folhas[f].min);
+                break;
+            }
+        }
+    }
+    q->capacidade = consulta->max_voos > 0 ? PERMANENTE_FOLGA * consulta->max_voos : 0;
+    q->melhores = alocar(q->capacidade * sizeof(int));
+    q->num_melhores = 0;
+    q->completo = 1;
+
+    pthread_mutex_lock(&c->trava);
+    if (q->capacidade > 0) recompor_melhores(c, q);
+
+    if (c->num_ids == c->capacidade_ids) {
+        c->capacidade_ids = c->capacidade_ids ? c->capacidade_ids * 2 : 16;
+        c->por_id = realloc(c->por_id, c->capacidade_ids * sizeof(ConsultaPermanente *));
+        if (!c->por_id) {
+            fprintf(stderr, "Erro ao alocar memória para as consultas permanentes.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    q->id = c->num_ids++;
+    c->por_id[q->id] = q;
+    adicionar_no_balde(buscar_balde(c, q->rota, 1), q);
+
+    // Resultado inicial, entregue antes que qualquer alteração possa gerar diferenças
+    Saida *saida = c->saida;
+    saida->tamanho = 0;
+    char texto[32];
+    int tamanho = snprintf(texto, sizeof(texto), "watch %d\n", q->id);
+    escrever_saida(saida, texto, (size_t)tamanho);
+    imprimir_consulta(saida, consulta);
+    int impressos = q->num_melhores < consulta->max_voos ? q->num_melhores : consulta->max_voos;
+    for (int i = 0; i < impressos; i++) escrever_entrada(saida, i, q->melhores[i], &c->voos[q->melhores[i]]);
+    c->entregar(dono, q->id, ENTREGA_INICIAL, 2 + impressos, saida);
+    pthread_mutex_unlock(&c->trava);
+    return q->id;
+}
+
+/**
+ * Retira a consulta do seu balde e do registro (com a trava adquirida).
+ */
+static void descartar_consulta(ConsultasPermanentes *c, ConsultaPermanente *q) {
+    retirar_do_balde(buscar_balde(c, q->rota, 0), q);
+    c->por_id[q->id] = NULL;
+    liberar_consulta(q);
+}
+
+/**
+ * Remove uma consulta do dono.
+ */
+int remover_permanente(ConsultasPermanentes *c, int id, void *dono) {
+    pthread_mutex_lock(&c->trava);
+    int removida = id >= 0 && id < c->num_ids && c->por_id[id] && c->por_id[id]->dono == dono;
+    if (removida) descartar_consulta(c, c->por_id[id]);
+    pthread_mutex_unlock(&c->trava);
+    return removida;
+}
+
+/**
+ * Remove todas as consultas de um dono.
+ */
+void remover_permanentes_do_dono(ConsultasPermanentes *c, void *dono) {
+    pthread_mutex_lock(&c->trava);
+    for (int i = 0; i < c->num_ids; i++) {
+        if (c->por_id[i] && c->por_id[i]->dono == dono) descartar_consulta(c, c->por_id[i]);
+    }
+    pthread_mutex_unlock(&c->trava);
+}
+
+/**
+ * Atualiza um voo e mantém as consultas afetadas. A trava cobre a
+ * atualização e a manutenção, então as consultas veem as alterações na
+ * ordem em que chegam aos índices.
+ */
+int atualizar_voo_permanentes(ConsultasPermanentes *c, int id, const char *campo, const char *valor) {
+    pthread_mutex_lock(&c->trava);
+    int atualizado = atualizar_voo(c->indices, c->voos, c->n, id, campo, valor);
+    if (atualizado) processar_voo(c, id);
+    pthread_mutex_unlock(&c->trava);
+    return atualizado;
+}
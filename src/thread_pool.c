@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "thread_pool.h"
+
+/**
+ * Número de processadores disponíveis (pelo menos 1).
+ */
+int processadores_disponiveis() {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+/**
+ * Laço das threads trabalhadoras: retira tarefas da fila até o encerramento.
+ */
+static void *trabalhador(void *arg) {
+    ThreadPool *pool = arg;
+
+    while (1) {
+        pthread_mutex_lock(&pool->trava);
+        while (!pool->inicio && !pool->encerrar) {
+            pthread_cond_wait(&pool->tem_tarefa, &pool->trava);
+        }
+        if (!pool->inicio && pool->encerrar) {
+            pthread_mutex_unlock(&pool->trava);
+            return NULL;
+        }
+
+        TarefaPool *tarefa = pool->inicio;
+        pool->inicio = tarefa->prox;
+        if (!pool->inicio) pool->fim = NULL;
+        pthread_mutex_unlock(&pool->trava);
+
+        tarefa->funcao(tarefa->arg);
+        free(tarefa);
+
+        pthread_mutex_lock(&pool->trava);
+        if (--pool->pendentes == 0) pthread_cond_broadcast(&pool->concluido);
+        pthread_mutex_unlock(&pool->trava);
+    }
+}
+
+/**
+ * Cria um pool com `num_threads` threads.
+ */
+ThreadPool *criar_pool(int num_threads) {
+    if (num_threads < 1) num_threads = 1;
+
+    ThreadPool *pool = calloc(1, sizeof(ThreadPool));
+    if (!pool) {
+        fprintf(stderr, "Erro ao alocar memória para o pool de threads.\n");
+        exit(EXIT_FAILURE);
+    }
+    pool->threads = malloc(num_threads * sizeof(pthread_t));
+    if (!pool->threads) {
+        fprintf(stderr, "Erro ao alocar memória para o pool de threads.\n");
+        exit(EXIT_FAILURE);
+    }
+    pthread_mutex_init(&pool->trava, NULL);
+    pthread_cond_init(&pool->tem_tarefa, NULL);
+    pthread_cond_init(&pool->concluido, NULL);
+
+    pool->num_threads = num_threads;
+    for (int i = 0; i < num_threads; i++) {
+        if (pthread_create(&pool->threads[i], NULL, trabalhador, pool) != 0) {
+            fprintf(stderr, "Erro ao criar thread do pool.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    return pool;
+}
+
+/**
+ * Enfileira uma tarefa para execução.
+ */
+void submeter_tarefa(ThreadPool *pool, void (*funcao)(void *), void *arg) {
+    TarefaPool *tarefa = malloc(sizeof(TarefaPool));
+    if (!tarefa) {
+        fprintf(stderr, "Erro ao alocar memória para tarefa.\n");
+        exit(EXIT_FAILURE);
+    }
+    tarefa->funcao = funcao;
+    tarefa->arg = arg;
+    tarefa->prox = NULL;
+
+    pthread_mutex_lock(&pool->trava);
+    if (pool->fim) pool->fim->prox = tarefa;
+    else pool->inicio = tarefa;
+    pool->fim = tarefa;
+    pool->pendentes++;
+    pthread_cond_signal(&pool->tem_tarefa);
+    pthread_mutex_unlock(&pool->trava);
+}
+
+/**
+ * Bloqueia até que todas as tarefas submetidas tenham terminado.
+ */
+void aguardar_pool(ThreadPool *pool) {
+    pthread_mutex_lock(&pool->trava);
+    while (pool->pendentes > 0) {
+        pthread_cond_wait(&pool->concluido, &pool->trava);
+    }
+    pthread_mutex_unlock(&pool->trava);
+}
+
+/**
+ * Aguarda as tarefas pendentes, encerra as threads e libera o pool.
+ */
+void destruir_pool(ThreadPool *pool) {
+    if (!pool) return;
+    aguardar_pool(pool);
+
+    pthread_mutex_lock(&pool->trava);
+    pool->encerrar = 1;
+    pthread_cond_broadcast(&pool->tem_tarefa);
+    pthread_mutex_unlock(&pool->trava);
+
+    for (int i = 0; i < pool->num_threads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&pool->trava);
+    pthread_cond_destroy(&pool->tem_tarefa);
+    pthread_cond_destroy(&pool->concluido);
+    free(pool->threads);
+    free(pool);
+}
@@ -0,0 +1,71 @@
+#!/bin/sh
+# Testes de regressão: cada tests/input/input_N.txt deve produzir
+# tests/output/output_N.txt (comparados sem os '\r'). Cada entrada é
+# executada no modo padrão e com cada opção de MODOS, que não muda a saída,
+# e passa também pela saída binária: o fluxo de --output=binary, lido pelo
+# tp3-binread sem as linhas "#", deve coincidir com a saída esperada sem as
+# linhas das consultas.
+# Uso: tests/check.sh [executável]   (padrão: bin/tp3.out; o tp3-binread fica ao lado)
+
+EXEC=${1:-bin/tp3.out}
+BINREAD=$(dirname "$EXEC")/tp3-binread
+MODOS="--postings=compressed --shards=4 --scan --batch=4 --lsm --pipeline --cluster=route --engine=verify"
+SEM_ITINERARIOS="--batch=4 --lsm"   # Modos que não respondem consultas itn
+
+TMP=$(mktemp -d) || exit 1
+trap 'rm -rf "$TMP"' EXIT
+
+falhas=0
+total=0
+
+# Compara a saída obtida com a esperada, ignorando os '\r'; o programa
+# também precisa ter terminado com sucesso (ex: sem erro do sanitizador).
+# Uso: verificar <descrição> <esperado> <obtido> <código de saída>
+verificar() {
+    total=$((total + 1))
+    if [ "$4" -ne 0 ]; then
+        echo "FALHOU: $1 (código de saída $4)"
+        falhas=$((falhas + 1))
+        return
+    fi
+    tr -d '\r' < "$2" > "$TMP/esperado"
+    tr -d '\r' < "$3" > "$TMP/obtido"
+    if ! cmp -s "$TMP/esperado" "$TMP/obtido"; then
+        echo "FALHOU: $1"
+        diff "$TMP/esperado" "$TMP/obtido" | head -5
+        falhas=$((falhas + 1))
+    fi
+}
+
+for entrada in tests/input/input_*.txt; do
+    n=${entrada##*input_}
+    n=${n%.txt}
+    esperado=tests/output/output_$n.txt
+    [ -f "$esperado" ] || continue
+
+    "$EXEC" "$entrada" > "$TMP/saida" 2>"$TMP/erros"
+    verificar "input_$n" "$esperado" "$TMP/saida" $?
+    for modo in $MODOS; do
+        if grep -q '^itn ' "$entrada"; then
+            case " $SEM_ITINERARIOS " in *" $modo "*) continue ;; esac
+        fi
+        "$EXEC" "$modo" "$entrada" > "$TMP/saida" 2>"$TMP/erros"
+        verificar "input_$n $modo" "$esperado" "$TMP/saida" $?
+    done
+
+    # Ida e volta pela saída binária: um registro (linha "#") por consulta
+    "$EXEC" --output=binary "$entrada" 2>"$TMP/erros" | "$BINREAD" > "$TMP/lido" 2>>"$TMP/erros"
+    codigo=$?
+    awk 'NR == FNR { sub(/\r$/, ""); if (FNR == 1) n = $1; else if (FNR > n + 2) consulta[$0] = 1; next }
+         { sub(/\r$/, ""); if (!($0 in consulta)) print }' "$entrada" "$esperado" > "$TMP/sem_consultas"
+    grep -v '^#' "$TMP/lido" > "$TMP/saida"
+    verificar "input_$n --output=binary" "$TMP/sem_consultas" "$TMP/saida" $codigo
+    consultas=$(awk '{ sub(/\r$/, "") } NR == 1 { n = $1 } NR == n + 2 { print $1 }' "$entrada")
+    if [ "$(grep -c '^#' "$TMP/lido")" -ne "$consultas" ]; then
+        echo "FALHOU: input_$n --output=binary (registros diferentes de $consultas consultas)"
+        falhas=$((falhas + 1))
+    fi
+done
+
+echo "$((total - falhas))/$total testes passaram."
+[ "$falhas" -eq 0 ]
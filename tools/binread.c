@@ -0,0 +1,226 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "output_binary.h"
+#include "cursor.h"
+
+/**
+ * Leitor do fluxo binário de resultados (--output=binary).
+ *
+ * Valida o cabeçalho, localiza as colunas pelas descrições e imprime cada
+ * registro: uma linha "# consulta tipo max trigrama resultados" seguida dos
+ * voos no mesmo formato da saída de texto (as pernas de um itinerário com
+ * dois espaços), do valor de uma agregação ou da linha do cursor. Sem as
+ * linhas "#", a saída coincide com a de texto sem as linhas das consultas.
+ */
+
+/**
+ * Deslocamentos das colunas de um voo no fluxo lido.
+ */
+typedef struct {
+    size_t tamanho_linha;
+    int deslocamento[BINARIO_NUM_COLUNAS];
+} Layout;
+
+static const char *nomes_colunas[BINARIO_NUM_COLUNAS] = {
+    "id", "origem", "destino", "preco", "assentos", "paradas", "partida", "chegada", "preco_real",
+};
+
+static void erro(const char *mensagem) {
+    fprintf(stderr, "tp3-binread: %s\n", mensagem);
+    exit(EXIT_FAILURE);
+}
+
+static void ler(FILE *entrada, void *destino, size_t tamanho) {
+    if (fread(destino, 1, tamanho, entrada) != tamanho) erro("fluxo truncado.");
+}
+
+/**
+ * Lê o cabeçalho do fluxo e monta o layout das linhas.
+ */
+static void ler_cabecalho(FILE *entrada, Layout *layout) {
+    char magica[4];
+    uint32_t versao;
+    uint16_t tamanho_linha, num_colunas;
+    ler(entrada, magica, 4);
+    if (memcmp(magica, BINARIO_MAGICA, 4) != 0) erro("assinatura inválida (não é um fluxo --output=binary).");
+    ler(entrada, &versao, sizeof(versao));
+    if (versao != BINARIO_VERSAO) erro("versão do fluxo não suportada.");
+    ler(entrada, &tamanho_linha, sizeof(tamanho_linha));
+    ler(entrada, &num_colunas, sizeof(num_colunas));
+
+    layout->tamanho_linha = tamanho_linha;
+    for (int c = 0; c < BINARIO_NUM_COLUNAS; c++) layout->deslocamento[c] = -1;
+    for (int i = 0; i < num_colunas; i++) {
+        char nome[13] = {0};
+        uint8_t tipo, largura;
+        uint16_t deslocamento;
+        ler(entrada, nome, 12);
+        ler(entrada, &tipo, 1);
+        ler(entrada, &largura, 1);
+        ler(entrada, &deslocamento, sizeof(deslocamento));
+        if ((size_t)deslocamento + largura > tamanho_linha) erro("coluna fora da linha.");
+        for (int c = 0; c < BINARIO_NUM_COLUNAS; c++) {
+            if (strcmp(nome, nomes_colunas[c]) == 0) layout->deslocamento[c] = deslocamento;
+        }
+        (void)tipo;
+    }
+    for (int c = 0; c < BINARIO_NUM_COLUNAS; c++) {
+        if (layout->deslocamento[c] < 0) erro("coluna ausente no cabeçalho.");
+    }
+}
+
+static int32_t ler_i32(const char *p) {
+    int32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static float ler_f32(const char *p) {
+    float v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static int64_t ler_i64(const char *p) {
+    int64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static void decodificar_aeroporto(uint32_t chave, char *codigo) {
+    int n = 0;
+    for (int s = 16; s >= 0; s -= 8) {
+        char c = (char)((chave >> s) & 0xff);
+        if (c) codigo[n++] = c;
+    }
+    codigo[n] = '\0';
+}
+
+/**
+ * Reconstrói um voo a partir de uma linha.
+ */
+static void decodificar_voo(const Layout *layout, const char *linha, Flight *voo) {
+    memset(voo, 0, sizeof(*voo));
+    voo->id = ler_i32(linha + layout->deslocamento[0]);
+    decodificar_aeroporto((uint32_t)ler_i32(linha + layout->deslocamento[1]), voo->origem);
+    decodificar_aeroporto((uint32_t)ler_i32(linha + layout->deslocamento[2]), voo->destino);
+    voo->preco = ler_f32(linha + layout->deslocamento[8]);
+    voo->assentos = ler_i32(linha + layout->deslocamento[4]);
+    voo->paradas = ler_i32(linha + layout->deslocamento[5]);
+    voo->partida = (time_t)ler_i64(linha + layout->deslocamento[6]);
+    voo->chegada = (time_t)ler_i64(linha + layout->deslocamento[7]);
+    voo->duracao = (int)(voo->chegada - voo->partida);
+}
+
+/**
+ * Imprime o corpo de um registro.
+ */
+static void imprimir_registro(Saida *saida, const Layout *layout, const Query *consulta, uint32_t resultados,
+                              const char *dados, size_t tamanho) {
+    const char *p = dados, *fim = dados + tamanho;
+    Flight voo;
+
+    if (consulta->agregacao == CONSULTA_ITINERARIO) {
+        for (uint32_t r = 0; r < resultados; r++) {
+            if ((size_t)(fim - p) < sizeof(uint32_t) + layout->tamanho_linha) erro("registro truncado.");
+            uint32_t pernas = (uint32_t)ler_i32(p);
+            p += sizeof(uint32_t);
+            if ((size_t)(fim - p) < (size_t)(1 + pernas) * layout->tamanho_linha) erro("registro truncado.");
+            decodificar_voo(layout, p, &voo);
+            imprimir_voo(saida, &voo);
+            p += layout->tamanho_linha;
+            for (uint32_t j = 0; j < pernas; j++, p += layout->tamanho_linha) {
+                decodificar_voo(layout, p, &voo);
+                escrever_saida(saida, "  ", 2);
+                imprimir_voo(saida, &voo);
+            }
+        }
+    } else if (consulta->agregacao != AGREGACAO_NENHUMA) {
+        if (tamanho < 40) erro("registro truncado.");
+        AgregadoPreco agregado;
+        double soma;
+        int64_t quantidade = ler_i64(p);
+        memcpy(&soma, p + 8, sizeof(soma));
+        agregado.quantidade = quantidade;
+        agregado.soma = soma;
+        agregado.minimo = ler_f32(p + 32);
+        agregado.maximo = ler_f32(p + 36);
+        imprimir_agregacao(saida, consulta, &agregado);
+    } else {
+        if ((size_t)(fim - p) < (size_t)resultados * layout->tamanho_linha) erro("registro truncado.");
+        for (uint32_t r = 0; r < resultados; r++, p += layout->tamanho_linha) {
+            decodificar_voo(layout, p, &voo);
+            imprimir_voo(saida, &voo);
+        }
+        if (consulta->paginada) {
+            if ((size_t)(fim - p) < CURSOR_TAMANHO) erro("registro truncado.");
+            char linha[CURSOR_TAMANHO + 9] = "cursor ";
+            if (p[0]) {
+                memcpy(linha + 7, p, CURSOR_TAMANHO);
+            } else {
+                strcpy(linha + 7, "-");
+            }
+            size_t n = strlen(linha);
+            linha[n++] = '\n';
+            escrever_saida(saida, linha, n);
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 2) {
+        fprintf(stderr, "Uso: %s [arquivo]  (lê a entrada padrão sem arquivo)\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    FILE *entrada = argc == 2 ? fopen(argv[1], "rb") : stdin;
+    if (!entrada) {
+        perror(argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    Layout layout;
+    ler_cabecalho(entrada, &layout);
+    Saida *saida = criar_saida(STDOUT_FILENO, SAIDA_CAPACIDADE_PADRAO);
+    char *dados = NULL;
+    size_t capacidade = 0;
+
+    uint32_t tamanho;
+    while (fread(&tamanho, 1, sizeof(tamanho), entrada) == sizeof(tamanho)) {
+        char cabecalho[BINARIO_TAMANHO_CABECALHO - sizeof(uint32_t)];
+        if (tamanho < sizeof(cabecalho)) erro("registro inválido.");
+        ler(entrada, cabecalho, sizeof(cabecalho));
+        size_t tamanho_dados = tamanho - sizeof(cabecalho);
+        if (tamanho_dados > capacidade) {
+            capacidade = tamanho_dados;
+            dados = realloc(dados, capacidade);
+            if (!dados) erro("memória insuficiente.");
+        }
+        ler(entrada, dados, tamanho_dados);
+
+        Query consulta;
+        memset(&consulta, 0, sizeof(consulta));
+        consulta.agregacao = (TipoAgregacao)(uint8_t)cabecalho[0];
+        consulta.paginada = cabecalho[1] & 1;
+        consulta.max_voos = ler_i32(cabecalho + 4);
+        memcpy(consulta.trigrama, cabecalho + 8, 3);
+        uint32_t numero = (uint32_t)ler_i32(cabecalho + 12);
+        uint32_t resultados = (uint32_t)ler_i32(cabecalho + 16);
+        if (consulta.agregacao > CONSULTA_ITINERARIO) erro("tipo de consulta desconhecido.");
+
+        char linha[128];
+        const char *tipo = consulta.agregacao == AGREGACAO_NENHUMA   ? (consulta.paginada ? "page" : "lista")
+                           : consulta.agregacao == CONSULTA_ITINERARIO ? "itn"
+                                                                       : nome_agregacao(consulta.agregacao);
+        int n = snprintf(linha, sizeof(linha), "# %u %s %d %s %u\n", numero, tipo, consulta.max_voos,
+                         consulta.trigrama[0] ? consulta.trigrama : "-", resultados);
+        escrever_saida(saida, linha, (size_t)n);
+        imprimir_registro(saida, &layout, &consulta, resultados, dados, tamanho_dados);
+    }
+
+    liberar_saida(saida);
+    free(dados);
+    if (entrada != stdin) fclose(entrada);
+    return EXIT_SUCCESS;
+}
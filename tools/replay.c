@@ -0,0 +1,353 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include "engine.h"
+#include "capture.h"
+#include "output.h"
+
+#define RESUMO_MAGICA "TP3R"  // Assinatura do arquivo de resumo das respostas
+#define REPLAY_MAX_DIFERENCAS 10  // Diferenças listadas na comparação com a linha de base
+
+/**
+ * Reexecução de um log de captura (--capture) contra um conjunto de voos.
+ *
+ * As consultas são disparadas no ritmo original (cada uma no seu instante de
+ * chegada) ou o mais rápido possível, por uma ou mais threads sobre o mesmo
+ * motor. Ao final são impressas as distribuições de latência capturada e
+ * reexecutada. O resumo das respostas (hash e número de linhas de cada uma)
+ * pode ser salvo e comparado com o de outra versão do programa.
+ */
+
+/**
+ * Resultado da reexecução de uma consulta.
+ */
+typedef struct {
+    uint64_t latencia;  // Nanossegundos
+    uint64_t hash;      // FNV-1a da resposta
+    uint32_t linhas;    // Linhas da resposta (0 se a consulta for inválida)
+    char *texto;        // Resposta completa (só com --output)
+} ResultadoReplay;
+
+/**
+ * Estado compartilhado entre as threads da reexecução.
+ */
+typedef struct {
+    Engine *engine;
+    const RegistroConsulta *registros;
+    ResultadoReplay *resultados;
+    int num;
+    int ritmo_original;       // Espera o instante de chegada de cada consulta
+    int guardar_texto;        // Mantém as respostas para --output
+    uint64_t inicio;          // Instante de início da reexecução
+    atomic_int proxima;       // Próxima consulta a executar
+} Replay;
+
+static void imprimir_uso(const char *programa) {
+    fprintf(stderr, "Uso: %s [opções] <arquivo_de_voos> <log_de_captura>\n", programa);
+    fprintf(stderr, "  --pace=original|max   Ritmo das consultas: instantes capturados ou o mais rápido possível (padrão)\n");
+    fprintf(stderr, "  --threads=<n>         Threads que disparam as consultas (padrão 1)\n");
+    fprintf(stderr, "  --output=<arquivo>    Grava as respostas, na ordem do log\n");
+    fprintf(stderr, "  --save=<arquivo>      Grava o resumo das respostas (linha de base)\n");
+    fprintf(stderr, "  --baseline=<arquivo>  Compara as respostas com um resumo gravado por --save\n");
+}
+
+/**
+ * FNV-1a de 64 bits.
+ */
+static uint64_t hash_fnv(const char *dados, size_t tamanho) {
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < tamanho; i++) {
+        h ^= (unsigned char)dados[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/**
+ * Reconstrói a linha de uma consulta capturada no formato de entrada.
+ */
+static void formatar_linha(const Query *consulta, char *linha, size_t max) {
+    if (consulta->agregacao == AGREGACAO_NENHUMA && consulta->paginada) {
+        char cursor[CURSOR_TAMANHO + 1] = "";
+        if (consulta->tem_cursor) codificar_cursor(consulta, &consulta->cursor, cursor);
+        snprintf(linha, max, "page %s%s%d %s %s", cursor, cursor[0] ? " " : "", consulta->max_voos,
+                 consulta->trigrama, consulta->expressao);
+    } else if (consulta->agregacao == AGREGACAO_NENHUMA) {
+        snprintf(linha, max, "%d %s %s", consulta->max_voos, consulta->trigrama, consulta->expressao);
+    } else if (consulta->agregacao == CONSULTA_ITINERARIO) {
+        snprintf(linha, max, "itn %d %s %s", consulta->max_voos, consulta->trigrama, consulta->expressao);
+    } else if (consulta->agregacao == AGREGACAO_COUNT) {
+        snprintf(linha, max, "COUNT %s", consulta->expressao);
+    } else {
+        snprintf(linha, max, "%s prc %s", nome_agregacao(consulta->agregacao), consulta->expressao);
+    }
+}
+
+/**
+ * Espera até o instante absoluto `alvo` do relógio monotônico.
+ */
+static void esperar_ate(uint64_t alvo) {
+    struct timespec ts = { .tv_sec = (time_t)(alvo / 1000000000ULL), .tv_nsec = (long)(alvo % 1000000000ULL) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) { }
+}
+
+/**
+ * Thread de reexecução: retira consultas da fila compartilhada até o fim do log.
+ */
+static void *executar_replay(void *arg) {
+    Replay *r = arg;
+    char linha[512];
+
+    int i;
+    while ((i = atomic_fetch_add(&r->proxima, 1)) < r->num) {
+        const RegistroConsulta *registro = &r->registros[i];
+        ResultadoReplay *resultado = &r->resultados[i];
+        formatar_linha(&registro->consulta, linha, sizeof(linha));
+
+        uint64_t chegada = relogio_ns();
+        if (r->ritmo_original) {
+            uint64_t alvo = r->inicio + registro->chegada;
+            if (alvo > chegada) {
+                esperar_ate(alvo);
+            }
+            // Atrasos da própria reexecução (fila cheia) contam na latência
+            chegada = alvo;
+        }
+
+        char *resposta;
+        size_t tamanho;
+        int linhas = engine_query(r->engine, linha, &resposta, &tamanho);
+        resultado->latencia = relogio_ns() - chegada;
+        if (linhas < 0) {
+            resultado->linhas = 0;
+            resultado->hash = 0;
+            continue;
+        }
+        resultado->linhas = (uint32_t)linhas;
+        resultado->hash = hash_fnv(resposta, tamanho);
+        if (r->guardar_texto) {
+            resultado->texto = resposta;
+        } else {
+            free(resposta);
+        }
+    }
+    return NULL;
+}
+
+static int comparar_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Percentil (0-100) de um vetor já ordenado, pelo posto mais próximo.
+ */
+static uint64_t percentil(const uint64_t *ordenados, int n, double p) {
+    if (n == 0) return 0;
+    int posto = (int)(p / 100.0 * n + 0.999999);
+    if (posto < 1) posto = 1;
+    if (posto > n) posto = n;
+    return ordenados[posto - 1];
+}
+
+/**
+ * Imprime a distribuição de latências (microssegundos) de um vetor.
+ */
+static void imprimir_distribuicao(const char *rotulo, uint64_t *latencias, int n) {
+    qsort(latencias, n, sizeof(uint64_t), comparar_u64);
+    double soma = 0;
+    for (int i = 0; i < n; i++) soma += latencias[i];
+    fprintf(stderr, "%-12s media %10.1f  p50 %10.1f  p90 %10.1f  p99 %10.1f  p99.9 %10.1f  max %10.1f us\n",
+            rotulo, n ? soma / n / 1000.0 : 0.0,
+            percentil(latencias, n, 50) / 1000.0, percentil(latencias, n, 90) / 1000.0,
+            percentil(latencias, n, 99) / 1000.0, percentil(latencias, n, 99.9) / 1000.0,
+            n ? latencias[n - 1] / 1000.0 : 0.0);
+}
+
+/**
+ * Grava o resumo das respostas: "TP3R" + uint32 quantidade + (uint64 hash, uint32 linhas) por consulta.
+ */
+static int salvar_resumo(const char *caminho, const ResultadoReplay *resultados, int num) {
+    FILE *f = fopen(caminho, "wb");
+    if (!f) {
+        fprintf(stderr, "Erro ao criar o resumo %s.\n", caminho);
+        return 0;
+    }
+    uint32_t quantidade = (uint32_t)num;
+    fwrite(RESUMO_MAGICA, 1, 4, f);
+    fwrite(&quantidade, sizeof(quantidade), 1, f);
+    for (int i = 0; i < num; i++) {
+        fwrite(&resultados[i].hash, sizeof(uint64_t), 1, f);
+        fwrite(&resultados[i].linhas, sizeof(uint32_t), 1, f);
+    }
+    fclose(f);
+    return 1;
+}
+
+/**
+ * Compara as respostas com um resumo gravado.
+ * @return Número de consultas com resposta diferente, ou -1 se o resumo for inválido.
+ */
+static int comparar_resumo(const char *caminho, const RegistroConsulta *registros,
+                           const ResultadoReplay *resultados, int num) {
+    FILE *f = fopen(caminho, "rb");
+    char magica[4];
+    uint32_t quantidade;
+    if (!f || fread(magica, 1, 4, f) != 4 || memcmp(magica, RESUMO_MAGICA, 4) != 0 ||
+        fread(&quantidade, sizeof(quantidade), 1, f) != 1) {
+        fprintf(stderr, "Resumo inválido: %s\n", caminho);
+        if (f) fclose(f);
+        return -1;
+    }
+    if ((int)quantidade != num) {
+        fprintf(stderr, "O resumo tem %u consultas; o log tem %d.\n", quantidade, num);
+    }
+
+    int diferencas = 0;
+    char linha[512];
+    for (int i = 0; i < num && i < (int)quantidade; i++) {
+        uint64_t hash;
+        uint32_t linhas;
+        if (fread(&hash, sizeof(hash), 1, f) != 1 || fread(&linhas, sizeof(linhas), 1, f) != 1) break;
+        if (hash == resultados[i].hash && linhas == resultados[i].linhas) continue;
+
+        if (diferencas < REPLAY_MAX_DIFERENCAS) {
+            formatar_linha(&registros[i].consulta, linha, sizeof(linha));
+            linha[strcspn(linha, "\r")] = '\0';
+            fprintf(stderr, "  consulta %d (%s): %u linhas na linha de base, %u agora\n",
+                    i + 1, linha, linhas, resultados[i].linhas);
+        }
+        diferencas++;
+    }
+    fclose(f);
+    return diferencas;
+}
+
+int main(int argc, char *argv[]) {
+    const char *arquivo_voos = NULL, *arquivo_log = NULL;
+    const char *saida_texto = NULL, *salvar = NULL, *base = NULL;
+    int num_threads = 1;
+    int ritmo_original = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--pace=original") == 0) ritmo_original = 1;
+        else if (strcmp(argv[i], "--pace=max") == 0) ritmo_original = 0;
+        else if (strncmp(argv[i], "--threads=", 10) == 0) num_threads = atoi(argv[i] + 10);
+        else if (strncmp(argv[i], "--output=", 9) == 0) saida_texto = argv[i] + 9;
+        else if (strncmp(argv[i], "--save=", 7) == 0) salvar = argv[i] + 7;
+        else if (strncmp(argv[i], "--baseline=", 11) == 0) base = argv[i] + 11;
+        else if (argv[i][0] == '-' && argv[i][1] == '-') {
+            fprintf(stderr, "Opção desconhecida: %s\n", argv[i]);
+            return EXIT_FAILURE;
+        } else if (!arquivo_voos) arquivo_voos = argv[i];
+        else if (!arquivo_log) arquivo_log = argv[i];
+        else {
+            imprimir_uso(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (!arquivo_voos || !arquivo_log || num_threads < 1) {
+        imprimir_uso(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Consultas capturadas
+    FILE *log_entrada = abrir_captura_leitura(arquivo_log);
+    if (!log_entrada) return EXIT_FAILURE;
+    int num = 0, capacidade = 1024;
+    RegistroConsulta *registros = malloc(capacidade * sizeof(RegistroConsulta));
+    while (registros && ler_registro_consulta(log_entrada, &registros[num])) {
+        if (++num == capacidade) {
+            capacidade *= 2;
+            registros = realloc(registros, capacidade * sizeof(RegistroConsulta));
+        }
+    }
+    fclose(log_entrada);
+    if (!registros) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Conjunto de voos (as consultas que seguem os voos no arquivo são ignoradas)
+    FILE *entrada = fopen(arquivo_voos, "r");
+    if (!entrada) {
+        fprintf(stderr, "Erro ao abrir o arquivo %s.\n", arquivo_voos);
+        return EXIT_FAILURE;
+    }
+    Engine *engine = engine_create();
+    int num_voos = engine_load(engine, entrada);
+    fclose(entrada);
+    if (num_voos < 0) {
+        fprintf(stderr, "Erro ao ler os voos de %s.\n", arquivo_voos);
+        engine_destroy(engine);
+        return EXIT_FAILURE;
+    }
+
+    Replay r = {
+        .engine = engine,
+        .registros = registros,
+        .resultados = calloc(num > 0 ? num : 1, sizeof(ResultadoReplay)),
+        .num = num,
+        .ritmo_original = ritmo_original,
+        .guardar_texto = saida_texto != NULL,
+    };
+    if (!r.resultados) {
+        fprintf(stderr, "Erro de alocação de memória.\n");
+        return EXIT_FAILURE;
+    }
+    atomic_init(&r.proxima, 0);
+
+    pthread_t *threads = malloc(num_threads * sizeof(pthread_t));
+    r.inicio = relogio_ns();
+    for (int t = 0; t < num_threads; t++) {
+        if (pthread_create(&threads[t], NULL, executar_replay, &r) != 0) {
+            fprintf(stderr, "Erro ao criar as threads da reexecução.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int t = 0; t < num_threads; t++) pthread_join(threads[t], NULL);
+    double segundos = (relogio_ns() - r.inicio) / 1e9;
+    free(threads);
+
+    // Relatório
+    uint64_t *latencias = malloc((num > 0 ? num : 1) * sizeof(uint64_t));
+    fprintf(stderr, "%d consultas sobre %d voos em %.3f s (%.1f consultas/s), %d thread(s), ritmo %s\n",
+            num, num_voos, segundos, segundos > 0 ? num / segundos : 0.0, num_threads,
+            ritmo_original ? "original" : "máximo");
+    for (int i = 0; i < num; i++) latencias[i] = registros[i].latencia;
+    imprimir_distribuicao("capturada", latencias, num);
+    for (int i = 0; i < num; i++) latencias[i] = r.resultados[i].latencia;
+    imprimir_distribuicao("reexecutada", latencias, num);
+    free(latencias);
+
+    int status = EXIT_SUCCESS;
+    if (saida_texto) {
+        FILE *f = fopen(saida_texto, "w");
+        if (!f) {
+            fprintf(stderr, "Erro ao criar o arquivo %s.\n", saida_texto);
+            status = EXIT_FAILURE;
+        } else {
+            for (int i = 0; i < num; i++) {
+                if (r.resultados[i].texto) fputs(r.resultados[i].texto, f);
+            }
+            fclose(f);
+        }
+    }
+    if (salvar && !salvar_resumo(salvar, r.resultados, num)) status = EXIT_FAILURE;
+    if (base) {
+        int diferencas = comparar_resumo(base, registros, r.resultados, num);
+        if (diferencas != 0) status = EXIT_FAILURE;
+        if (diferencas >= 0) {
+            fprintf(stderr, "%d de %d respostas diferem da linha de base.\n", diferencas, num);
+        }
+    }
+
+    for (int i = 0; i < num; i++) free(r.resultados[i].texto);
+    free(r.resultados);
+    free(registros);
+    engine_destroy(engine);
+    return status;
+}